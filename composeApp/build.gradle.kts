@@ -58,6 +58,10 @@ android {
         versionCode = 1
         versionName = "1.0"
     }
+    androidResources {
+        // Asset packs are mapped in place, which needs them stored uncompressed.
+        noCompress += "kpak"
+    }
     packaging {
         resources {
             excludes += "/META-INF/{AL2.0,LGPL2.1}"
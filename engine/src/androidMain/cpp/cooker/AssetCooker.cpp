@@ -0,0 +1,544 @@
+// Host-side asset cooker. Runs the runtime model loaders and the mesh
+// optimizer on a directory of source assets and writes cooked models (.kmdl)
+// plus GPU-ready textures (.ktx2 with a full mip chain) so devices skip
+// parsing and decoding.
+//
+//   asset_cooker --input <assets dir> --output <out dir> [--jobs N]
+//                [--max-texture-size N] [--texture-format etc2|rgba8]
+//                [--pack <file>] [--bench N] [asset paths...]
+//
+// Asset paths are relative to the input directory. Without any, the whole
+// input tree is scanned for .obj, .gltf, .png and .jpg/.jpeg files.
+// Textures default to ETC2 (RGB when fully opaque, RGBA otherwise); devices
+// without ETC2 sampling expand them to RGBA8 at load time.
+// --pack bundles everything in the output directory into one .kpak archive.
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AssetPack.h"
+#include "AssetSource.h"
+#include "CookedModel.h"
+#include "Etc2.h"
+#include "ImageLoader.h"
+#include "Ktx2.h"
+#include "Mipmaps.h"
+#include "ModelLoader.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct SCookerOptions {
+	std::string strInputDir;
+	std::string strOutputDir;
+	unsigned uJobs = 0;
+	int nMaxTextureSize = 0;
+	bool bEtc2Textures = true;
+	int nBenchIterations = 0;
+	std::string strPackPath;
+	std::vector<std::string> vecAssets;
+};
+
+struct SCookResult {
+	std::string strSource;
+	std::string strOutput;
+	bool bSuccess = false;
+	double loadMs = 0.0;
+	double processMs = 0.0;
+	double writeMs = 0.0;
+	uintmax_t uInputBytes = 0;
+	size_t uOutputBytes = 0;
+	std::string strDetails;
+};
+
+double elapsedMs(Clock::time_point tStart, Clock::time_point tEnd) {
+	return std::chrono::duration<double, std::milli>(tEnd - tStart).count();
+}
+
+std::string lowercaseExtension(const std::string& strPath) {
+	std::string strExtension = fs::path(strPath).extension().string();
+	std::transform(strExtension.begin(), strExtension.end(), strExtension.begin(), [](unsigned char ch) {
+		return static_cast<char>(std::tolower(ch));
+	});
+	return strExtension;
+}
+
+bool isModelPath(const std::string& strPath) {
+	const std::string strExtension = lowercaseExtension(strPath);
+	return strExtension == ".obj" || strExtension == ".gltf";
+}
+
+bool isTexturePath(const std::string& strPath) {
+	const std::string strExtension = lowercaseExtension(strPath);
+	return strExtension == ".png" || strExtension == ".jpg" || strExtension == ".jpeg";
+}
+
+std::string replaceExtension(const std::string& strPath, const char* pcExtension) {
+	return fs::path(strPath).replace_extension(pcExtension).generic_string();
+}
+
+bool writeFile(const fs::path& path, const void* pData, size_t uSize) {
+	std::error_code error;
+	fs::create_directories(path.parent_path(), error);
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file) return false;
+	file.write(static_cast<const char*>(pData), static_cast<std::streamsize>(uSize));
+	return static_cast<bool>(file);
+}
+
+uintmax_t fileSize(const fs::path& path) {
+	std::error_code error;
+	const uintmax_t uSize = fs::file_size(path, error);
+	return error ? 0 : uSize;
+}
+
+// Halves the image with a 2x2 box filter until it fits in nMaxSize.
+void downscaleToFit(std::vector<unsigned char>& vecPixels, int& nWidth, int& nHeight, int nMaxSize) {
+	if (nMaxSize <= 0) return;
+	while (nWidth > nMaxSize || nHeight > nMaxSize) {
+		const int nNewWidth = std::max(1, nWidth / 2);
+		const int nNewHeight = std::max(1, nHeight / 2);
+		std::vector<unsigned char> vecScaled(static_cast<size_t>(nNewWidth) * nNewHeight * 4);
+		downsampleRgba8(vecPixels.data(), static_cast<uint32_t>(nWidth), static_cast<uint32_t>(nHeight), vecScaled.data());
+		vecPixels.swap(vecScaled);
+		nWidth = nNewWidth;
+		nHeight = nNewHeight;
+	}
+}
+
+bool hasTransparentPixels(const std::vector<unsigned char>& vecPixels) {
+	for (size_t i = 3; i < vecPixels.size(); i += 4) {
+		if (vecPixels[i] != 255) return true;
+	}
+	return false;
+}
+
+// Sums the sizes of the distinct files a loader opens (.gltf plus its .bin
+// buffers, .obj plus its .mtl libraries) so the report covers all of a
+// model's input, not just its top-level file.
+class SizeRecordingSource : public AssetSource {
+public:
+	explicit SizeRecordingSource(const AssetSource& source) : inner(source) {}
+
+	AssetData open(const std::string& strPath) const override {
+		AssetData data = inner.open(strPath);
+		std::lock_guard<std::mutex> oGuard(mutex);
+		if (data && setOpened.insert(strPath).second) {
+			uOpenedBytes += data.size();
+		}
+		return data;
+	}
+
+	uintmax_t openedBytes() const {
+		std::lock_guard<std::mutex> oGuard(mutex);
+		return uOpenedBytes;
+	}
+
+private:
+	const AssetSource& inner;
+	mutable std::mutex mutex;
+	mutable std::set<std::string> setOpened;
+	mutable uintmax_t uOpenedBytes = 0;
+};
+
+SCookResult cookModel(const SCookerOptions& sOptions, const AssetSource& assetSource, const std::string& strAsset, std::set<std::string>& setTextures, std::mutex& textureMutex) {
+	SCookResult sResult;
+	sResult.strSource = strAsset;
+	sResult.strOutput = replaceExtension(strAsset, kCookedModelExtension);
+
+	const SizeRecordingSource recordingSource(assetSource);
+	const Clock::time_point tLoadStart = Clock::now();
+	Model sModel = loadModel(recordingSource, strAsset);
+	const Clock::time_point tLoadEnd = Clock::now();
+	sResult.loadMs = elapsedMs(tLoadStart, tLoadEnd);
+	sResult.uInputBytes = recordingSource.openedBytes();
+	if (!sModel.hasGeometry()) {
+		sResult.strDetails = "no geometry";
+		return sResult;
+	}
+
+	// loadModel has already run the mesh optimizer.
+	for (Material& sMaterial : sModel.materials) {
+		if (sMaterial.diffuseTexture.empty() || !isTexturePath(sMaterial.diffuseTexture)) continue;
+		if (!fs::exists(fs::path(sOptions.strInputDir) / sMaterial.diffuseTexture)) continue;
+		{
+			std::lock_guard<std::mutex> oGuard(textureMutex);
+			setTextures.insert(sMaterial.diffuseTexture);
+		}
+		sMaterial.diffuseTexture = replaceExtension(sMaterial.diffuseTexture, kKtx2Extension);
+	}
+	std::vector<uint8_t> vecCooked;
+	const bool bCooked = writeCookedModel(sModel, vecCooked);
+	const Clock::time_point tProcessEnd = Clock::now();
+	sResult.processMs = elapsedMs(tLoadEnd, tProcessEnd);
+	if (!bCooked) {
+		sResult.strDetails = "cook failed";
+		return sResult;
+	}
+
+	if (!writeFile(fs::path(sOptions.strOutputDir) / sResult.strOutput, vecCooked.data(), vecCooked.size())) {
+		sResult.strDetails = "write failed";
+		return sResult;
+	}
+	sResult.writeMs = elapsedMs(tProcessEnd, Clock::now());
+	sResult.uOutputBytes = vecCooked.size();
+	sResult.bSuccess = true;
+
+	char acDetails[160];
+	std::snprintf(acDetails, sizeof(acDetails), "%zu vertices, %zu triangles, %zu meshlets",
+		sModel.vertexCount(),
+		sModel.triangleCount(),
+		sModel.meshlets.size());
+	sResult.strDetails = acDetails;
+	return sResult;
+}
+
+SCookResult cookTexture(const SCookerOptions& sOptions, const std::string& strAsset) {
+	SCookResult sResult;
+	sResult.strSource = strAsset;
+	sResult.strOutput = replaceExtension(strAsset, kKtx2Extension);
+	const fs::path sourcePath = fs::path(sOptions.strInputDir) / strAsset;
+	sResult.uInputBytes = fileSize(sourcePath);
+
+	const Clock::time_point tLoadStart = Clock::now();
+	std::vector<unsigned char> vecPixels;
+	int nWidth = 0;
+	int nHeight = 0;
+	const bool bDecoded = LoadImageFromFile(sourcePath.string(), 4, vecPixels, nWidth, nHeight);
+	const Clock::time_point tLoadEnd = Clock::now();
+	sResult.loadMs = elapsedMs(tLoadStart, tLoadEnd);
+	if (!bDecoded) {
+		sResult.strDetails = "decode failed";
+		return sResult;
+	}
+
+	const int nSourceWidth = nWidth;
+	const int nSourceHeight = nHeight;
+	downscaleToFit(vecPixels, nWidth, nHeight, sOptions.nMaxTextureSize);
+
+	std::vector<SMipLevel> vecMips;
+	std::vector<uint8_t> vecChain(mipChainLayout(static_cast<uint32_t>(nWidth), static_cast<uint32_t>(nHeight), 4, vecMips));
+	std::memcpy(vecChain.data(), vecPixels.data(), vecMips[0].uSize);
+	generateMipChainRgba8(vecChain.data(), vecMips);
+
+	const bool bAlpha = hasTransparentPixels(vecPixels);
+	uint32_t uFormat = kKtx2FormatR8G8B8A8Unorm;
+	if (sOptions.bEtc2Textures) {
+		uFormat = bAlpha ? kKtx2FormatEtc2R8G8B8A8Unorm : kKtx2FormatEtc2R8G8B8Unorm;
+	}
+	std::vector<SKtx2LevelData> vecLevels(vecMips.size());
+	for (size_t i = 0; i < vecMips.size(); ++i) {
+		const SMipLevel& sMip = vecMips[i];
+		vecLevels[i].uWidth = sMip.uWidth;
+		vecLevels[i].uHeight = sMip.uHeight;
+		const uint8_t* pLevel = vecChain.data() + sMip.uOffset;
+		if (sOptions.bEtc2Textures) {
+			encodeEtc2(pLevel, sMip.uWidth, sMip.uHeight, bAlpha, vecLevels[i].vecBytes, EEtc2Quality::High);
+		} else {
+			vecLevels[i].vecBytes.assign(pLevel, pLevel + sMip.uSize);
+		}
+	}
+	std::vector<uint8_t> vecContainer;
+	const bool bWritten = writeKtx2(uFormat, vecLevels, vecContainer);
+	const Clock::time_point tProcessEnd = Clock::now();
+	sResult.processMs = elapsedMs(tLoadEnd, tProcessEnd);
+	if (!bWritten) {
+		sResult.strDetails = "container failed";
+		return sResult;
+	}
+
+	if (!writeFile(fs::path(sOptions.strOutputDir) / sResult.strOutput, vecContainer.data(), vecContainer.size())) {
+		sResult.strDetails = "write failed";
+		return sResult;
+	}
+	sResult.writeMs = elapsedMs(tProcessEnd, Clock::now());
+	sResult.uOutputBytes = vecContainer.size();
+	sResult.bSuccess = true;
+
+	const char* pcFormat = "RGBA8";
+	if (uFormat == kKtx2FormatEtc2R8G8B8Unorm) {
+		pcFormat = "ETC2 RGB";
+	} else if (uFormat == kKtx2FormatEtc2R8G8B8A8Unorm) {
+		pcFormat = "ETC2 RGBA";
+	}
+	char acDetails[96];
+	std::snprintf(acDetails, sizeof(acDetails), "%dx%d -> %dx%d %s, %zu levels", nSourceWidth, nSourceHeight, nWidth, nHeight, pcFormat, vecLevels.size());
+	sResult.strDetails = acDetails;
+	return sResult;
+}
+
+template <typename Job>
+void runParallel(size_t uCount, unsigned uJobs, Job&& job) {
+	std::atomic<size_t> uNext{ 0 };
+	auto worker = [&]() {
+		for (size_t i = uNext.fetch_add(1); i < uCount; i = uNext.fetch_add(1)) {
+			job(i);
+		}
+	};
+	const unsigned uThreads = static_cast<unsigned>(std::min<size_t>(uJobs, std::max<size_t>(uCount, 1)));
+	std::vector<std::thread> vecThreads;
+	for (unsigned i = 1; i < uThreads; ++i) {
+		vecThreads.emplace_back(worker);
+	}
+	worker();
+	for (std::thread& thread : vecThreads) {
+		thread.join();
+	}
+}
+
+void printResult(const char* pcKind, const SCookResult& sResult) {
+	if (!sResult.bSuccess) {
+		std::fprintf(stderr, "FAIL %-7s %s (%s)\n", pcKind, sResult.strSource.c_str(), sResult.strDetails.c_str());
+		return;
+	}
+	std::printf("%-7s %s -> %s | load %.2f ms, process %.2f ms, write %.2f ms | %ju -> %zu bytes | %s\n",
+		pcKind,
+		sResult.strSource.c_str(),
+		sResult.strOutput.c_str(),
+		sResult.loadMs,
+		sResult.processMs,
+		sResult.writeMs,
+		sResult.uInputBytes,
+		sResult.uOutputBytes,
+		sResult.strDetails.c_str());
+}
+
+void printUsage() {
+	std::fprintf(stderr,
+		"usage: asset_cooker --input <dir> --output <dir> [--jobs N] [--max-texture-size N] [--texture-format etc2|rgba8] [--pack <file>] [--bench N] [assets...]\n");
+}
+
+bool parseArguments(int argc, char** argv, SCookerOptions& sOptions) {
+	for (int i = 1; i < argc; ++i) {
+		const std::string strArg = argv[i];
+		const bool bHasValue = i + 1 < argc;
+		if (strArg == "--input" && bHasValue) {
+			sOptions.strInputDir = argv[++i];
+		} else if (strArg == "--output" && bHasValue) {
+			sOptions.strOutputDir = argv[++i];
+		} else if (strArg == "--jobs" && bHasValue) {
+			sOptions.uJobs = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+		} else if (strArg == "--max-texture-size" && bHasValue) {
+			sOptions.nMaxTextureSize = std::atoi(argv[++i]);
+		} else if (strArg == "--texture-format" && bHasValue) {
+			const std::string strFormat = argv[++i];
+			if (strFormat != "etc2" && strFormat != "rgba8") return false;
+			sOptions.bEtc2Textures = strFormat == "etc2";
+		} else if (strArg == "--pack" && bHasValue) {
+			sOptions.strPackPath = argv[++i];
+		} else if (strArg == "--bench" && bHasValue) {
+			sOptions.nBenchIterations = std::atoi(argv[++i]);
+		} else if (!strArg.empty() && strArg[0] == '-') {
+			return false;
+		} else {
+			sOptions.vecAssets.push_back(strArg);
+		}
+	}
+	if (sOptions.uJobs == 0) {
+		sOptions.uJobs = std::max(1u, std::thread::hardware_concurrency());
+	}
+	return !sOptions.strInputDir.empty() && !sOptions.strOutputDir.empty();
+}
+
+bool buildPack(const SCookerOptions& sOptions, std::vector<std::string>& outEntries) {
+	const Clock::time_point tStart = Clock::now();
+	const fs::path packPath = fs::absolute(sOptions.strPackPath);
+	std::vector<SAssetPackInput> vecInputs;
+	uintmax_t uLooseBytes = 0;
+	std::error_code error;
+	for (const fs::directory_entry& entry : fs::recursive_directory_iterator(sOptions.strOutputDir, error)) {
+		if (!entry.is_regular_file() || fs::absolute(entry.path()) == packPath) continue;
+		SAssetPackInput sInput;
+		sInput.strPath = fs::relative(entry.path(), sOptions.strOutputDir).generic_string();
+		sInput.data = mapFile(entry.path().string());
+		if (!sInput.data) {
+			std::fprintf(stderr, "FAIL pack    %s (read failed)\n", sInput.strPath.c_str());
+			return false;
+		}
+		uLooseBytes += sInput.data.size();
+		outEntries.push_back(sInput.strPath);
+		vecInputs.push_back(std::move(sInput));
+	}
+
+	std::vector<uint8_t> vecPack;
+	if (!writeAssetPack(vecInputs, vecPack) || !writeFile(packPath, vecPack.data(), vecPack.size())) {
+		std::fprintf(stderr, "FAIL pack    %s\n", sOptions.strPackPath.c_str());
+		return false;
+	}
+	std::printf("pack    %s | %zu entries, %ju -> %zu bytes in %.2f ms\n",
+		sOptions.strPackPath.c_str(),
+		vecInputs.size(),
+		uLooseBytes,
+		vecPack.size(),
+		elapsedMs(tStart, Clock::now()));
+	return true;
+}
+
+// Source assets from the input directory with the cooked output layered
+// underneath, so the loader benchmark finds each model's .kmdl sibling.
+class CookedOverlaySource : public AssetSource {
+public:
+	CookedOverlaySource(const AssetSource& inputSource, const SCookerOptions& sOptions)
+		: input(inputSource), output(sOptions.strOutputDir, DirectoryAssetSource::EAccess::Read) {}
+
+	AssetData open(const std::string& strPath) const override {
+		AssetData data = input.open(strPath);
+		return data ? std::move(data) : output.open(strPath);
+	}
+
+private:
+	const AssetSource& input;
+	DirectoryAssetSource output;
+};
+
+// Opens every entry loose from the output directory and from the pack. The pack
+// is mounted again on each iteration so its TOC setup is part of the cost.
+void benchmarkPack(const SCookerOptions& sOptions, const std::vector<std::string>& vecEntries, const std::vector<std::string>& vecCookedModels) {
+	const int nIterations = sOptions.nBenchIterations;
+	const DirectoryAssetSource looseSource(sOptions.strOutputDir, DirectoryAssetSource::EAccess::Read);
+	size_t uChecksum = 0;
+
+	const Clock::time_point tLooseStart = Clock::now();
+	for (int i = 0; i < nIterations; ++i) {
+		for (const std::string& strEntry : vecEntries) {
+			const AssetData data = looseSource.open(strEntry);
+			uChecksum += data.size() > 0 ? data.data()[data.size() - 1] : 0;
+		}
+		for (const std::string& strModel : vecCookedModels) {
+			uChecksum += loadModel(looseSource, strModel).vertexCount();
+		}
+	}
+	const double looseMs = elapsedMs(tLooseStart, Clock::now()) / nIterations;
+
+	const Clock::time_point tPackStart = Clock::now();
+	for (int i = 0; i < nIterations; ++i) {
+		const std::shared_ptr<PackAssetSource> pPack = PackAssetSource::mount(mapFile(sOptions.strPackPath));
+		if (!pPack) {
+			std::fprintf(stderr, "FAIL bench   could not mount %s\n", sOptions.strPackPath.c_str());
+			return;
+		}
+		for (const std::string& strEntry : vecEntries) {
+			const AssetData data = pPack->open(strEntry);
+			uChecksum += data.size() > 0 ? data.data()[data.size() - 1] : 0;
+		}
+		for (const std::string& strModel : vecCookedModels) {
+			uChecksum += loadModel(*pPack, strModel).vertexCount();
+		}
+	}
+	const double packMs = elapsedMs(tPackStart, Clock::now()) / nIterations;
+
+	std::printf("bench   %zu entries + %zu cooked model loads: loose %.3f ms, pack %.3f ms (%.2fx), %d iterations [%zu]\n",
+		vecEntries.size(),
+		vecCookedModels.size(),
+		looseMs,
+		packMs,
+		packMs > 0.0 ? looseMs / packMs : 0.0,
+		nIterations,
+		uChecksum);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	SCookerOptions sOptions;
+	if (!parseArguments(argc, argv, sOptions)) {
+		printUsage();
+		return 2;
+	}
+
+	if (sOptions.vecAssets.empty()) {
+		std::error_code error;
+		for (const fs::directory_entry& entry : fs::recursive_directory_iterator(sOptions.strInputDir, error)) {
+			if (entry.is_regular_file()) {
+				sOptions.vecAssets.push_back(fs::relative(entry.path(), sOptions.strInputDir).generic_string());
+			}
+		}
+		std::sort(sOptions.vecAssets.begin(), sOptions.vecAssets.end());
+	}
+
+	std::vector<std::string> vecModels;
+	std::set<std::string> setTextures;
+	for (const std::string& strAsset : sOptions.vecAssets) {
+		if (isModelPath(strAsset)) {
+			vecModels.push_back(strAsset);
+		} else if (isTexturePath(strAsset)) {
+			setTextures.insert(strAsset);
+		}
+	}
+
+	const DirectoryAssetSource assetSource(sOptions.strInputDir);
+	const Clock::time_point tStart = Clock::now();
+
+	// Models first: they add the textures they reference to the texture set.
+	std::mutex textureMutex;
+	std::vector<SCookResult> vecModelResults(vecModels.size());
+	runParallel(vecModels.size(), sOptions.uJobs, [&](size_t i) {
+		vecModelResults[i] = cookModel(sOptions, assetSource, vecModels[i], setTextures, textureMutex);
+	});
+
+	const std::vector<std::string> vecTextures(setTextures.begin(), setTextures.end());
+	std::vector<SCookResult> vecTextureResults(vecTextures.size());
+	runParallel(vecTextures.size(), sOptions.uJobs, [&](size_t i) {
+		vecTextureResults[i] = cookTexture(sOptions, vecTextures[i]);
+	});
+	const double totalMs = elapsedMs(tStart, Clock::now());
+
+	size_t uFailures = 0;
+	uintmax_t uInputBytes = 0;
+	uintmax_t uOutputBytes = 0;
+	for (const SCookResult& sResult : vecModelResults) {
+		printResult("model", sResult);
+		uFailures += sResult.bSuccess ? 0 : 1;
+		uInputBytes += sResult.uInputBytes;
+		uOutputBytes += sResult.uOutputBytes;
+	}
+	for (const SCookResult& sResult : vecTextureResults) {
+		printResult("texture", sResult);
+		uFailures += sResult.bSuccess ? 0 : 1;
+		uInputBytes += sResult.uInputBytes;
+		uOutputBytes += sResult.uOutputBytes;
+	}
+	std::printf("cooked %zu models and %zu textures on %u threads in %.2f ms, %ju -> %ju bytes, %zu failed\n",
+		vecModels.size(),
+		vecTextures.size(),
+		sOptions.uJobs,
+		totalMs,
+		uInputBytes,
+		uOutputBytes,
+		uFailures);
+
+	if (sOptions.nBenchIterations > 0 && !vecModels.empty()) {
+		benchmarkModelLoaders(CookedOverlaySource(assetSource, sOptions), vecModels, sOptions.nBenchIterations);
+	}
+
+	if (!sOptions.strPackPath.empty()) {
+		std::vector<std::string> vecEntries;
+		if (!buildPack(sOptions, vecEntries)) {
+			return 1;
+		}
+		if (sOptions.nBenchIterations > 0) {
+			std::vector<std::string> vecCookedModels;
+			for (const SCookResult& sResult : vecModelResults) {
+				if (sResult.bSuccess) vecCookedModels.push_back(sResult.strOutput);
+			}
+			benchmarkPack(sOptions, vecEntries, vecCookedModels);
+		}
+	}
+
+	return uFailures == 0 ? 0 : 1;
+}
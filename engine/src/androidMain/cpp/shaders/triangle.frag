@@ -3,17 +3,25 @@
 
 layout(set = 0, binding = 0) uniform sampler2D texSampler;
 
+layout(push_constant) uniform MaterialConstants {
+	layout(offset = 64) vec4 baseColorFactor;
+	int hasTexture;
+} material;
+
 layout(location = 0) in vec3 fragNormal;
 layout(location = 1) in vec2 fragUV;
 
 layout(location=0) out vec4 outColor;
 
 void main() {
-	vec4 sampled = texture(texSampler, fragUV);
-	if (sampled.a <= 0.01f) {
+	vec4 color = material.baseColorFactor;
+	if (material.hasTexture != 0) {
+		color *= texture(texSampler, fragUV);
+	}
+	if (color.a <= 0.01f) {
 		discard;
 	}
-	outColor = sampled;
+	outColor = color;
 }
 
 
@@ -0,0 +1,28 @@
+// Fragment shader (GLSL) sampling from the descriptor-indexed texture table
+#version 450
+
+layout(constant_id = 0) const uint kTextureTableSize = 1u;
+
+layout(set = 0, binding = 0) uniform sampler2D textures[kTextureTableSize];
+
+layout(push_constant) uniform MaterialConstants {
+	layout(offset = 64) vec4 baseColorFactor;
+	int hasTexture;
+	int textureIndex;
+} material;
+
+layout(location = 0) in vec3 fragNormal;
+layout(location = 1) in vec2 fragUV;
+
+layout(location=0) out vec4 outColor;
+
+void main() {
+	vec4 color = material.baseColorFactor;
+	if (material.hasTexture != 0) {
+		color *= texture(textures[material.textureIndex], fragUV);
+	}
+	if (color.a <= 0.01f) {
+		discard;
+	}
+	outColor = color;
+}
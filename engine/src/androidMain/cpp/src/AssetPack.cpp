@@ -0,0 +1,210 @@
+#include "AssetPack.h"
+#include "Hash.h"
+#include "Lz4.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#define LOG_TAG "AssetPack"
+#include "Log.h"
+
+namespace {
+
+constexpr size_t kAssetPackAlignment = 16;
+
+size_t alignUp(size_t uValue) {
+	return (uValue + kAssetPackAlignment - 1) & ~(kAssetPackAlignment - 1);
+}
+
+uint64_t hashPath(const std::string& strPath) {
+	return hash64(strPath.data(), strPath.size());
+}
+
+// Below this, decoding costs more than the few bytes LZ4 saves.
+constexpr size_t kMinCompressedEntrySize = 4096;
+
+// Textures are already block or entropy compressed. Kept raw, they are served
+// as slices of the mapped archive instead of being decoded into a heap copy on
+// every load.
+bool isPrecompressed(const std::string& strPath) {
+	const std::string::size_type uDot = strPath.find_last_of('.');
+	if (uDot == std::string::npos) return false;
+	std::string strExtension = strPath.substr(uDot);
+	std::transform(strExtension.begin(), strExtension.end(), strExtension.begin(), [](unsigned char ch) {
+		return static_cast<char>(std::tolower(ch));
+	});
+	return strExtension == ".ktx2" || strExtension == ".png" || strExtension == ".jpg" || strExtension == ".jpeg";
+}
+
+} // namespace
+
+bool writeAssetPack(const std::vector<SAssetPackInput>& vecInputs, std::vector<uint8_t>& outBytes) {
+	struct SPending {
+		SAssetPackEntry sEntry{};
+		const SAssetPackInput* pInput = nullptr;
+		std::vector<uint8_t> vecCompressed;
+	};
+
+	std::vector<SPending> vecPending(vecInputs.size());
+	std::string strStrings;
+	for (size_t i = 0; i < vecInputs.size(); ++i) {
+		const SAssetPackInput& sInput = vecInputs[i];
+		if (sInput.strPath.empty() || sInput.strPath.size() > UINT32_MAX) return false;
+		SPending& sPending = vecPending[i];
+		sPending.pInput = &sInput;
+		sPending.sEntry.uPathHash = hashPath(sInput.strPath);
+		sPending.sEntry.uPathOffset = static_cast<uint32_t>(strStrings.size());
+		sPending.sEntry.uPathLength = static_cast<uint32_t>(sInput.strPath.size());
+		sPending.sEntry.uSize = sInput.data.size();
+		strStrings += sInput.strPath;
+
+		if (sInput.data.size() >= kMinCompressedEntrySize && !isPrecompressed(sInput.strPath)) {
+			lz4Compress(sInput.data.data(), sInput.data.size(), sPending.vecCompressed);
+		}
+		// Keep entries raw unless LZ4 saves at least an eighth.
+		if (!sPending.vecCompressed.empty() && sPending.vecCompressed.size() + sInput.data.size() / 8 < sInput.data.size()) {
+			sPending.sEntry.uCodec = static_cast<uint32_t>(EAssetPackCodec::Lz4);
+			sPending.sEntry.uStoredSize = sPending.vecCompressed.size();
+		} else {
+			sPending.sEntry.uCodec = static_cast<uint32_t>(EAssetPackCodec::Stored);
+			sPending.sEntry.uStoredSize = sInput.data.size();
+			std::vector<uint8_t>().swap(sPending.vecCompressed);
+		}
+	}
+
+	std::sort(vecPending.begin(), vecPending.end(), [](const SPending& a, const SPending& b) {
+		if (a.sEntry.uPathHash != b.sEntry.uPathHash) return a.sEntry.uPathHash < b.sEntry.uPathHash;
+		return a.pInput->strPath < b.pInput->strPath;
+	});
+	for (size_t i = 1; i < vecPending.size(); ++i) {
+		if (vecPending[i].pInput->strPath == vecPending[i - 1].pInput->strPath) {
+			LOGE("Duplicate pack entry: %s", vecPending[i].pInput->strPath.c_str());
+			return false;
+		}
+	}
+
+	SAssetPackHeader sHeader{};
+	sHeader.uMagic = kAssetPackMagic;
+	sHeader.uVersion = kAssetPackVersion;
+	sHeader.uEntryCount = static_cast<uint32_t>(vecPending.size());
+	sHeader.uTocOffset = alignUp(sizeof(SAssetPackHeader));
+	sHeader.uStringsOffset = sHeader.uTocOffset + sizeof(SAssetPackEntry) * vecPending.size();
+	sHeader.uStringsSize = strStrings.size();
+
+	size_t uCursor = alignUp(sHeader.uStringsOffset + sHeader.uStringsSize);
+	for (SPending& sPending : vecPending) {
+		sPending.sEntry.uOffset = uCursor;
+		uCursor = alignUp(uCursor + sPending.sEntry.uStoredSize);
+	}
+	sHeader.uFileSize = uCursor;
+
+	outBytes.assign(uCursor, 0);
+	std::memcpy(outBytes.data(), &sHeader, sizeof(sHeader));
+	for (size_t i = 0; i < vecPending.size(); ++i) {
+		const SPending& sPending = vecPending[i];
+		std::memcpy(outBytes.data() + sHeader.uTocOffset + i * sizeof(SAssetPackEntry), &sPending.sEntry, sizeof(SAssetPackEntry));
+		const uint8_t* pStored = sPending.sEntry.uCodec == static_cast<uint32_t>(EAssetPackCodec::Lz4)
+			? sPending.vecCompressed.data()
+			: sPending.pInput->data.data();
+		if (sPending.sEntry.uStoredSize > 0) {
+			std::memcpy(outBytes.data() + sPending.sEntry.uOffset, pStored, sPending.sEntry.uStoredSize);
+		}
+	}
+	if (!strStrings.empty()) {
+		std::memcpy(outBytes.data() + sHeader.uStringsOffset, strStrings.data(), strStrings.size());
+	}
+	return true;
+}
+
+std::shared_ptr<PackAssetSource> PackAssetSource::mount(AssetData packData, std::shared_ptr<const AssetSource> pFallback) {
+	SAssetPackHeader sHeader{};
+	if (packData.size() < sizeof(sHeader)) return nullptr;
+	std::memcpy(&sHeader, packData.data(), sizeof(sHeader));
+	if (sHeader.uMagic != kAssetPackMagic || sHeader.uVersion != kAssetPackVersion) {
+		LOGE("Not an asset pack (magic %08x, version %u)", sHeader.uMagic, sHeader.uVersion);
+		return nullptr;
+	}
+	const uint64_t uSize = packData.size();
+	if (sHeader.uFileSize != uSize ||
+		sHeader.uTocOffset > uSize ||
+		sHeader.uEntryCount > (uSize - sHeader.uTocOffset) / sizeof(SAssetPackEntry) ||
+		sHeader.uStringsOffset > uSize ||
+		sHeader.uStringsSize > uSize - sHeader.uStringsOffset) {
+		LOGE("Asset pack header is inconsistent with its %llu byte size", static_cast<unsigned long long>(uSize));
+		return nullptr;
+	}
+
+	std::shared_ptr<PackAssetSource> pSource(new PackAssetSource());
+	pSource->pToc = packData.data() + sHeader.uTocOffset;
+	pSource->pcStrings = reinterpret_cast<const char*>(packData.data() + sHeader.uStringsOffset);
+	pSource->uEntryCount = sHeader.uEntryCount;
+	for (size_t i = 0; i < pSource->uEntryCount; ++i) {
+		const SAssetPackEntry sEntry = pSource->entryAt(i);
+		const bool bKnownCodec = sEntry.uCodec == static_cast<uint32_t>(EAssetPackCodec::Stored) ||
+			sEntry.uCodec == static_cast<uint32_t>(EAssetPackCodec::Lz4);
+		if (!bKnownCodec ||
+			sEntry.uOffset > uSize || sEntry.uStoredSize > uSize - sEntry.uOffset ||
+			static_cast<uint64_t>(sEntry.uPathOffset) + sEntry.uPathLength > sHeader.uStringsSize ||
+			(sEntry.uCodec == static_cast<uint32_t>(EAssetPackCodec::Stored) && sEntry.uStoredSize != sEntry.uSize) ||
+			// LZ4 expands at most 255x, so a larger claim would only drive a huge allocation in open().
+			(sEntry.uCodec == static_cast<uint32_t>(EAssetPackCodec::Lz4) && sEntry.uSize > sEntry.uStoredSize * 255)) {
+			LOGE("Asset pack entry %zu is corrupt", i);
+			return nullptr;
+		}
+		// find() binary searches the TOC by path hash.
+		if (i > 0 && sEntry.uPathHash < pSource->entryAt(i - 1).uPathHash) {
+			LOGE("Asset pack TOC is not sorted at entry %zu", i);
+			return nullptr;
+		}
+	}
+	pSource->packData = std::move(packData);
+	pSource->pFallbackSource = std::move(pFallback);
+	LOGI("Mounted asset pack with %zu entries (%llu bytes)", pSource->uEntryCount, static_cast<unsigned long long>(uSize));
+	return pSource;
+}
+
+SAssetPackEntry PackAssetSource::entryAt(size_t uIndex) const {
+	SAssetPackEntry sEntry;
+	std::memcpy(&sEntry, pToc + uIndex * sizeof(SAssetPackEntry), sizeof(sEntry));
+	return sEntry;
+}
+
+bool PackAssetSource::find(const std::string& strPath, SAssetPackEntry& outEntry) const {
+	const uint64_t uHash = hashPath(strPath);
+	size_t uLow = 0;
+	size_t uHigh = uEntryCount;
+	while (uLow < uHigh) {
+		const size_t uMid = uLow + (uHigh - uLow) / 2;
+		if (entryAt(uMid).uPathHash < uHash) {
+			uLow = uMid + 1;
+		} else {
+			uHigh = uMid;
+		}
+	}
+	for (size_t i = uLow; i < uEntryCount; ++i) {
+		const SAssetPackEntry sEntry = entryAt(i);
+		if (sEntry.uPathHash != uHash) break;
+		if (sEntry.uPathLength == strPath.size() && std::memcmp(pcStrings + sEntry.uPathOffset, strPath.data(), strPath.size()) == 0) {
+			outEntry = sEntry;
+			return true;
+		}
+	}
+	return false;
+}
+
+AssetData PackAssetSource::open(const std::string& strPath) const {
+	SAssetPackEntry sEntry;
+	if (!find(strPath, sEntry)) {
+		return pFallbackSource ? pFallbackSource->open(strPath) : AssetData();
+	}
+	if (sEntry.uCodec == static_cast<uint32_t>(EAssetPackCodec::Stored)) {
+		return packData.slice(sEntry.uOffset, sEntry.uSize);
+	}
+	std::vector<uint8_t> vecBytes(sEntry.uSize);
+	if (!lz4Decompress(packData.data() + sEntry.uOffset, sEntry.uStoredSize, vecBytes.data(), vecBytes.size())) {
+		LOGE("Failed to decompress pack entry: %s", strPath.c_str());
+		return {};
+	}
+	return AssetData::fromBuffer(std::move(vecBytes));
+}
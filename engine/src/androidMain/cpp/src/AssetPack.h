@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "AssetSource.h"
+
+// Single-file asset archive (.kpak).
+//
+// Layout: SAssetPackHeader, the table of contents (SAssetPackEntry[] sorted by
+// path hash), the path string table, then entry data. Each entry is stored as
+// one LZ4 block, or raw when compression does not pay off (textures, small
+// files), so raw entries can be served straight from the mapped archive.
+
+constexpr const char* kAssetPackExtension = ".kpak";
+constexpr const char* kDefaultAssetPackName = "assets.kpak";
+constexpr uint32_t kAssetPackMagic = 0x4B41504Bu; // "KPAK"
+constexpr uint32_t kAssetPackVersion = 1;
+
+enum class EAssetPackCodec : uint32_t {
+	Stored = 0,
+	Lz4 = 1,
+};
+
+struct SAssetPackHeader {
+	uint32_t uMagic;
+	uint32_t uVersion;
+	uint32_t uEntryCount;
+	uint32_t uReserved;
+	uint64_t uTocOffset;
+	uint64_t uStringsOffset;
+	uint64_t uStringsSize;
+	uint64_t uFileSize;
+};
+static_assert(sizeof(SAssetPackHeader) == 48, "Unexpected asset pack header size");
+
+struct SAssetPackEntry {
+	uint64_t uPathHash;
+	uint64_t uOffset;
+	uint64_t uStoredSize;
+	uint64_t uSize;
+	uint32_t uPathOffset;
+	uint32_t uPathLength;
+	uint32_t uCodec;
+	uint32_t uReserved;
+};
+static_assert(sizeof(SAssetPackEntry) == 48, "Unexpected asset pack entry size");
+
+struct SAssetPackInput {
+	std::string strPath;
+	AssetData data;
+};
+
+bool writeAssetPack(const std::vector<SAssetPackInput>& vecInputs, std::vector<uint8_t>& outBytes);
+
+// Serves files from a mounted archive. Paths missing from the archive are
+// looked up in the optional fallback source.
+class PackAssetSource : public AssetSource {
+public:
+	// Returns null when packData is not a valid archive.
+	static std::shared_ptr<PackAssetSource> mount(AssetData packData, std::shared_ptr<const AssetSource> pFallback = nullptr);
+
+	// Stored entries are zero-copy slices of the archive; LZ4 entries are
+	// decompressed into a new buffer.
+	AssetData open(const std::string& strPath) const override;
+
+	size_t entryCount() const { return uEntryCount; }
+
+private:
+	PackAssetSource() = default;
+
+	bool find(const std::string& strPath, SAssetPackEntry& outEntry) const;
+	SAssetPackEntry entryAt(size_t uIndex) const;
+
+	AssetData packData;
+	std::shared_ptr<const AssetSource> pFallbackSource;
+	// APK assets are only 4-byte aligned, so entries are copied out, not cast.
+	const uint8_t* pToc = nullptr;
+	const char* pcStrings = nullptr;
+	size_t uEntryCount = 0;
+};
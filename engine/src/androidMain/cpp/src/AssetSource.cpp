@@ -0,0 +1,134 @@
+#include "AssetSource.h"
+
+#include <cstdio>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define LOG_TAG "AssetSource"
+#include "Log.h"
+
+AssetData AssetData::fromBuffer(std::vector<uint8_t>&& vecBytes) {
+	auto pBuffer = std::make_shared<std::vector<uint8_t>>(std::move(vecBytes));
+	AssetData sData;
+	sData.pBytes = pBuffer->data();
+	sData.uSize = pBuffer->size();
+	sData.pOwner = std::move(pBuffer);
+	return sData;
+}
+
+AssetData AssetData::fromView(const void* pData, size_t uSize, std::shared_ptr<const void> pOwner) {
+	AssetData sData;
+	sData.pBytes = static_cast<const uint8_t*>(pData);
+	sData.uSize = uSize;
+	sData.pOwner = std::move(pOwner);
+	return sData;
+}
+
+AssetData AssetData::slice(size_t uOffset, size_t uLength) const {
+	if (uOffset > uSize || uLength > uSize - uOffset) return {};
+	return fromView(pBytes + uOffset, uLength, pOwner);
+}
+
+#ifdef __ANDROID__
+AssetData ApkAssetSource::open(const std::string& strPath) const {
+	if (!strPath.empty() && strPath.front() == '/') {
+		return DirectoryAssetSource("").open(strPath);
+	}
+	if (!pAssetManager) return {};
+	AAsset* pAsset = AAssetManager_open(pAssetManager, strPath.c_str(), AASSET_MODE_BUFFER);
+	if (!pAsset) {
+		LOGE("Failed to open asset: %s", strPath.c_str());
+		return {};
+	}
+	const void* pBuffer = AAsset_getBuffer(pAsset);
+	const off_t length = AAsset_getLength(pAsset);
+	if (!pBuffer || length < 0) {
+		LOGE("Failed to read asset: %s", strPath.c_str());
+		AAsset_close(pAsset);
+		return {};
+	}
+	std::shared_ptr<const void> pOwner(pAsset, [](const void* pHandle) {
+		AAsset_close(static_cast<AAsset*>(const_cast<void*>(pHandle)));
+	});
+	return AssetData::fromView(pBuffer, static_cast<size_t>(length), std::move(pOwner));
+}
+
+bool ApkAssetSource::exists(const std::string& strPath) const {
+	if (!pAssetManager) return false;
+	AAsset* pAsset = AAssetManager_open(pAssetManager, strPath.c_str(), AASSET_MODE_UNKNOWN);
+	if (!pAsset) return false;
+	AAsset_close(pAsset);
+	return true;
+}
+#endif
+
+AssetData readFile(const std::string& strPath) {
+	FILE* pFile = std::fopen(strPath.c_str(), "rb");
+	if (!pFile) return {};
+	std::vector<uint8_t> vecBytes;
+	if (std::fseek(pFile, 0, SEEK_END) == 0) {
+		const long length = std::ftell(pFile);
+		if (length > 0) {
+			vecBytes.resize(static_cast<size_t>(length));
+		}
+		std::fseek(pFile, 0, SEEK_SET);
+	}
+	const size_t uRead = vecBytes.empty() ? 0 : std::fread(vecBytes.data(), 1, vecBytes.size(), pFile);
+	std::fclose(pFile);
+	if (uRead != vecBytes.size()) return {};
+	return AssetData::fromBuffer(std::move(vecBytes));
+}
+
+AssetData mapFile(const std::string& strPath) {
+#ifdef _WIN32
+	return readFile(strPath);
+#else
+	const int fd = ::open(strPath.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) return {};
+	struct stat sStat {};
+	if (fstat(fd, &sStat) != 0 || sStat.st_size <= 0) {
+		close(fd);
+		// mmap cannot map zero bytes; let the read path produce the handle.
+		return readFile(strPath);
+	}
+	const size_t uLength = static_cast<size_t>(sStat.st_size);
+	void* pMapping = mmap(nullptr, uLength, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (pMapping == MAP_FAILED) return readFile(strPath);
+	std::shared_ptr<const void> pOwner(pMapping, [uLength](const void* pAddress) {
+		munmap(const_cast<void*>(pAddress), uLength);
+	});
+	return AssetData::fromView(pMapping, uLength, std::move(pOwner));
+#endif
+}
+
+AssetData DirectoryAssetSource::open(const std::string& strPath) const {
+	const std::string strFullPath = strRoot.empty() ? strPath : strRoot + "/" + strPath;
+	AssetData data = eAccess == EAccess::Map ? mapFile(strFullPath) : readFile(strFullPath);
+	if (!data) {
+		LOGE("Failed to read file: %s", strFullPath.c_str());
+	}
+	return data;
+}
+
+void MemoryAssetSource::add(const std::string& strPath, AssetData data) {
+	mapBlobs[strPath] = std::move(data);
+}
+
+void MemoryAssetSource::add(const std::string& strPath, std::vector<uint8_t>&& vecBytes) {
+	mapBlobs[strPath] = AssetData::fromBuffer(std::move(vecBytes));
+}
+
+AssetData MemoryAssetSource::open(const std::string& strPath) const {
+	auto it = mapBlobs.find(strPath);
+	if (it == mapBlobs.end()) {
+		LOGE("Unknown in-memory asset: %s", strPath.c_str());
+		return {};
+	}
+	return it->second;
+}
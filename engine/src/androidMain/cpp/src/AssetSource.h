@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __ANDROID__
+#include <android/asset_manager.h>
+#endif
+
+// Read-only bytes of one asset. Keeps whatever backs them (an open AAsset, an
+// owned buffer) alive for as long as any copy of the handle exists.
+class AssetData {
+public:
+	AssetData() = default;
+
+	static AssetData fromBuffer(std::vector<uint8_t>&& vecBytes);
+	static AssetData fromView(const void* pData, size_t uSize, std::shared_ptr<const void> pOwner);
+
+	const uint8_t* data() const { return pBytes; }
+	size_t size() const { return uSize; }
+	bool empty() const { return uSize == 0; }
+	explicit operator bool() const { return pBytes != nullptr; }
+	std::string_view view() const { return std::string_view(reinterpret_cast<const char*>(pBytes), uSize); }
+
+	// A sub-range that shares ownership with this handle, without copying.
+	AssetData slice(size_t uOffset, size_t uLength) const;
+
+private:
+	const uint8_t* pBytes = nullptr;
+	size_t uSize = 0;
+	std::shared_ptr<const void> pOwner;
+};
+
+// Where loaders read model, texture and shader files from.
+class AssetSource {
+public:
+	virtual ~AssetSource() = default;
+
+	// Returns an empty handle when the asset cannot be opened.
+	virtual AssetData open(const std::string& strPath) const = 0;
+};
+
+#ifdef __ANDROID__
+// Files packaged in the APK assets folder. Absolute paths (models downloaded or
+// picked at runtime, and their textures) are read from the filesystem instead.
+class ApkAssetSource : public AssetSource {
+public:
+	explicit ApkAssetSource(AAssetManager* pManager) : pAssetManager(pManager) {}
+
+	AssetData open(const std::string& strPath) const override;
+	bool exists(const std::string& strPath) const;
+
+private:
+	AAssetManager* pAssetManager = nullptr;
+};
+#endif
+
+// Whole-file helpers that return an empty handle on failure without logging.
+// mapFile falls back to readFile where mmap is unavailable.
+AssetData readFile(const std::string& strPath);
+AssetData mapFile(const std::string& strPath);
+
+// Plain files below a root directory, either mapped (the default, zero-copy)
+// or read into memory.
+class DirectoryAssetSource : public AssetSource {
+public:
+	enum class EAccess { Map, Read };
+
+	explicit DirectoryAssetSource(std::string strRootPath, EAccess eAccessMode = EAccess::Map)
+		: strRoot(std::move(strRootPath)), eAccess(eAccessMode) {}
+
+	AssetData open(const std::string& strPath) const override;
+
+private:
+	std::string strRoot;
+	EAccess eAccess;
+};
+
+// Blobs registered up front, e.g. embedded test data or files already in memory.
+class MemoryAssetSource : public AssetSource {
+public:
+	void add(const std::string& strPath, AssetData data);
+	void add(const std::string& strPath, std::vector<uint8_t>&& vecBytes);
+
+	AssetData open(const std::string& strPath) const override;
+
+private:
+	std::unordered_map<std::string, AssetData> mapBlobs;
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+// Blocking FIFO with a fixed capacity, used to hand work between pipeline
+// stages. push() waits while the queue is full so a fast producer cannot run
+// arbitrarily far ahead of its consumer. After close() pending and future
+// calls return false and queued items are dropped.
+template <typename T>
+class BoundedQueue {
+public:
+	explicit BoundedQueue(size_t uMaxItems) : uCapacity(uMaxItems > 0 ? uMaxItems : 1) {}
+
+	bool push(T&& item) {
+		std::unique_lock<std::mutex> lock(mutex);
+		notFull.wait(lock, [this]() { return bClosed || items.size() < uCapacity; });
+		if (bClosed) return false;
+		items.push_back(std::move(item));
+		notEmpty.notify_one();
+		return true;
+	}
+
+	// Like push() but fails instead of waiting when the queue is full.
+	bool tryPush(T&& item) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (bClosed || items.size() >= uCapacity) return false;
+		items.push_back(std::move(item));
+		notEmpty.notify_one();
+		return true;
+	}
+
+	bool pop(T& outItem) {
+		std::unique_lock<std::mutex> lock(mutex);
+		notEmpty.wait(lock, [this]() { return bClosed || !items.empty(); });
+		if (bClosed) return false;
+		outItem = std::move(items.front());
+		items.pop_front();
+		notFull.notify_one();
+		return true;
+	}
+
+	// Waits like pop(), then takes every queued item.
+	bool popAll(std::vector<T>& outItems) {
+		std::unique_lock<std::mutex> lock(mutex);
+		notEmpty.wait(lock, [this]() { return bClosed || !items.empty(); });
+		if (bClosed) return false;
+		outItems.clear();
+		for (T& item : items) {
+			outItems.push_back(std::move(item));
+		}
+		items.clear();
+		notFull.notify_all();
+		return true;
+	}
+
+	void close() {
+		std::lock_guard<std::mutex> lock(mutex);
+		bClosed = true;
+		items.clear();
+		notEmpty.notify_all();
+		notFull.notify_all();
+	}
+
+private:
+	std::mutex mutex;
+	std::condition_variable notEmpty;
+	std::condition_variable notFull;
+	std::deque<T> items;
+	size_t uCapacity;
+	bool bClosed = false;
+};
@@ -0,0 +1,358 @@
+#include "CookedModel.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#define LOG_TAG "CookedModel"
+#include "Log.h"
+
+namespace {
+
+constexpr size_t kSectionCount = static_cast<size_t>(ECookedSection::Count);
+
+size_t alignUp(size_t uValue, size_t uAlignment) {
+	return (uValue + uAlignment - 1) & ~(uAlignment - 1);
+}
+
+struct SSectionWriter {
+	std::vector<uint8_t>& vecBytes;
+	SCookedSection* pSections;
+
+	void append(ECookedSection eSection, const void* pData, size_t uSize) {
+		const size_t uOffset = alignUp(vecBytes.size(), kCookedModelAlignment);
+		vecBytes.resize(uOffset + uSize, 0);
+		if (uSize > 0) {
+			std::memcpy(vecBytes.data() + uOffset, pData, uSize);
+		}
+		SCookedSection& sSection = pSections[static_cast<size_t>(eSection)];
+		sSection.uOffset = uOffset;
+		sSection.uSize = uSize;
+	}
+};
+
+SCookedSubset toCookedSubset(const Model::Subset& sSubset) {
+	SCookedSubset sCooked{};
+	sCooked.uIndexOffset = sSubset.indexOffset;
+	sCooked.uIndexCount = sSubset.indexCount;
+	sCooked.uMaterialIndex = sSubset.materialIndex;
+	return sCooked;
+}
+
+Model::Subset fromCookedSubset(const SCookedSubset& sCooked) {
+	Model::Subset sSubset;
+	sSubset.indexOffset = sCooked.uIndexOffset;
+	sSubset.indexCount = sCooked.uIndexCount;
+	sSubset.materialIndex = static_cast<uint16_t>(sCooked.uMaterialIndex);
+	return sSubset;
+}
+
+template <typename T>
+bool readSection(const uint8_t* pBytes, const SCookedSection* pSections, ECookedSection eSection, std::vector<T>& outValues) {
+	const SCookedSection& sSection = pSections[static_cast<size_t>(eSection)];
+	if (sSection.uSize % sizeof(T) != 0) {
+		LOGE("Cooked section %u has size %llu, not a multiple of %zu",
+			static_cast<unsigned>(eSection),
+			static_cast<unsigned long long>(sSection.uSize),
+			sizeof(T));
+		return false;
+	}
+	outValues.resize(static_cast<size_t>(sSection.uSize / sizeof(T)));
+	if (sSection.uSize > 0) {
+		std::memcpy(outValues.data(), pBytes + sSection.uOffset, static_cast<size_t>(sSection.uSize));
+	}
+	return true;
+}
+
+} // namespace
+
+void packModelVertices(const Model& model, std::vector<float>& outVertices) {
+	if (model.hasPackedVertices()) {
+		outVertices = model.packedVertices;
+		return;
+	}
+	const size_t uVertexCount = model.vertexCount();
+	outVertices.assign(uVertexCount * Model::kPackedVertexFloats, 0.0f);
+	const bool bHasNormals = model.normals.size() >= uVertexCount * 3;
+	const bool bHasTexcoords = model.texcoords.size() >= uVertexCount * 2;
+	for (size_t i = 0; i < uVertexCount; ++i) {
+		float* pOut = outVertices.data() + i * Model::kPackedVertexFloats;
+		pOut[0] = model.positions[i * 3];
+		pOut[1] = model.positions[i * 3 + 1];
+		pOut[2] = model.positions[i * 3 + 2];
+		if (bHasNormals) {
+			pOut[3] = model.normals[i * 3];
+			pOut[4] = model.normals[i * 3 + 1];
+			pOut[5] = model.normals[i * 3 + 2];
+		}
+		if (bHasTexcoords) {
+			pOut[6] = model.texcoords[i * 2];
+			pOut[7] = model.texcoords[i * 2 + 1];
+		}
+	}
+}
+
+void computeModelBounds(Model& model) {
+	const size_t uVertexCount = model.vertexCount();
+	if (uVertexCount == 0) {
+		model.bounds = Model::Bounds{};
+		return;
+	}
+	const bool bPacked = model.positions.empty();
+	const size_t uStride = bPacked ? Model::kPackedVertexFloats : 3;
+	const float* pPositions = bPacked ? model.packedVertices.data() : model.positions.data();
+	Model::Bounds sBounds;
+	for (int axis = 0; axis < 3; ++axis) {
+		sBounds.min[axis] = std::numeric_limits<float>::max();
+		sBounds.max[axis] = std::numeric_limits<float>::lowest();
+	}
+	for (size_t i = 0; i < uVertexCount; ++i) {
+		const float* pPosition = pPositions + i * uStride;
+		for (int axis = 0; axis < 3; ++axis) {
+			sBounds.min[axis] = std::min(sBounds.min[axis], pPosition[axis]);
+			sBounds.max[axis] = std::max(sBounds.max[axis], pPosition[axis]);
+		}
+	}
+	model.bounds = sBounds;
+}
+
+bool writeCookedModel(const Model& model, std::vector<uint8_t>& outBytes) {
+	if (!model.hasGeometry()) {
+		LOGE("Refusing to cook a model without geometry");
+		return false;
+	}
+
+	std::vector<float> vecVertices;
+	packModelVertices(model, vecVertices);
+
+	std::string strStrings;
+	std::vector<SCookedMaterial> vecMaterials;
+	vecMaterials.reserve(model.materials.size());
+	for (const Material& sMaterial : model.materials) {
+		SCookedMaterial sCooked{};
+		std::copy(sMaterial.diffuseColor.begin(), sMaterial.diffuseColor.end(), sCooked.fDiffuseColor);
+		sCooked.uNameOffset = static_cast<uint32_t>(strStrings.size());
+		sCooked.uNameLength = static_cast<uint32_t>(sMaterial.name.size());
+		strStrings += sMaterial.name;
+		sCooked.uTextureOffset = static_cast<uint32_t>(strStrings.size());
+		sCooked.uTextureLength = static_cast<uint32_t>(sMaterial.diffuseTexture.size());
+		strStrings += sMaterial.diffuseTexture;
+		vecMaterials.push_back(sCooked);
+	}
+
+	std::vector<SCookedSubset> vecSubsets;
+	vecSubsets.reserve(model.subsets.size());
+	for (const Model::Subset& sSubset : model.subsets) {
+		vecSubsets.push_back(toCookedSubset(sSubset));
+	}
+	std::vector<SCookedSubset> vecLodSubsets;
+	vecLodSubsets.reserve(model.lodSubsets.size());
+	for (const Model::Subset& sSubset : model.lodSubsets) {
+		vecLodSubsets.push_back(toCookedSubset(sSubset));
+	}
+	std::vector<SCookedLod> vecLods;
+	vecLods.reserve(model.lods.size());
+	for (const Model::Lod& sLod : model.lods) {
+		SCookedLod sCooked{};
+		sCooked.uSubsetOffset = sLod.subsetOffset;
+		sCooked.uSubsetCount = sLod.subsetCount;
+		sCooked.fError = sLod.error;
+		vecLods.push_back(sCooked);
+	}
+	std::vector<SCookedMeshlet> vecMeshlets;
+	vecMeshlets.reserve(model.meshlets.size());
+	for (const Model::Meshlet& sMeshlet : model.meshlets) {
+		SCookedMeshlet sCooked{};
+		sCooked.uVertexOffset = sMeshlet.vertexOffset;
+		sCooked.uTriangleOffset = sMeshlet.triangleOffset;
+		sCooked.uVertexCount = sMeshlet.vertexCount;
+		sCooked.uTriangleCount = sMeshlet.triangleCount;
+		std::copy(sMeshlet.center, sMeshlet.center + 3, sCooked.fCenter);
+		sCooked.fRadius = sMeshlet.radius;
+		vecMeshlets.push_back(sCooked);
+	}
+
+	Model sBoundsModel;
+	sBoundsModel.packedVertices = vecVertices;
+	computeModelBounds(sBoundsModel);
+
+	SCookedModelHeader sHeader{};
+	sHeader.uMagic = kCookedModelMagic;
+	sHeader.uVersion = kCookedModelVersion;
+	sHeader.uHeaderSize = static_cast<uint32_t>(sizeof(SCookedModelHeader) + sizeof(SCookedSection) * kSectionCount);
+	sHeader.uSectionCount = static_cast<uint32_t>(kSectionCount);
+	sHeader.uVertexStride = static_cast<uint32_t>(sizeof(float) * Model::kPackedVertexFloats);
+	sHeader.uVertexCount = static_cast<uint32_t>(vecVertices.size() / Model::kPackedVertexFloats);
+	sHeader.uIndexCount = static_cast<uint32_t>(model.indices.size());
+	std::copy(sBoundsModel.bounds.min, sBoundsModel.bounds.min + 3, sHeader.fBoundsMin);
+	std::copy(sBoundsModel.bounds.max, sBoundsModel.bounds.max + 3, sHeader.fBoundsMax);
+
+	SCookedSection arrSections[kSectionCount] = {};
+	outBytes.clear();
+	outBytes.resize(sHeader.uHeaderSize, 0);
+
+	SSectionWriter sWriter{ outBytes, arrSections };
+	sWriter.append(ECookedSection::Vertices, vecVertices.data(), vecVertices.size() * sizeof(float));
+	sWriter.append(ECookedSection::Indices, model.indices.data(), model.indices.size() * sizeof(uint32_t));
+	sWriter.append(ECookedSection::Subsets, vecSubsets.data(), vecSubsets.size() * sizeof(SCookedSubset));
+	sWriter.append(ECookedSection::Materials, vecMaterials.data(), vecMaterials.size() * sizeof(SCookedMaterial));
+	sWriter.append(ECookedSection::Strings, strStrings.data(), strStrings.size());
+	sWriter.append(ECookedSection::Lods, vecLods.data(), vecLods.size() * sizeof(SCookedLod));
+	sWriter.append(ECookedSection::LodSubsets, vecLodSubsets.data(), vecLodSubsets.size() * sizeof(SCookedSubset));
+	sWriter.append(ECookedSection::Meshlets, vecMeshlets.data(), vecMeshlets.size() * sizeof(SCookedMeshlet));
+	sWriter.append(ECookedSection::MeshletVertices, model.meshletVertices.data(), model.meshletVertices.size() * sizeof(uint32_t));
+	sWriter.append(ECookedSection::MeshletTriangles, model.meshletTriangles.data(), model.meshletTriangles.size());
+	outBytes.resize(alignUp(outBytes.size(), kCookedModelAlignment), 0);
+
+	sHeader.uFileSize = outBytes.size();
+	std::memcpy(outBytes.data(), &sHeader, sizeof(sHeader));
+	std::memcpy(outBytes.data() + sizeof(sHeader), arrSections, sizeof(arrSections));
+	return true;
+}
+
+bool readCookedModel(const void* pData, size_t uSize, Model& outModel) {
+	const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+	if (!pBytes || uSize < sizeof(SCookedModelHeader)) {
+		LOGE("Cooked model blob too small (%zu bytes)", uSize);
+		return false;
+	}
+	SCookedModelHeader sHeader;
+	std::memcpy(&sHeader, pBytes, sizeof(sHeader));
+	if (sHeader.uMagic != kCookedModelMagic) {
+		LOGE("Cooked model has bad magic 0x%08x", sHeader.uMagic);
+		return false;
+	}
+	if (sHeader.uVersion != kCookedModelVersion) {
+		LOGE("Cooked model version %u, expected %u", sHeader.uVersion, kCookedModelVersion);
+		return false;
+	}
+	// Cache entries come from disk, so nothing past the header is trusted.
+	const size_t uExpectedHeaderSize = sizeof(SCookedModelHeader) + sizeof(SCookedSection) * kSectionCount;
+	if (sHeader.uSectionCount != kSectionCount || sHeader.uHeaderSize != uExpectedHeaderSize ||
+		uSize < sHeader.uHeaderSize || sHeader.uFileSize > uSize) {
+		LOGE("Cooked model header is truncated or inconsistent");
+		return false;
+	}
+	if (sHeader.uVertexStride != sizeof(float) * Model::kPackedVertexFloats) {
+		LOGE("Cooked model vertex stride %u is not supported", sHeader.uVertexStride);
+		return false;
+	}
+
+	SCookedSection arrSections[kSectionCount];
+	std::memcpy(arrSections, pBytes + sizeof(SCookedModelHeader), sizeof(arrSections));
+	for (size_t i = 0; i < kSectionCount; ++i) {
+		const SCookedSection& sSection = arrSections[i];
+		if (sSection.uOffset % kCookedModelAlignment != 0 || sSection.uOffset > uSize || sSection.uSize > uSize - sSection.uOffset) {
+			LOGE("Cooked model section %zu is out of bounds", i);
+			return false;
+		}
+	}
+
+	Model sModel;
+	std::vector<SCookedSubset> vecSubsets;
+	std::vector<SCookedMaterial> vecMaterials;
+	std::vector<char> vecStrings;
+	std::vector<SCookedLod> vecLods;
+	std::vector<SCookedSubset> vecLodSubsets;
+	std::vector<SCookedMeshlet> vecMeshlets;
+	if (!readSection(pBytes, arrSections, ECookedSection::Vertices, sModel.packedVertices) ||
+		!readSection(pBytes, arrSections, ECookedSection::Indices, sModel.indices) ||
+		!readSection(pBytes, arrSections, ECookedSection::Subsets, vecSubsets) ||
+		!readSection(pBytes, arrSections, ECookedSection::Materials, vecMaterials) ||
+		!readSection(pBytes, arrSections, ECookedSection::Strings, vecStrings) ||
+		!readSection(pBytes, arrSections, ECookedSection::Lods, vecLods) ||
+		!readSection(pBytes, arrSections, ECookedSection::LodSubsets, vecLodSubsets) ||
+		!readSection(pBytes, arrSections, ECookedSection::Meshlets, vecMeshlets) ||
+		!readSection(pBytes, arrSections, ECookedSection::MeshletVertices, sModel.meshletVertices) ||
+		!readSection(pBytes, arrSections, ECookedSection::MeshletTriangles, sModel.meshletTriangles)) {
+		return false;
+	}
+	if (sModel.packedVertices.size() != static_cast<size_t>(sHeader.uVertexCount) * Model::kPackedVertexFloats ||
+		sModel.indices.size() != sHeader.uIndexCount) {
+		LOGE("Cooked model counts do not match header");
+		return false;
+	}
+
+	auto readString = [&vecStrings](uint32_t uOffset, uint32_t uLength) -> std::string {
+		if (static_cast<size_t>(uOffset) + uLength > vecStrings.size()) {
+			LOGW("Cooked material string out of range");
+			return {};
+		}
+		return std::string(vecStrings.data() + uOffset, uLength);
+	};
+	sModel.materials.reserve(vecMaterials.size());
+	for (const SCookedMaterial& sCooked : vecMaterials) {
+		Material sMaterial;
+		std::copy(sCooked.fDiffuseColor, sCooked.fDiffuseColor + 3, sMaterial.diffuseColor.begin());
+		sMaterial.name = readString(sCooked.uNameOffset, sCooked.uNameLength);
+		sMaterial.diffuseTexture = readString(sCooked.uTextureOffset, sCooked.uTextureLength);
+		sModel.materials.push_back(std::move(sMaterial));
+	}
+	const uint32_t uVertexCount = sHeader.uVertexCount;
+	if (std::any_of(sModel.indices.begin(), sModel.indices.end(), [uVertexCount](uint32_t uIndex) { return uIndex >= uVertexCount; })) {
+		LOGE("Cooked model index exceeds vertex count %u", uVertexCount);
+		return false;
+	}
+	// Models without materials draw every subset with material 0.
+	const size_t uMaterialLimit = std::max<size_t>(sModel.materials.size(), 1);
+	auto validSubset = [&](const SCookedSubset& sCooked) {
+		return static_cast<size_t>(sCooked.uIndexOffset) + sCooked.uIndexCount <= sModel.indices.size() &&
+			sCooked.uMaterialIndex <= std::numeric_limits<uint16_t>::max() &&
+			sCooked.uMaterialIndex < uMaterialLimit;
+	};
+	if (!std::all_of(vecSubsets.begin(), vecSubsets.end(), validSubset) ||
+		!std::all_of(vecLodSubsets.begin(), vecLodSubsets.end(), validSubset)) {
+		LOGE("Cooked model subset exceeds index buffer or material list");
+		return false;
+	}
+	sModel.subsets.reserve(vecSubsets.size());
+	for (const SCookedSubset& sCooked : vecSubsets) {
+		sModel.subsets.push_back(fromCookedSubset(sCooked));
+	}
+	sModel.lodSubsets.reserve(vecLodSubsets.size());
+	for (const SCookedSubset& sCooked : vecLodSubsets) {
+		sModel.lodSubsets.push_back(fromCookedSubset(sCooked));
+	}
+	sModel.lods.reserve(vecLods.size());
+	for (const SCookedLod& sCooked : vecLods) {
+		if (static_cast<size_t>(sCooked.uSubsetOffset) + sCooked.uSubsetCount > sModel.lodSubsets.size()) {
+			LOGE("Cooked model LOD exceeds LOD subset list");
+			return false;
+		}
+		Model::Lod sLod;
+		sLod.subsetOffset = sCooked.uSubsetOffset;
+		sLod.subsetCount = sCooked.uSubsetCount;
+		sLod.error = sCooked.fError;
+		sModel.lods.push_back(sLod);
+	}
+	if (std::any_of(sModel.meshletVertices.begin(), sModel.meshletVertices.end(), [uVertexCount](uint32_t uIndex) { return uIndex >= uVertexCount; })) {
+		LOGE("Cooked model meshlet vertex exceeds vertex count %u", uVertexCount);
+		return false;
+	}
+	sModel.meshlets.reserve(vecMeshlets.size());
+	for (const SCookedMeshlet& sCooked : vecMeshlets) {
+		// Triangles hold three local indices into the meshlet's vertex range.
+		const size_t uTriangleEnd = static_cast<size_t>(sCooked.uTriangleOffset) + static_cast<size_t>(sCooked.uTriangleCount) * 3;
+		if (static_cast<size_t>(sCooked.uVertexOffset) + sCooked.uVertexCount > sModel.meshletVertices.size() ||
+			uTriangleEnd > sModel.meshletTriangles.size() ||
+			std::any_of(sModel.meshletTriangles.begin() + sCooked.uTriangleOffset, sModel.meshletTriangles.begin() + uTriangleEnd,
+				[&sCooked](uint8_t uLocal) { return uLocal >= sCooked.uVertexCount; })) {
+			LOGE("Cooked model meshlet exceeds meshlet vertex or triangle list");
+			return false;
+		}
+		Model::Meshlet sMeshlet;
+		sMeshlet.vertexOffset = sCooked.uVertexOffset;
+		sMeshlet.triangleOffset = sCooked.uTriangleOffset;
+		sMeshlet.vertexCount = sCooked.uVertexCount;
+		sMeshlet.triangleCount = sCooked.uTriangleCount;
+		std::copy(sCooked.fCenter, sCooked.fCenter + 3, sMeshlet.center);
+		sMeshlet.radius = sCooked.fRadius;
+		sModel.meshlets.push_back(sMeshlet);
+	}
+	std::copy(sHeader.fBoundsMin, sHeader.fBoundsMin + 3, sModel.bounds.min);
+	std::copy(sHeader.fBoundsMax, sHeader.fBoundsMax + 3, sModel.bounds.max);
+
+	outModel = std::move(sModel);
+	return true;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Model.h"
+
+// Binary "cooked" model layout. All sections start on a 16 byte boundary so a
+// mapped file can be copied section by section straight into staging memory.
+//
+//   SCookedModelHeader
+//   SCookedSection[ECookedSection::Count]
+//   section payloads (16 byte aligned, zero padded)
+//
+// Integers and floats are stored little endian, which matches every target we
+// build for.
+
+constexpr const char* kCookedModelExtension = ".kmdl";
+constexpr uint32_t kCookedModelMagic = 0x4C444D4Bu; // "KMDL"
+constexpr uint32_t kCookedModelVersion = 1;
+constexpr size_t kCookedModelAlignment = 16;
+
+enum class ECookedSection : uint32_t {
+	Vertices = 0,       // float[8] per vertex: pos3, normal3, uv2
+	Indices,            // uint32_t
+	Subsets,            // SCookedSubset
+	Materials,          // SCookedMaterial
+	Strings,            // char, referenced by materials
+	Lods,               // SCookedLod
+	LodSubsets,         // SCookedSubset
+	Meshlets,           // SCookedMeshlet
+	MeshletVertices,    // uint32_t
+	MeshletTriangles,   // uint8_t
+	Count
+};
+
+struct SCookedSection {
+	uint64_t uOffset;
+	uint64_t uSize;
+};
+
+struct SCookedModelHeader {
+	uint32_t uMagic;
+	uint32_t uVersion;
+	uint32_t uHeaderSize;     // Header plus section table
+	uint32_t uSectionCount;
+	uint32_t uVertexStride;   // Bytes per packed vertex
+	uint32_t uVertexCount;
+	uint32_t uIndexCount;
+	uint32_t uFlags;
+	float fBoundsMin[3];
+	float fBoundsMax[3];
+	uint64_t uFileSize;
+};
+
+struct SCookedSubset {
+	uint32_t uIndexOffset;
+	uint32_t uIndexCount;
+	uint32_t uMaterialIndex;
+	uint32_t uReserved;
+};
+
+struct SCookedMaterial {
+	float fDiffuseColor[3];
+	uint32_t uNameOffset;
+	uint32_t uNameLength;
+	uint32_t uTextureOffset;
+	uint32_t uTextureLength;
+	uint32_t uReserved;
+};
+
+struct SCookedLod {
+	uint32_t uSubsetOffset;
+	uint32_t uSubsetCount;
+	float fError;
+	uint32_t uReserved;
+};
+
+struct SCookedMeshlet {
+	uint32_t uVertexOffset;
+	uint32_t uTriangleOffset;
+	uint32_t uVertexCount;
+	uint32_t uTriangleCount;
+	float fCenter[3];
+	float fRadius;
+};
+
+static_assert(sizeof(SCookedSection) == 16, "cooked section entry must stay 16 bytes");
+static_assert(sizeof(SCookedModelHeader) % kCookedModelAlignment == 0, "cooked header must keep sections aligned");
+static_assert(sizeof(SCookedSubset) == 16, "cooked subset must stay 16 bytes");
+static_assert(sizeof(SCookedMaterial) == 32, "cooked material must stay 32 bytes");
+static_assert(sizeof(SCookedLod) == 16, "cooked lod must stay 16 bytes");
+static_assert(sizeof(SCookedMeshlet) == 32, "cooked meshlet must stay 32 bytes");
+
+// Interleaves positions, normals and texcoords into the layout the pipeline
+// consumes. Returns packedVertices as-is when the model already has them.
+void packModelVertices(const Model& model, std::vector<float>& outVertices);
+
+// Recomputes model.bounds from its vertex data.
+void computeModelBounds(Model& model);
+
+// Serializes a model into the cooked layout.
+bool writeCookedModel(const Model& model, std::vector<uint8_t>& outBytes);
+
+// Fills a model from a cooked blob. Vertices land in packedVertices; the
+// separate position/normal/texcoord streams stay empty.
+bool readCookedModel(const void* pData, size_t uSize, Model& outModel);
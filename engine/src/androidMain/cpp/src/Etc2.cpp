@@ -0,0 +1,551 @@
+#include "Etc2.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ETC2_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ETC2_SSE2 1
+#endif
+
+namespace {
+
+constexpr int kEtc1Modifiers[8][4] = {
+	{ 2, 8, -2, -8 },
+	{ 5, 17, -5, -17 },
+	{ 9, 29, -9, -29 },
+	{ 13, 42, -13, -42 },
+	{ 18, 60, -18, -60 },
+	{ 24, 80, -24, -80 },
+	{ 33, 106, -33, -106 },
+	{ 47, 183, -47, -183 },
+};
+
+constexpr int kEacModifiers[16][8] = {
+	{ -3, -6, -9, -15, 2, 5, 8, 14 },
+	{ -3, -7, -10, -13, 2, 6, 9, 12 },
+	{ -2, -5, -8, -13, 1, 4, 7, 12 },
+	{ -2, -4, -6, -13, 1, 3, 5, 12 },
+	{ -3, -6, -8, -12, 2, 5, 7, 11 },
+	{ -3, -7, -9, -11, 2, 6, 8, 10 },
+	{ -4, -7, -8, -11, 3, 6, 7, 10 },
+	{ -3, -5, -8, -11, 2, 4, 7, 10 },
+	{ -2, -6, -8, -10, 1, 5, 7, 9 },
+	{ -2, -5, -8, -10, 1, 4, 7, 9 },
+	{ -2, -4, -8, -10, 1, 3, 7, 9 },
+	{ -2, -5, -7, -10, 1, 4, 6, 9 },
+	{ -3, -4, -7, -10, 2, 3, 6, 9 },
+	{ -1, -2, -3, -10, 0, 1, 2, 9 },
+	{ -4, -6, -8, -9, 3, 5, 7, 8 },
+	{ -3, -5, -7, -9, 2, 4, 6, 8 },
+};
+
+constexpr int kThDistances[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+inline int clamp255(int nValue) {
+	return nValue < 0 ? 0 : (nValue > 255 ? 255 : nValue);
+}
+
+inline int expand4(int nValue) { return (nValue << 4) | nValue; }
+inline int expand5(int nValue) { return (nValue << 3) | (nValue >> 2); }
+inline int expand6(int nValue) { return (nValue << 2) | (nValue >> 4); }
+inline int expand7(int nValue) { return (nValue << 1) | (nValue >> 6); }
+
+// Pixels inside a block are numbered column-major (index = x * 4 + y), which
+// is also the order of the index bits.
+struct SBlock {
+	uint8_t aauPixels[16][4];
+};
+
+void loadBlock(const uint8_t* pRgba, uint32_t uWidth, uint32_t uHeight, uint32_t uBlockX, uint32_t uBlockY, SBlock& outBlock) {
+	for (uint32_t x = 0; x < 4; ++x) {
+		for (uint32_t y = 0; y < 4; ++y) {
+			const uint32_t uX = std::min(uBlockX * 4 + x, uWidth - 1);
+			const uint32_t uY = std::min(uBlockY * 4 + y, uHeight - 1);
+			std::memcpy(outBlock.aauPixels[x * 4 + y], pRgba + (static_cast<size_t>(uY) * uWidth + uX) * 4, 4);
+		}
+	}
+}
+
+inline bool inSecondSubblock(int nPixel, bool bFlip) {
+	return bFlip ? (nPixel & 3) >= 2 : nPixel >= 8;
+}
+
+struct SSubblockFit {
+	int nTable = 0;
+	int anIndices[16] = {};
+	int nError = INT_MAX;
+};
+
+// Picks the modifier table and per-pixel modifiers for one half of a block.
+void fitSubblock(const SBlock& sBlock, bool bFlip, bool bSecond, const int anBase[3], SSubblockFit& outFit) {
+	outFit.nError = INT_MAX;
+	for (int nTable = 0; nTable < 8; ++nTable) {
+		int nError = 0;
+		int anIndices[16] = {};
+		for (int p = 0; p < 16 && nError < outFit.nError; ++p) {
+			if (inSecondSubblock(p, bFlip) != bSecond) continue;
+			const uint8_t* pPixel = sBlock.aauPixels[p];
+			int nBest = INT_MAX;
+			for (int m = 0; m < 4; ++m) {
+				const int nModifier = kEtc1Modifiers[nTable][m];
+				const int dR = clamp255(anBase[0] + nModifier) - pPixel[0];
+				const int dG = clamp255(anBase[1] + nModifier) - pPixel[1];
+				const int dB = clamp255(anBase[2] + nModifier) - pPixel[2];
+				const int nPixelError = dR * dR + dG * dG + dB * dB;
+				if (nPixelError < nBest) {
+					nBest = nPixelError;
+					anIndices[p] = m;
+				}
+			}
+			nError += nBest;
+		}
+		if (nError < outFit.nError) {
+			outFit.nError = nError;
+			outFit.nTable = nTable;
+			std::memcpy(outFit.anIndices, anIndices, sizeof(anIndices));
+		}
+	}
+}
+
+// Error of each modifier for the eight pixels of a subblock, up to a per-pixel
+// constant: |base + m - p|^2 = 3m^2 - 2m * d + |base - p|^2 with
+// d = sum(p - base), ignoring clamping. Returns the summed minimum and the
+// chosen modifier per pixel.
+int projectedTableError(const int16_t anDelta[8], const int* pnModifiers, int anIndices[8]) {
+#if defined(ETC2_NEON)
+	const int16x8_t vDelta = vld1q_s16(anDelta);
+	const int32x4_t avDelta2[2] = {
+		vshlq_n_s32(vmovl_s16(vget_low_s16(vDelta)), 1),
+		vshlq_n_s32(vmovl_s16(vget_high_s16(vDelta)), 1),
+	};
+	int32_t anBest[8];
+	int32_t anBestIndex[8];
+	for (int h = 0; h < 2; ++h) {
+		int32x4_t vBest = vdupq_n_s32(INT_MAX);
+		int32x4_t vIndex = vdupq_n_s32(0);
+		for (int m = 0; m < 4; ++m) {
+			const int nModifier = pnModifiers[m];
+			const int32x4_t vCost = vmulq_n_s32(vsubq_s32(vdupq_n_s32(3 * nModifier), avDelta2[h]), nModifier);
+			const uint32x4_t vLess = vcltq_s32(vCost, vBest);
+			vBest = vbslq_s32(vLess, vCost, vBest);
+			vIndex = vbslq_s32(vLess, vdupq_n_s32(m), vIndex);
+		}
+		vst1q_s32(anBest + h * 4, vBest);
+		vst1q_s32(anBestIndex + h * 4, vIndex);
+	}
+#elif defined(ETC2_SSE2)
+	const __m128i vZero = _mm_setzero_si128();
+	const __m128i vDelta2 = _mm_slli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(anDelta)), 1);
+	__m128i avBest[2] = { _mm_set1_epi32(INT_MAX), _mm_set1_epi32(INT_MAX) };
+	__m128i avIndex[2] = { vZero, vZero };
+	for (int m = 0; m < 4; ++m) {
+		const int nModifier = pnModifiers[m];
+		// 3m - 2d fits in 16 bits; madd against (m, 0) pairs widens the product.
+		const __m128i vFactor = _mm_sub_epi16(_mm_set1_epi16(static_cast<int16_t>(3 * nModifier)), vDelta2);
+		const __m128i vModifier = _mm_set1_epi16(static_cast<int16_t>(nModifier));
+		const __m128i avCost[2] = {
+			_mm_madd_epi16(_mm_unpacklo_epi16(vFactor, vZero), vModifier),
+			_mm_madd_epi16(_mm_unpackhi_epi16(vFactor, vZero), vModifier),
+		};
+		for (int h = 0; h < 2; ++h) {
+			const __m128i vLess = _mm_cmplt_epi32(avCost[h], avBest[h]);
+			avBest[h] = _mm_or_si128(_mm_and_si128(vLess, avCost[h]), _mm_andnot_si128(vLess, avBest[h]));
+			avIndex[h] = _mm_or_si128(_mm_and_si128(vLess, _mm_set1_epi32(m)), _mm_andnot_si128(vLess, avIndex[h]));
+		}
+	}
+	int32_t anBest[8];
+	int32_t anBestIndex[8];
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(anBest), avBest[0]);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(anBest + 4), avBest[1]);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(anBestIndex), avIndex[0]);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(anBestIndex + 4), avIndex[1]);
+#else
+	int32_t anBest[8];
+	int32_t anBestIndex[8];
+	for (int p = 0; p < 8; ++p) {
+		anBest[p] = INT_MAX;
+		anBestIndex[p] = 0;
+		for (int m = 0; m < 4; ++m) {
+			const int nCost = pnModifiers[m] * (3 * pnModifiers[m] - 2 * anDelta[p]);
+			if (nCost < anBest[p]) {
+				anBest[p] = nCost;
+				anBestIndex[p] = m;
+			}
+		}
+	}
+#endif
+	int nError = 0;
+	for (int p = 0; p < 8; ++p) {
+		nError += anBest[p];
+		anIndices[p] = anBestIndex[p];
+	}
+	return nError;
+}
+
+// Faster fitSubblock: picks modifiers by projecting onto the grey axis.
+void fitSubblockProjected(const SBlock& sBlock, bool bFlip, bool bSecond, const int anBase[3], SSubblockFit& outFit) {
+	int anPixels[8];
+	int16_t anDelta[8];
+	int nConstant = 0;
+	int nCount = 0;
+	for (int p = 0; p < 16; ++p) {
+		if (inSecondSubblock(p, bFlip) != bSecond) continue;
+		const uint8_t* pPixel = sBlock.aauPixels[p];
+		int nDelta = 0;
+		for (int c = 0; c < 3; ++c) {
+			const int nDifference = pPixel[c] - anBase[c];
+			nDelta += nDifference;
+			nConstant += nDifference * nDifference;
+		}
+		anPixels[nCount] = p;
+		anDelta[nCount] = static_cast<int16_t>(nDelta);
+		++nCount;
+	}
+
+	outFit.nError = INT_MAX;
+	for (int nTable = 0; nTable < 8; ++nTable) {
+		int anIndices[8];
+		const int nError = nConstant + projectedTableError(anDelta, kEtc1Modifiers[nTable], anIndices);
+		if (nError < outFit.nError) {
+			outFit.nError = nError;
+			outFit.nTable = nTable;
+			for (int i = 0; i < 8; ++i) {
+				outFit.anIndices[anPixels[i]] = anIndices[i];
+			}
+		}
+	}
+}
+
+void writeBigEndian(uint64_t uBits, uint8_t* pOut) {
+	for (int i = 0; i < 8; ++i) {
+		pOut[i] = static_cast<uint8_t>(uBits >> (56 - i * 8));
+	}
+}
+
+uint64_t indexBits(const SSubblockFit& sFirst, const SSubblockFit& sSecond, bool bFlip) {
+	uint64_t uBits = 0;
+	for (int p = 0; p < 16; ++p) {
+		const int nIndex = inSecondSubblock(p, bFlip) ? sSecond.anIndices[p] : sFirst.anIndices[p];
+		uBits |= static_cast<uint64_t>(nIndex & 1) << p;
+		uBits |= static_cast<uint64_t>(nIndex >> 1) << (p + 16);
+	}
+	return uBits;
+}
+
+void encodeColorBlock(const SBlock& sBlock, EEtc2Quality eQuality, uint8_t* pOut) {
+	const auto fit = eQuality == EEtc2Quality::High ? fitSubblock : fitSubblockProjected;
+	uint64_t uBestBits = 0;
+	int nBestError = INT_MAX;
+	for (int nFlip = 0; nFlip < 2; ++nFlip) {
+		const bool bFlip = nFlip == 1;
+		int anSum[2][3] = {};
+		for (int p = 0; p < 16; ++p) {
+			const int nSub = inSecondSubblock(p, bFlip) ? 1 : 0;
+			for (int c = 0; c < 3; ++c) {
+				anSum[nSub][c] += sBlock.aauPixels[p][c];
+			}
+		}
+
+		// Differential mode: 5-bit base plus a 3-bit signed delta. The delta is
+		// clamped, so this candidate is always valid and never turns into one of
+		// the ETC2-only modes.
+		int anDiff0[3];
+		int anDiff1[3];
+		int anDelta[3];
+		// Individual mode: two 4-bit colours.
+		int anIndividual0[3];
+		int anIndividual1[3];
+		for (int c = 0; c < 3; ++c) {
+			const int nQ0 = (anSum[0][c] * 31 + 4 * 255) / (8 * 255);
+			const int nQ1 = (anSum[1][c] * 31 + 4 * 255) / (8 * 255);
+			anDelta[c] = std::clamp(nQ1 - nQ0, -4, 3);
+			anDiff0[c] = nQ0;
+			anDiff1[c] = nQ0 + anDelta[c];
+			anIndividual0[c] = (anSum[0][c] * 15 + 4 * 255) / (8 * 255);
+			anIndividual1[c] = (anSum[1][c] * 15 + 4 * 255) / (8 * 255);
+		}
+
+		const bool bDeltaClamped = anDiff1[0] != (anSum[1][0] * 31 + 4 * 255) / (8 * 255) ||
+			anDiff1[1] != (anSum[1][1] * 31 + 4 * 255) / (8 * 255) ||
+			anDiff1[2] != (anSum[1][2] * 31 + 4 * 255) / (8 * 255);
+		for (int nDiff = 1; nDiff >= 0; --nDiff) {
+			// Fast mode only tries individual colours when the delta did not fit.
+			if (!nDiff && eQuality == EEtc2Quality::Fast && !bDeltaClamped) continue;
+			int anBase0[3];
+			int anBase1[3];
+			for (int c = 0; c < 3; ++c) {
+				anBase0[c] = nDiff ? expand5(anDiff0[c]) : expand4(anIndividual0[c]);
+				anBase1[c] = nDiff ? expand5(anDiff1[c]) : expand4(anIndividual1[c]);
+			}
+			SSubblockFit sFirst;
+			SSubblockFit sSecond;
+			fit(sBlock, bFlip, false, anBase0, sFirst);
+			fit(sBlock, bFlip, true, anBase1, sSecond);
+			const int nError = sFirst.nError + sSecond.nError;
+			if (nError >= nBestError) continue;
+			nBestError = nError;
+
+			uint64_t uBits = 0;
+			if (nDiff) {
+				uBits |= static_cast<uint64_t>(anDiff0[0]) << 59 | static_cast<uint64_t>(anDelta[0] & 7) << 56;
+				uBits |= static_cast<uint64_t>(anDiff0[1]) << 51 | static_cast<uint64_t>(anDelta[1] & 7) << 48;
+				uBits |= static_cast<uint64_t>(anDiff0[2]) << 43 | static_cast<uint64_t>(anDelta[2] & 7) << 40;
+			} else {
+				uBits |= static_cast<uint64_t>(anIndividual0[0]) << 60 | static_cast<uint64_t>(anIndividual1[0]) << 56;
+				uBits |= static_cast<uint64_t>(anIndividual0[1]) << 52 | static_cast<uint64_t>(anIndividual1[1]) << 48;
+				uBits |= static_cast<uint64_t>(anIndividual0[2]) << 44 | static_cast<uint64_t>(anIndividual1[2]) << 40;
+			}
+			uBits |= static_cast<uint64_t>(sFirst.nTable) << 37 | static_cast<uint64_t>(sSecond.nTable) << 34;
+			uBits |= static_cast<uint64_t>(nDiff) << 33 | static_cast<uint64_t>(nFlip) << 32;
+			uBits |= indexBits(sFirst, sSecond, bFlip);
+			uBestBits = uBits;
+		}
+	}
+	writeBigEndian(uBestBits, pOut);
+}
+
+void encodeAlphaBlock(const SBlock& sBlock, uint8_t* pOut) {
+	int nMin = 255;
+	int nMax = 0;
+	for (const uint8_t* pPixel : sBlock.aauPixels) {
+		nMin = std::min<int>(nMin, pPixel[3]);
+		nMax = std::max<int>(nMax, pPixel[3]);
+	}
+	if (nMin == nMax) {
+		// Table 13 has a zero modifier (index 4) at every pixel.
+		constexpr uint64_t kZeroModifierIndices = 0x924924924924ull;
+		writeBigEndian(static_cast<uint64_t>(nMin) << 56 | uint64_t(1) << 52 | uint64_t(13) << 48 | kZeroModifierIndices, pOut);
+		return;
+	}
+
+	uint64_t uBestBits = 0;
+	int nBestError = INT_MAX;
+	for (int nTable = 0; nTable < 16 && nBestError > 0; ++nTable) {
+		const int* pnModifiers = kEacModifiers[nTable];
+		const int nSpan = pnModifiers[7] - pnModifiers[3];
+		const int nMultiplier = std::clamp((nMax - nMin + nSpan / 2) / nSpan, 1, 15);
+		const int nBase = clamp255(nMin - pnModifiers[3] * nMultiplier);
+
+		int nError = 0;
+		uint64_t uIndices = 0;
+		for (int p = 0; p < 16; ++p) {
+			const int nAlpha = sBlock.aauPixels[p][3];
+			int nBest = INT_MAX;
+			int nBestIndex = 0;
+			for (int i = 0; i < 8; ++i) {
+				const int nDelta = clamp255(nBase + pnModifiers[i] * nMultiplier) - nAlpha;
+				if (nDelta * nDelta < nBest) {
+					nBest = nDelta * nDelta;
+					nBestIndex = i;
+				}
+			}
+			nError += nBest;
+			uIndices |= static_cast<uint64_t>(nBestIndex) << (45 - p * 3);
+		}
+		if (nError < nBestError) {
+			nBestError = nError;
+			uBestBits = static_cast<uint64_t>(nBase) << 56 | static_cast<uint64_t>(nMultiplier) << 52 |
+				static_cast<uint64_t>(nTable) << 48 | uIndices;
+		}
+	}
+	writeBigEndian(uBestBits, pOut);
+}
+
+void decodeColorBlock(const uint8_t* pSrc, uint8_t aauOut[16][4]) {
+	const bool bDiff = (pSrc[3] & 2) != 0;
+	const bool bFlip = (pSrc[3] & 1) != 0;
+	const uint32_t uIndexBits = static_cast<uint32_t>(pSrc[4]) << 24 | static_cast<uint32_t>(pSrc[5]) << 16 |
+		static_cast<uint32_t>(pSrc[6]) << 8 | pSrc[7];
+	auto pixelIndex = [uIndexBits](int p) {
+		return static_cast<int>(((uIndexBits >> (p + 16)) & 1) << 1 | ((uIndexBits >> p) & 1));
+	};
+
+	int anColor0[3];
+	int anColor1[3];
+	if (bDiff) {
+		const int nR = pSrc[0] >> 3;
+		const int nG = pSrc[1] >> 3;
+		const int nB = pSrc[2] >> 3;
+		const int nR2 = nR + (static_cast<int8_t>(pSrc[0] << 5) >> 5);
+		const int nG2 = nG + (static_cast<int8_t>(pSrc[1] << 5) >> 5);
+		const int nB2 = nB + (static_cast<int8_t>(pSrc[2] << 5) >> 5);
+
+		if (nR2 < 0 || nR2 > 31 || nG2 < 0 || nG2 > 31) {
+			int anPaint[4][3];
+			if (nR2 < 0 || nR2 > 31) {
+				// T mode.
+				const int anC1[3] = {
+					expand4(((pSrc[0] & 0x18) >> 1) | (pSrc[0] & 0x3)),
+					expand4(pSrc[1] >> 4),
+					expand4(pSrc[1] & 0xF),
+				};
+				const int anC2[3] = { expand4(pSrc[2] >> 4), expand4(pSrc[2] & 0xF), expand4(pSrc[3] >> 4) };
+				const int nDistance = kThDistances[((pSrc[3] >> 1) & 0x6) | (pSrc[3] & 0x1)];
+				for (int c = 0; c < 3; ++c) {
+					anPaint[0][c] = anC1[c];
+					anPaint[1][c] = clamp255(anC2[c] + nDistance);
+					anPaint[2][c] = anC2[c];
+					anPaint[3][c] = clamp255(anC2[c] - nDistance);
+				}
+			} else {
+				// H mode.
+				const int anQ1[3] = {
+					(pSrc[0] >> 3) & 0xF,
+					((pSrc[0] << 1) & 0xE) | ((pSrc[1] >> 4) & 0x1),
+					(pSrc[1] & 0x8) | ((pSrc[1] << 1) & 0x6) | (pSrc[2] >> 7),
+				};
+				const int anQ2[3] = {
+					(pSrc[2] >> 3) & 0xF,
+					((pSrc[2] << 1) & 0xE) | (pSrc[3] >> 7),
+					(pSrc[3] >> 3) & 0xF,
+				};
+				const int nOrder1 = anQ1[0] << 8 | anQ1[1] << 4 | anQ1[2];
+				const int nOrder2 = anQ2[0] << 8 | anQ2[1] << 4 | anQ2[2];
+				const int nDistance = kThDistances[(pSrc[3] & 0x4) | ((pSrc[3] << 1) & 0x2) | (nOrder1 >= nOrder2 ? 1 : 0)];
+				for (int c = 0; c < 3; ++c) {
+					anPaint[0][c] = clamp255(expand4(anQ1[c]) + nDistance);
+					anPaint[1][c] = clamp255(expand4(anQ1[c]) - nDistance);
+					anPaint[2][c] = clamp255(expand4(anQ2[c]) + nDistance);
+					anPaint[3][c] = clamp255(expand4(anQ2[c]) - nDistance);
+				}
+			}
+			for (int p = 0; p < 16; ++p) {
+				const int* pnPaint = anPaint[pixelIndex(p)];
+				aauOut[p][0] = static_cast<uint8_t>(pnPaint[0]);
+				aauOut[p][1] = static_cast<uint8_t>(pnPaint[1]);
+				aauOut[p][2] = static_cast<uint8_t>(pnPaint[2]);
+			}
+			return;
+		}
+
+		if (nB2 < 0 || nB2 > 31) {
+			// Planar mode: origin, horizontal and vertical colours are blended.
+			const int anO[3] = {
+				expand6((pSrc[0] >> 1) & 0x3F),
+				expand7(((pSrc[0] & 0x1) << 6) | ((pSrc[1] >> 1) & 0x3F)),
+				expand6(((pSrc[1] & 0x1) << 5) | (pSrc[2] & 0x18) | ((pSrc[2] & 0x3) << 1) | ((pSrc[3] >> 7) & 0x1)),
+			};
+			const int anH[3] = {
+				expand6(((pSrc[3] >> 1) & 0x3E) | (pSrc[3] & 0x1)),
+				expand7((pSrc[4] >> 1) & 0x7F),
+				expand6(((pSrc[4] & 0x1) << 5) | ((pSrc[5] >> 3) & 0x1F)),
+			};
+			const int anV[3] = {
+				expand6(((pSrc[5] & 0x7) << 3) | ((pSrc[6] >> 5) & 0x7)),
+				expand7(((pSrc[6] & 0x1F) << 2) | ((pSrc[7] >> 6) & 0x3)),
+				expand6(pSrc[7] & 0x3F),
+			};
+			for (int x = 0; x < 4; ++x) {
+				for (int y = 0; y < 4; ++y) {
+					for (int c = 0; c < 3; ++c) {
+						aauOut[x * 4 + y][c] = static_cast<uint8_t>(clamp255((x * (anH[c] - anO[c]) + y * (anV[c] - anO[c]) + 4 * anO[c] + 2) >> 2));
+					}
+				}
+			}
+			return;
+		}
+
+		anColor0[0] = expand5(nR);
+		anColor0[1] = expand5(nG);
+		anColor0[2] = expand5(nB);
+		anColor1[0] = expand5(nR2);
+		anColor1[1] = expand5(nG2);
+		anColor1[2] = expand5(nB2);
+	} else {
+		anColor0[0] = expand4(pSrc[0] >> 4);
+		anColor0[1] = expand4(pSrc[1] >> 4);
+		anColor0[2] = expand4(pSrc[2] >> 4);
+		anColor1[0] = expand4(pSrc[0] & 0xF);
+		anColor1[1] = expand4(pSrc[1] & 0xF);
+		anColor1[2] = expand4(pSrc[2] & 0xF);
+	}
+
+	const int nTable0 = pSrc[3] >> 5;
+	const int nTable1 = (pSrc[3] >> 2) & 7;
+	for (int p = 0; p < 16; ++p) {
+		const bool bSecond = inSecondSubblock(p, bFlip);
+		const int* pnColor = bSecond ? anColor1 : anColor0;
+		const int nModifier = kEtc1Modifiers[bSecond ? nTable1 : nTable0][pixelIndex(p)];
+		for (int c = 0; c < 3; ++c) {
+			aauOut[p][c] = static_cast<uint8_t>(clamp255(pnColor[c] + nModifier));
+		}
+	}
+}
+
+void decodeAlphaBlock(const uint8_t* pSrc, uint8_t aauOut[16][4]) {
+	const int nBase = pSrc[0];
+	const int nMultiplier = pSrc[1] >> 4;
+	const int* pnModifiers = kEacModifiers[pSrc[1] & 0xF];
+	uint64_t uIndices = 0;
+	for (int i = 2; i < 8; ++i) {
+		uIndices = uIndices << 8 | pSrc[i];
+	}
+	for (int p = 0; p < 16; ++p) {
+		const int nIndex = static_cast<int>((uIndices >> (45 - p * 3)) & 7);
+		aauOut[p][3] = static_cast<uint8_t>(clamp255(nBase + pnModifiers[nIndex] * nMultiplier));
+	}
+}
+
+} // namespace
+
+size_t etc2ImageSize(uint32_t uWidth, uint32_t uHeight, bool bAlpha) {
+	const size_t uBlocks = static_cast<size_t>((uWidth + 3) / 4) * ((uHeight + 3) / 4);
+	return uBlocks * (bAlpha ? kEtc2RgbaBlockBytes : kEtc2RgbBlockBytes);
+}
+
+void encodeEtc2(const uint8_t* pRgba, uint32_t uWidth, uint32_t uHeight, bool bAlpha, std::vector<uint8_t>& outBlocks, EEtc2Quality eQuality) {
+	outBlocks.resize(etc2ImageSize(uWidth, uHeight, bAlpha));
+	encodeEtc2(pRgba, uWidth, uHeight, bAlpha, outBlocks.data(), eQuality);
+}
+
+void encodeEtc2(const uint8_t* pRgba, uint32_t uWidth, uint32_t uHeight, bool bAlpha, uint8_t* pOut, EEtc2Quality eQuality) {
+	const uint32_t uBlocksX = (uWidth + 3) / 4;
+	const uint32_t uBlocksY = (uHeight + 3) / 4;
+	SBlock sBlock;
+	for (uint32_t uBlockY = 0; uBlockY < uBlocksY; ++uBlockY) {
+		for (uint32_t uBlockX = 0; uBlockX < uBlocksX; ++uBlockX) {
+			loadBlock(pRgba, uWidth, uHeight, uBlockX, uBlockY, sBlock);
+			if (bAlpha) {
+				encodeAlphaBlock(sBlock, pOut);
+				pOut += 8;
+			}
+			encodeColorBlock(sBlock, eQuality, pOut);
+			pOut += 8;
+		}
+	}
+}
+
+bool decodeEtc2(const uint8_t* pBlocks, size_t uSize, uint32_t uWidth, uint32_t uHeight, bool bAlpha, std::vector<uint8_t>& outRgba) {
+	if (uWidth == 0 || uHeight == 0 || uSize < etc2ImageSize(uWidth, uHeight, bAlpha)) return false;
+	outRgba.resize(static_cast<size_t>(uWidth) * uHeight * 4);
+	const uint32_t uBlocksX = (uWidth + 3) / 4;
+	const uint32_t uBlocksY = (uHeight + 3) / 4;
+	const uint8_t* pSrc = pBlocks;
+	uint8_t aauPixels[16][4];
+	for (uint32_t uBlockY = 0; uBlockY < uBlocksY; ++uBlockY) {
+		for (uint32_t uBlockX = 0; uBlockX < uBlocksX; ++uBlockX) {
+			if (bAlpha) {
+				decodeAlphaBlock(pSrc, aauPixels);
+				pSrc += 8;
+			} else {
+				for (auto& auPixel : aauPixels) auPixel[3] = 255;
+			}
+			decodeColorBlock(pSrc, aauPixels);
+			pSrc += 8;
+			for (uint32_t x = 0; x < 4; ++x) {
+				for (uint32_t y = 0; y < 4; ++y) {
+					const uint32_t uX = uBlockX * 4 + x;
+					const uint32_t uY = uBlockY * 4 + y;
+					if (uX >= uWidth || uY >= uHeight) continue;
+					std::memcpy(outRgba.data() + (static_cast<size_t>(uY) * uWidth + uX) * 4, aauPixels[x * 4 + y], 4);
+				}
+			}
+		}
+	}
+	return true;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ETC2 block compression (Khronos Data Format Specification, "ETC2").
+// The encoder emits ETC1-style individual/differential colour blocks, which are
+// valid ETC2, plus EAC alpha. The decoder handles every ETC2 mode so cooked
+// payloads can still be expanded on devices without ETC2 sampling.
+
+constexpr size_t kEtc2RgbBlockBytes = 8;
+constexpr size_t kEtc2RgbaBlockBytes = 16;
+
+// Fast and Normal pick modifiers with a SIMD (NEON/SSE2) projection onto the
+// grey axis; Fast also skips most individual-mode candidates. High evaluates
+// every modifier exactly, with clamping, and is several times slower.
+enum class EEtc2Quality {
+	Fast,
+	Normal,
+	High,
+};
+
+size_t etc2ImageSize(uint32_t uWidth, uint32_t uHeight, bool bAlpha);
+
+// Encodes an RGBA8 image. Edge blocks repeat the last row/column.
+void encodeEtc2(const uint8_t* pRgba, uint32_t uWidth, uint32_t uHeight, bool bAlpha, std::vector<uint8_t>& outBlocks,
+	EEtc2Quality eQuality = EEtc2Quality::Normal);
+
+// Same, writing etc2ImageSize() bytes to pOutBlocks.
+void encodeEtc2(const uint8_t* pRgba, uint32_t uWidth, uint32_t uHeight, bool bAlpha, uint8_t* pOutBlocks,
+	EEtc2Quality eQuality = EEtc2Quality::Normal);
+
+// Expands blocks to RGBA8. Alpha is 255 for RGB payloads.
+bool decodeEtc2(const uint8_t* pBlocks, size_t uSize, uint32_t uWidth, uint32_t uHeight, bool bAlpha, std::vector<uint8_t>& outRgba);
@@ -0,0 +1,124 @@
+#include "Hash.h"
+
+#include <cstring>
+
+namespace {
+
+constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t kPrime3 = 0x165667B19E3779F9ull;
+constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ull;
+constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ull;
+
+inline uint64_t rotl(uint64_t uValue, int nBits) {
+	return (uValue << nBits) | (uValue >> (64 - nBits));
+}
+
+inline uint64_t read64(const uint8_t* pBytes) {
+	uint64_t uValue;
+	std::memcpy(&uValue, pBytes, sizeof(uValue));
+	return uValue;
+}
+
+inline uint32_t read32(const uint8_t* pBytes) {
+	uint32_t uValue;
+	std::memcpy(&uValue, pBytes, sizeof(uValue));
+	return uValue;
+}
+
+inline uint64_t round(uint64_t uAccumulator, uint64_t uInput) {
+	uAccumulator += uInput * kPrime2;
+	uAccumulator = rotl(uAccumulator, 31);
+	return uAccumulator * kPrime1;
+}
+
+inline uint64_t mergeRound(uint64_t uAccumulator, uint64_t uValue) {
+	uAccumulator ^= round(0, uValue);
+	return uAccumulator * kPrime1 + kPrime4;
+}
+
+} // namespace
+
+Hash64::Hash64(uint64_t uSeed) : uSeedValue(uSeed) {
+	auAccumulators[0] = uSeed + kPrime1 + kPrime2;
+	auAccumulators[1] = uSeed + kPrime2;
+	auAccumulators[2] = uSeed;
+	auAccumulators[3] = uSeed - kPrime1;
+}
+
+void Hash64::update(const void* pData, size_t uSize) {
+	const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+	uTotalLength += uSize;
+
+	if (uBuffered + uSize < sizeof(auBuffer)) {
+		std::memcpy(auBuffer + uBuffered, pBytes, uSize);
+		uBuffered += uSize;
+		return;
+	}
+	if (uBuffered > 0) {
+		const size_t uFill = sizeof(auBuffer) - uBuffered;
+		std::memcpy(auBuffer + uBuffered, pBytes, uFill);
+		for (int i = 0; i < 4; ++i) {
+			auAccumulators[i] = round(auAccumulators[i], read64(auBuffer + i * 8));
+		}
+		pBytes += uFill;
+		uSize -= uFill;
+		uBuffered = 0;
+	}
+	while (uSize >= sizeof(auBuffer)) {
+		for (int i = 0; i < 4; ++i) {
+			auAccumulators[i] = round(auAccumulators[i], read64(pBytes + i * 8));
+		}
+		pBytes += sizeof(auBuffer);
+		uSize -= sizeof(auBuffer);
+	}
+	std::memcpy(auBuffer, pBytes, uSize);
+	uBuffered = uSize;
+}
+
+uint64_t Hash64::digest() const {
+	uint64_t uHash;
+	if (uTotalLength >= sizeof(auBuffer)) {
+		uHash = rotl(auAccumulators[0], 1) + rotl(auAccumulators[1], 7) + rotl(auAccumulators[2], 12) + rotl(auAccumulators[3], 18);
+		for (int i = 0; i < 4; ++i) {
+			uHash = mergeRound(uHash, auAccumulators[i]);
+		}
+	} else {
+		uHash = uSeedValue + kPrime5;
+	}
+	uHash += uTotalLength;
+
+	const uint8_t* pBytes = auBuffer;
+	size_t uRemaining = uBuffered;
+	while (uRemaining >= 8) {
+		uHash ^= round(0, read64(pBytes));
+		uHash = rotl(uHash, 27) * kPrime1 + kPrime4;
+		pBytes += 8;
+		uRemaining -= 8;
+	}
+	if (uRemaining >= 4) {
+		uHash ^= static_cast<uint64_t>(read32(pBytes)) * kPrime1;
+		uHash = rotl(uHash, 23) * kPrime2 + kPrime3;
+		pBytes += 4;
+		uRemaining -= 4;
+	}
+	while (uRemaining > 0) {
+		uHash ^= (*pBytes) * kPrime5;
+		uHash = rotl(uHash, 11) * kPrime1;
+		++pBytes;
+		--uRemaining;
+	}
+
+	uHash ^= uHash >> 33;
+	uHash *= kPrime2;
+	uHash ^= uHash >> 29;
+	uHash *= kPrime3;
+	uHash ^= uHash >> 32;
+	return uHash;
+}
+
+uint64_t hash64(const void* pData, size_t uSize, uint64_t uSeed) {
+	Hash64 hasher(uSeed);
+	hasher.update(pData, uSize);
+	return hasher.digest();
+}
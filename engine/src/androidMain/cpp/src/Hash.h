@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Streaming XXH64 (https://github.com/Cyan4973/xxHash), used to key cached
+// assets by content.
+class Hash64 {
+public:
+	explicit Hash64(uint64_t uSeed = 0);
+
+	void update(const void* pData, size_t uSize);
+	void updateU64(uint64_t uValue) { update(&uValue, sizeof(uValue)); }
+	uint64_t digest() const;
+
+private:
+	uint64_t auAccumulators[4];
+	uint8_t auBuffer[32];
+	size_t uBuffered = 0;
+	uint64_t uTotalLength = 0;
+	uint64_t uSeedValue = 0;
+};
+
+uint64_t hash64(const void* pData, size_t uSize, uint64_t uSeed = 0);
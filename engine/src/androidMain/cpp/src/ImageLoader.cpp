@@ -1,18 +1,22 @@
 #include "ImageLoader.h"
+#include "Etc2.h"
+#include "Ktx2.h"
 
-#include <android/log.h>
-#include <jni.h>
-
+#include <algorithm>
+#include <cstdio>
 #include <cstring>
 #include <string>
 #include <vector>
 
 #define LOG_TAG "ImageLoader"
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#include "Log.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
+#ifdef __ANDROID__
+#include <jni.h>
+
 extern JavaVM* g_javaVm;
 extern jclass g_engineApiClass;
 extern jmethodID g_loadFileMethod;
@@ -101,6 +105,222 @@ bool loadFileWithJava(const std::string& strPath, std::vector<unsigned char>& ve
 
 } // namespace
 
+static bool loadFileBytes(const std::string& strPath, std::vector<unsigned char>& vecBytes) {
+	return loadFileWithJava(strPath, vecBytes);
+}
+
+#else
+
+static bool loadFileBytes(const std::string& strPath, std::vector<unsigned char>& vecBytes) {
+	FILE* pFile = std::fopen(strPath.c_str(), "rb");
+	if (!pFile) return false;
+	std::fseek(pFile, 0, SEEK_END);
+	const long length = std::ftell(pFile);
+	std::fseek(pFile, 0, SEEK_SET);
+	if (length > 0) {
+		vecBytes.resize(static_cast<size_t>(length));
+		vecBytes.resize(std::fread(vecBytes.data(), 1, vecBytes.size(), pFile));
+	}
+	std::fclose(pFile);
+	return !vecBytes.empty();
+}
+
+#endif
+
+static bool decodeKtx2Rgba(const unsigned char* pData,
+	size_t uSize,
+	int nDesiredChannels,
+	std::vector<unsigned char>& outPixels,
+	int& nWidth,
+	int& nHeight) {
+	SKtx2Image sImage;
+	if (!parseKtx2(pData, uSize, sImage)) {
+		return false;
+	}
+	if (nDesiredChannels != 0 && nDesiredChannels != 4) {
+		LOGE("KTX2 textures only decode to 4 channels (requested %d)", nDesiredChannels);
+		return false;
+	}
+	const SKtx2Level& sBase = sImage.vecLevels.front();
+	if (sImage.uVkFormat == kKtx2FormatEtc2R8G8B8Unorm || sImage.uVkFormat == kKtx2FormatEtc2R8G8B8A8Unorm) {
+		const bool bAlpha = sImage.uVkFormat == kKtx2FormatEtc2R8G8B8A8Unorm;
+		if (!decodeEtc2(sBase.pData, sBase.uSize, sBase.uWidth, sBase.uHeight, bAlpha, outPixels)) {
+			LOGE("Failed to expand ETC2 level 0");
+			return false;
+		}
+	} else if (sImage.uVkFormat == kKtx2FormatR8G8B8A8Unorm || sImage.uVkFormat == kKtx2FormatR8G8B8A8Srgb) {
+		outPixels.assign(sBase.pData, sBase.pData + static_cast<size_t>(sBase.uWidth) * sBase.uHeight * 4);
+	} else {
+		LOGE("KTX2 format %u cannot be expanded to pixels", sImage.uVkFormat);
+		return false;
+	}
+	nWidth = static_cast<int>(sBase.uWidth);
+	nHeight = static_cast<int>(sBase.uHeight);
+	return true;
+}
+
+// Number of halvings that bring the larger side within uMaxDimension (0 means
+// no limit).
+static uint32_t scaleShiftFor(uint32_t uWidth, uint32_t uHeight, uint32_t uMaxDimension) {
+	uint32_t uShift = 0;
+	while (uMaxDimension != 0 && (std::max(uWidth, uHeight) >> uShift) > uMaxDimension) {
+		++uShift;
+	}
+	return uShift;
+}
+
+// Copies the levels of a container into one buffer laid out for a single
+// buffer-to-image copy, skipping leading levels larger than uMaxDimension.
+static void copyKtx2Levels(const SKtx2Image& sImage, STextureData& outTexture, const TextureAllocator& allocator, uint32_t uMaxDimension) {
+	size_t uFirst = 0;
+	while (uFirst + 1 < sImage.vecLevels.size() &&
+		scaleShiftFor(sImage.vecLevels[uFirst].uWidth, sImage.vecLevels[uFirst].uHeight, uMaxDimension) > 0) {
+		++uFirst;
+	}
+	outTexture.uVkFormat = sImage.uVkFormat == kKtx2FormatR8G8B8A8Srgb ? kKtx2FormatR8G8B8A8Unorm : sImage.uVkFormat;
+	outTexture.vecLevels.resize(sImage.vecLevels.size() - uFirst);
+	size_t uOffset = 0;
+	for (size_t i = 0; i < outTexture.vecLevels.size(); ++i) {
+		const SKtx2Level& sSource = sImage.vecLevels[uFirst + i];
+		SMipLevel& sLevel = outTexture.vecLevels[i];
+		sLevel.uWidth = sSource.uWidth;
+		sLevel.uHeight = sSource.uHeight;
+		sLevel.uOffset = uOffset;
+		sLevel.uSize = sSource.uSize;
+		// Block offsets must be multiples of the block size (8 or 16 bytes).
+		uOffset += (sLevel.uSize + 15) & ~size_t(15);
+	}
+	unsigned char* pBytes = outTexture.allocateBytes(uOffset, allocator);
+	for (size_t i = 0; i < outTexture.vecLevels.size(); ++i) {
+		std::memcpy(pBytes + outTexture.vecLevels[i].uOffset, sImage.vecLevels[uFirst + i].pData, sImage.vecLevels[uFirst + i].uSize);
+	}
+}
+
+// Expands 1-4 channel pixels to RGBA8; this is the only pass over the decoded
+// image before upload, so it writes straight to the destination.
+static void expandToRgba8(const unsigned char* pSource, size_t uPixelCount, int nChannels, unsigned char* pDestination) {
+	switch (nChannels) {
+	case 1:
+		for (size_t i = 0; i < uPixelCount; ++i, pDestination += 4) {
+			pDestination[0] = pDestination[1] = pDestination[2] = pSource[i];
+			pDestination[3] = 255;
+		}
+		break;
+	case 2:
+		for (size_t i = 0; i < uPixelCount; ++i, pSource += 2, pDestination += 4) {
+			pDestination[0] = pDestination[1] = pDestination[2] = pSource[0];
+			pDestination[3] = pSource[1];
+		}
+		break;
+	case 3:
+		for (size_t i = 0; i < uPixelCount; ++i, pSource += 3, pDestination += 4) {
+			pDestination[0] = pSource[0];
+			pDestination[1] = pSource[1];
+			pDestination[2] = pSource[2];
+			pDestination[3] = 255;
+		}
+		break;
+	default:
+		std::memcpy(pDestination, pSource, uPixelCount * 4);
+		break;
+	}
+}
+
+// Images larger than uMaxDimension are shrunk by a power of two in the same
+// pass that expands them to RGBA8, so the full-size RGBA8 image never exists.
+static bool decodeRgba8Into(const unsigned char* pData,
+	size_t uSize,
+	STextureData& outTexture,
+	const TextureAllocator& allocator,
+	const std::string& strDebugName,
+	uint32_t uMaxDimension) {
+	int nWidth = 0;
+	int nHeight = 0;
+	auto writeScaled = [&](const unsigned char* pPixels, int nChannels) {
+		const uint32_t uShift = scaleShiftFor(static_cast<uint32_t>(nWidth), static_cast<uint32_t>(nHeight), uMaxDimension);
+		const uint32_t uWidth = std::max(static_cast<uint32_t>(nWidth) >> uShift, 1u);
+		const uint32_t uHeight = std::max(static_cast<uint32_t>(nHeight) >> uShift, 1u);
+		const size_t uPixelCount = static_cast<size_t>(uWidth) * uHeight;
+		unsigned char* pDestination = outTexture.allocateBytes(uPixelCount * 4, allocator);
+		if (uShift == 0) {
+			expandToRgba8(pPixels, uPixelCount, nChannels, pDestination);
+		} else {
+			LOGI("Decoding %s at 1/%u scale: %dx%d -> %ux%u", strDebugName.c_str(), 1u << uShift, nWidth, nHeight, uWidth, uHeight);
+			downscaleToRgba8(pPixels, static_cast<uint32_t>(nWidth), static_cast<uint32_t>(nHeight), static_cast<uint32_t>(nChannels), uShift, pDestination);
+		}
+		SMipLevel sLevel;
+		sLevel.uWidth = uWidth;
+		sLevel.uHeight = uHeight;
+		sLevel.uSize = uPixelCount * 4;
+		outTexture.vecLevels.push_back(sLevel);
+	};
+
+	if (isKtx2(pData, uSize)) {
+		std::vector<unsigned char> vecPixels;
+		if (!decodeKtx2Rgba(pData, uSize, 4, vecPixels, nWidth, nHeight)) {
+			return false;
+		}
+		writeScaled(vecPixels.data(), 4);
+	} else {
+		int nChannels = 0;
+		unsigned char* pDecoded = stbi_load_from_memory(pData, static_cast<int>(uSize), &nWidth, &nHeight, &nChannels, 0);
+		if (!pDecoded) {
+			const char* pcReason = stbi_failure_reason();
+			LOGE("stbi_load_from_memory failed for %s (%s)", strDebugName.c_str(), pcReason ? pcReason : "unknown");
+			return false;
+		}
+		if (nWidth <= 0 || nHeight <= 0 || nChannels < 1 || nChannels > 4) {
+			stbi_image_free(pDecoded);
+			return false;
+		}
+		writeScaled(pDecoded, nChannels);
+		stbi_image_free(pDecoded);
+	}
+	return true;
+}
+
+unsigned char* STextureData::allocateBytes(size_t uSize, const TextureAllocator& allocator) {
+	pStaging = allocator ? allocator(uSize) : nullptr;
+	if (pStaging) {
+		std::vector<unsigned char>().swap(vecBytes);
+		return pStaging->data();
+	}
+	vecBytes.resize(uSize);
+	return vecBytes.data();
+}
+
+AssetData LoadImageFileData(const AssetSource& assetSource, const std::string& strPath) {
+	AssetData data = assetSource.open(strPath);
+	if (data && !data.empty()) {
+		return data;
+	}
+#ifdef __ANDROID__
+	std::vector<unsigned char> vecBytes;
+	if (loadFileBytes(strPath, vecBytes) && !vecBytes.empty()) {
+		return AssetData::fromBuffer(std::move(vecBytes));
+	}
+#endif
+	LOGE("Failed to load file bytes for %s", strPath.c_str());
+	return {};
+}
+
+bool LoadImageFromAsset(const AssetSource& assetSource,
+	const std::string& strPath,
+	int nDesiredChannels,
+	std::vector<unsigned char>& outPixels,
+	int& nWidth,
+	int& nHeight) {
+	outPixels.clear();
+	nWidth = 0;
+	nHeight = 0;
+
+	const AssetData data = LoadImageFileData(assetSource, strPath);
+	if (!data) {
+		return false;
+	}
+	return DecodeImageFromMemory(data.data(), data.size(), nDesiredChannels, outPixels, nWidth, nHeight, strPath);
+}
+
 bool LoadImageFromFile(const std::string& strPath,
 	int nDesiredChannels,
 	std::vector<unsigned char>& outPixels,
@@ -111,7 +331,7 @@ bool LoadImageFromFile(const std::string& strPath,
 	nHeight = 0;
 
 	std::vector<unsigned char> vecEncoded;
-	if (!loadFileWithJava(strPath, vecEncoded)) {
+	if (!loadFileBytes(strPath, vecEncoded)) {
 		LOGE("Failed to load file bytes for %s", strPath.c_str());
 		return false;
 	}
@@ -120,17 +340,35 @@ bool LoadImageFromFile(const std::string& strPath,
 		return false;
 	}
 
+	return DecodeImageFromMemory(vecEncoded.data(), vecEncoded.size(), nDesiredChannels, outPixels, nWidth, nHeight, strPath);
+}
+
+bool DecodeImageFromMemory(const unsigned char* pData,
+	size_t uSize,
+	int nDesiredChannels,
+	std::vector<unsigned char>& outPixels,
+	int& nWidth,
+	int& nHeight,
+	const std::string& strDebugName) {
+	outPixels.clear();
+	nWidth = 0;
+	nHeight = 0;
+
+	if (isKtx2(pData, uSize)) {
+		return decodeKtx2Rgba(pData, uSize, nDesiredChannels, outPixels, nWidth, nHeight);
+	}
+
 	int nChannelsInFile = 0;
 	unsigned char* pDecoded = stbi_load_from_memory(
-		vecEncoded.data(),
-		static_cast<int>(vecEncoded.size()),
+		pData,
+		static_cast<int>(uSize),
 		&nWidth,
 		&nHeight,
 		&nChannelsInFile,
 		nDesiredChannels);
 	if (!pDecoded) {
 		const char* pcReason = stbi_failure_reason();
-		LOGE("stbi_load_from_memory failed for %s (%s)", strPath.c_str(), pcReason ? pcReason : "unknown");
+		LOGE("stbi_load_from_memory failed for %s (%s)", strDebugName.c_str(), pcReason ? pcReason : "unknown");
 		return false;
 	}
 
@@ -148,3 +386,105 @@ bool LoadImageFromFile(const std::string& strPath,
 
 	return !outPixels.empty();
 }
+
+bool PrepareTextureFromMemory(const unsigned char* pData,
+	size_t uSize,
+	const std::vector<uint32_t>& vecSupportedFormats,
+	STextureData& outTexture,
+	const std::string& strDebugName,
+	const TextureAllocator& allocator,
+	uint32_t uMaxDimension) {
+	outTexture = STextureData();
+
+	if (isKtx2(pData, uSize)) {
+		SKtx2Image sImage;
+		if (!parseKtx2(pData, uSize, sImage)) {
+			return false;
+		}
+		const bool bRgba8 = sImage.uVkFormat == kKtx2FormatR8G8B8A8Unorm || sImage.uVkFormat == kKtx2FormatR8G8B8A8Srgb;
+		if (bRgba8 || std::find(vecSupportedFormats.begin(), vecSupportedFormats.end(), sImage.uVkFormat) != vecSupportedFormats.end()) {
+			copyKtx2Levels(sImage, outTexture, allocator, uMaxDimension);
+			return true;
+		}
+		LOGI("KTX2 format %u is not supported by the device, expanding %s to RGBA8", sImage.uVkFormat, strDebugName.c_str());
+	}
+
+	return decodeRgba8Into(pData, uSize, outTexture, allocator, strDebugName, uMaxDimension);
+}
+
+bool GenerateTextureMips(STextureData& texture) {
+	if (texture.uVkFormat != kKtx2FormatR8G8B8A8Unorm || texture.vecLevels.size() != 1) return false;
+	const SMipLevel sBase = texture.vecLevels.front();
+	if (texture.byteSize() < sBase.uSize) return false;
+
+	std::vector<SMipLevel> vecMips;
+	std::vector<unsigned char> vecChain(mipChainLayout(sBase.uWidth, sBase.uHeight, 4, vecMips));
+	std::memcpy(vecChain.data(), texture.bytes(), vecMips[0].uSize);
+	generateMipChainRgba8(vecChain.data(), vecMips);
+	texture.vecLevels = std::move(vecMips);
+	texture.vecBytes = std::move(vecChain);
+	texture.pStaging.reset();
+	return true;
+}
+
+bool MakeTexturePreview(const STextureData& texture, uint32_t uMaxDimension, STextureData& outPreview) {
+	if (texture.uVkFormat != kKtx2FormatR8G8B8A8Unorm || texture.vecLevels.size() != 1 || uMaxDimension == 0) return false;
+	const SMipLevel sBase = texture.vecLevels.front();
+	if (texture.byteSize() < sBase.uSize || std::max(sBase.uWidth, sBase.uHeight) <= uMaxDimension) return false;
+
+	std::vector<SMipLevel> vecMips;
+	mipChainLayout(sBase.uWidth, sBase.uHeight, 4, vecMips);
+	std::vector<unsigned char> vecCurrent;
+	const unsigned char* pSource = texture.bytes();
+	size_t i = 0;
+	for (; std::max(vecMips[i].uWidth, vecMips[i].uHeight) > uMaxDimension; ++i) {
+		std::vector<unsigned char> vecHalf(vecMips[i + 1].uSize);
+		downsampleRgba8(pSource, vecMips[i].uWidth, vecMips[i].uHeight, vecHalf.data());
+		vecCurrent = std::move(vecHalf);
+		pSource = vecCurrent.data();
+	}
+	outPreview.uVkFormat = kKtx2FormatR8G8B8A8Unorm;
+	outPreview.vecLevels.assign(1, SMipLevel{ vecMips[i].uWidth, vecMips[i].uHeight, 0, vecMips[i].uSize });
+	outPreview.vecBytes = std::move(vecCurrent);
+	outPreview.pStaging.reset();
+	return true;
+}
+
+bool EncodeTextureEtc2(STextureData& texture, const std::vector<uint32_t>& vecSupportedFormats, EEtc2Quality eQuality,
+	const TextureAllocator& allocator) {
+	if (texture.uVkFormat != kKtx2FormatR8G8B8A8Unorm || texture.vecLevels.size() != 1) return false;
+	const SMipLevel& sBase = texture.vecLevels.front();
+
+	bool bAlpha = false;
+	const unsigned char* pPixels = texture.bytes();
+	for (size_t i = 3; i < sBase.uSize && !bAlpha; i += 4) {
+		bAlpha = pPixels[i] != 255;
+	}
+	const uint32_t uFormat = bAlpha ? kKtx2FormatEtc2R8G8B8A8Unorm : kKtx2FormatEtc2R8G8B8Unorm;
+	if (std::find(vecSupportedFormats.begin(), vecSupportedFormats.end(), uFormat) == vecSupportedFormats.end()) {
+		return false;
+	}
+
+	if (!GenerateTextureMips(texture)) return false;
+	const std::vector<SMipLevel>& vecMips = texture.vecLevels;
+	const std::vector<unsigned char>& vecChain = texture.vecBytes;
+
+	STextureData encoded;
+	encoded.uVkFormat = uFormat;
+	encoded.vecLevels.resize(vecMips.size());
+	size_t uOffset = 0;
+	for (size_t i = 0; i < vecMips.size(); ++i) {
+		SMipLevel& sLevel = encoded.vecLevels[i];
+		sLevel.uWidth = vecMips[i].uWidth;
+		sLevel.uHeight = vecMips[i].uHeight;
+		sLevel.uOffset = uOffset;
+		sLevel.uSize = etc2ImageSize(sLevel.uWidth, sLevel.uHeight, bAlpha);
+		uOffset += sLevel.uSize;
+	}
+	unsigned char* pBlocks = encoded.allocateBytes(uOffset, allocator);
+	for (size_t i = 0; i < vecMips.size(); ++i) {
+		encodeEtc2(vecChain.data() + vecMips[i].uOffset, vecMips[i].uWidth, vecMips[i].uHeight, bAlpha, pBlocks + encoded.vecLevels[i].uOffset, eQuality);
+	}
+	texture = std::move(encoded);
+	return true;
+}
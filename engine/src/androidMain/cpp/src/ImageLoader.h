@@ -1,12 +1,92 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "AssetSource.h"
+#include "Etc2.h"
+#include "Ktx2.h"
+#include "Mipmaps.h"
+#include "StagingRing.h"
+
+// Supplies memory for finished texture bytes, typically a block of a mapped
+// staging buffer. May return null, in which case heap memory is used.
+using TextureAllocator = std::function<std::shared_ptr<StagingBlock>(size_t uSize)>;
+
+// Texture ready for upload. Levels are packed largest first, either in vecBytes
+// or, when written straight to staging memory, in pStaging. A single RGBA8
+// level means the renderer still has to build the mip chain.
+struct STextureData {
+	uint32_t uVkFormat = kKtx2FormatR8G8B8A8Unorm;
+	std::vector<SMipLevel> vecLevels;
+	std::vector<unsigned char> vecBytes;
+	std::shared_ptr<StagingBlock> pStaging;
+
+	const unsigned char* bytes() const { return pStaging ? pStaging->data() : vecBytes.data(); }
+	size_t byteSize() const { return pStaging ? pStaging->size() : vecBytes.size(); }
+	// Replaces the current bytes with uSize uninitialised bytes from allocator,
+	// or from vecBytes when there is no allocator or it is out of room.
+	unsigned char* allocateBytes(size_t uSize, const TextureAllocator& allocator);
+};
+
 bool LoadImageFromFile(const std::string& strPath,
 	int nDesiredChannels,
 	std::vector<unsigned char>& outPixels,
 	int& nWidth,
 	int& nHeight);
 
+// Opens an encoded image through assetSource, so APK assets are decoded straight
+// from AAsset_getBuffer memory. On Android, paths the source cannot open (for
+// example non-asset URIs) are retried through EngineAPI.loadFile over JNI.
+AssetData LoadImageFileData(const AssetSource& assetSource, const std::string& strPath);
+
+bool LoadImageFromAsset(const AssetSource& assetSource,
+	const std::string& strPath,
+	int nDesiredChannels,
+	std::vector<unsigned char>& outPixels,
+	int& nWidth,
+	int& nHeight);
+
+// Decodes PNG/JPEG (via stb_image) or the base level of an RGBA8 or ETC2 KTX2
+// container already in memory.
+bool DecodeImageFromMemory(const unsigned char* pData,
+	size_t uSize,
+	int nDesiredChannels,
+	std::vector<unsigned char>& outPixels,
+	int& nWidth,
+	int& nHeight,
+	const std::string& strDebugName = std::string());
+
+// Keeps KTX2 payloads (all levels, no decode) when their format is RGBA8 or in
+// vecSupportedFormats. Anything else is expanded to a single RGBA8 level. The
+// result is written straight into allocator memory when one is given: KTX2
+// levels are copied from pData once, and PNG/JPEG pixels are expanded to RGBA8
+// from stb_image's buffer without an intermediate copy.
+//
+// With uMaxDimension set, KTX2 levels larger than it are skipped and decoded
+// images are shrunk to 1/2, 1/4, ... scale while being expanded.
+bool PrepareTextureFromMemory(const unsigned char* pData,
+	size_t uSize,
+	const std::vector<uint32_t>& vecSupportedFormats,
+	STextureData& outTexture,
+	const std::string& strDebugName = std::string(),
+	const TextureAllocator& allocator = nullptr,
+	uint32_t uMaxDimension = 0);
+
+// Replaces a single-level RGBA8 texture with its full mip chain, in vecBytes.
+bool GenerateTextureMips(STextureData& texture);
+
+// Box-filters a single-level RGBA8 texture down until neither side exceeds
+// uMaxDimension, as a stand-in drawn until the full texture is ready. Returns
+// false when the texture already fits.
+bool MakeTexturePreview(const STextureData& texture, uint32_t uMaxDimension, STextureData& outPreview);
 
+// Builds the mip chain of a single-level RGBA8 texture and encodes every level
+// to ETC2 (RGB when all pixels are opaque), directly into allocator memory when
+// given. Returns false and leaves the texture unchanged when the needed format
+// is not in vecSupportedFormats.
+bool EncodeTextureEtc2(STextureData& texture, const std::vector<uint32_t>& vecSupportedFormats, EEtc2Quality eQuality,
+	const TextureAllocator& allocator = nullptr);
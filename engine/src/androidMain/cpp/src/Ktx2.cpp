@@ -0,0 +1,246 @@
+#include "Ktx2.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Mipmaps.h"
+
+#define LOG_TAG "Ktx2"
+#include "Log.h"
+
+namespace {
+
+constexpr uint8_t kIdentifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+constexpr size_t kLevelAlignment = 16;
+
+// Khronos data format descriptor values used by the formats below.
+constexpr uint8_t kDfdModelRgbsda = 1;
+constexpr uint8_t kDfdModelEtc2 = 161;
+constexpr uint8_t kDfdModelAstc = 162;
+constexpr uint8_t kDfdPrimariesBt709 = 1;
+constexpr uint8_t kDfdTransferLinear = 1;
+constexpr uint8_t kDfdTransferSrgb = 2;
+constexpr uint8_t kDfdChannelAlpha = 15;
+constexpr uint8_t kDfdChannelEtc2Color = 2;
+constexpr uint8_t kDfdChannelAstcData = 0;
+constexpr uint8_t kDfdQualifierLinear = 0x10;
+
+struct SKtx2Header {
+	uint8_t auIdentifier[12];
+	uint32_t uVkFormat;
+	uint32_t uTypeSize;
+	uint32_t uPixelWidth;
+	uint32_t uPixelHeight;
+	uint32_t uPixelDepth;
+	uint32_t uLayerCount;
+	uint32_t uFaceCount;
+	uint32_t uLevelCount;
+	uint32_t uSupercompressionScheme;
+	uint32_t uDfdByteOffset;
+	uint32_t uDfdByteLength;
+	uint32_t uKvdByteOffset;
+	uint32_t uKvdByteLength;
+	uint64_t uSgdByteOffset;
+	uint64_t uSgdByteLength;
+};
+static_assert(sizeof(SKtx2Header) == 80, "KTX2 header layout");
+
+struct SKtx2LevelIndex {
+	uint64_t uByteOffset;
+	uint64_t uByteLength;
+	uint64_t uUncompressedByteLength;
+};
+
+struct SDfdSample {
+	uint8_t uChannel;
+	uint8_t uBitOffset;
+	uint16_t uBitLength;
+};
+
+struct SFormatInfo {
+	uint32_t uVkFormat;
+	uint32_t uBlockWidth;
+	uint32_t uBlockHeight;
+	uint32_t uBytesPerBlock;
+	uint32_t uTypeSize;
+	uint8_t uColorModel;
+	uint8_t uTransfer;
+	uint8_t uSampleCount;
+	SDfdSample asSamples[4];
+};
+
+const SFormatInfo kFormats[] = {
+	{ kKtx2FormatR8G8B8A8Unorm, 1, 1, 4, 1, kDfdModelRgbsda, kDfdTransferLinear, 4,
+		{ { 0, 0, 8 }, { 1, 8, 8 }, { 2, 16, 8 }, { kDfdChannelAlpha, 24, 8 } } },
+	{ kKtx2FormatR8G8B8A8Srgb, 1, 1, 4, 1, kDfdModelRgbsda, kDfdTransferSrgb, 4,
+		{ { 0, 0, 8 }, { 1, 8, 8 }, { 2, 16, 8 }, { kDfdChannelAlpha, 24, 8 } } },
+	{ kKtx2FormatEtc2R8G8B8Unorm, 4, 4, 8, 1, kDfdModelEtc2, kDfdTransferLinear, 1,
+		{ { kDfdChannelEtc2Color, 0, 64 } } },
+	{ kKtx2FormatEtc2R8G8B8A8Unorm, 4, 4, 16, 1, kDfdModelEtc2, kDfdTransferLinear, 2,
+		{ { kDfdChannelAlpha, 0, 64 }, { kDfdChannelEtc2Color, 64, 64 } } },
+	{ kKtx2FormatAstc4x4Unorm, 4, 4, 16, 1, kDfdModelAstc, kDfdTransferLinear, 1,
+		{ { kDfdChannelAstcData, 0, 128 } } },
+	{ kKtx2FormatAstc6x6Unorm, 6, 6, 16, 1, kDfdModelAstc, kDfdTransferLinear, 1,
+		{ { kDfdChannelAstcData, 0, 128 } } },
+};
+
+const SFormatInfo* findFormat(uint32_t uVkFormat) {
+	for (const SFormatInfo& sInfo : kFormats) {
+		if (sInfo.uVkFormat == uVkFormat) return &sInfo;
+	}
+	return nullptr;
+}
+
+size_t alignUp(size_t uValue, size_t uAlignment) {
+	return (uValue + uAlignment - 1) / uAlignment * uAlignment;
+}
+
+size_t levelByteSize(const SFormatInfo& sInfo, uint32_t uWidth, uint32_t uHeight) {
+	const size_t uBlocksX = (uWidth + sInfo.uBlockWidth - 1) / sInfo.uBlockWidth;
+	const size_t uBlocksY = (uHeight + sInfo.uBlockHeight - 1) / sInfo.uBlockHeight;
+	return uBlocksX * uBlocksY * sInfo.uBytesPerBlock;
+}
+
+void appendU32(std::vector<uint8_t>& vecBytes, uint32_t uValue) {
+	const size_t uOffset = vecBytes.size();
+	vecBytes.resize(uOffset + sizeof(uValue));
+	std::memcpy(vecBytes.data() + uOffset, &uValue, sizeof(uValue));
+}
+
+std::vector<uint8_t> buildDfd(const SFormatInfo& sInfo) {
+	const uint32_t uBlockSize = 24 + 16 * sInfo.uSampleCount;
+	std::vector<uint8_t> vecDfd;
+	appendU32(vecDfd, 4 + uBlockSize);
+	appendU32(vecDfd, 0);                              // vendor 0, basic descriptor
+	appendU32(vecDfd, 2u | (uBlockSize << 16));        // version 2
+	appendU32(vecDfd, sInfo.uColorModel | (kDfdPrimariesBt709 << 8) | (sInfo.uTransfer << 16));
+	appendU32(vecDfd, (sInfo.uBlockWidth - 1) | ((sInfo.uBlockHeight - 1) << 8));
+	appendU32(vecDfd, sInfo.uBytesPerBlock);
+	appendU32(vecDfd, 0);
+	for (uint8_t i = 0; i < sInfo.uSampleCount; ++i) {
+		const SDfdSample& sSample = sInfo.asSamples[i];
+		uint8_t uChannel = sSample.uChannel;
+		if (uChannel == kDfdChannelAlpha && sInfo.uTransfer == kDfdTransferSrgb) {
+			uChannel |= kDfdQualifierLinear;
+		}
+		appendU32(vecDfd, sSample.uBitOffset | (static_cast<uint32_t>(sSample.uBitLength - 1) << 16) | (static_cast<uint32_t>(uChannel) << 24));
+		appendU32(vecDfd, 0);
+		appendU32(vecDfd, 0);
+		appendU32(vecDfd, sSample.uBitLength >= 32 ? 0xFFFFFFFFu : ((1u << sSample.uBitLength) - 1));
+	}
+	return vecDfd;
+}
+
+} // namespace
+
+bool isKtx2FormatBlockCompressed(uint32_t uVkFormat) {
+	const SFormatInfo* pInfo = findFormat(uVkFormat);
+	return pInfo && (pInfo->uBlockWidth > 1 || pInfo->uBlockHeight > 1);
+}
+
+bool isKtx2(const void* pData, size_t uSize) {
+	return pData && uSize >= sizeof(kIdentifier) && std::memcmp(pData, kIdentifier, sizeof(kIdentifier)) == 0;
+}
+
+bool parseKtx2(const void* pData, size_t uSize, SKtx2Image& outImage) {
+	if (!isKtx2(pData, uSize) || uSize < sizeof(SKtx2Header)) {
+		LOGE("Not a KTX2 container");
+		return false;
+	}
+	const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+	SKtx2Header sHeader;
+	std::memcpy(&sHeader, pBytes, sizeof(sHeader));
+	if (sHeader.uSupercompressionScheme != 0 || sHeader.uPixelDepth > 1 || sHeader.uLayerCount > 1 || sHeader.uFaceCount != 1) {
+		LOGE("Unsupported KTX2 layout (supercompression %u, depth %u, layers %u, faces %u)",
+			sHeader.uSupercompressionScheme,
+			sHeader.uPixelDepth,
+			sHeader.uLayerCount,
+			sHeader.uFaceCount);
+		return false;
+	}
+	const SFormatInfo* pInfo = findFormat(sHeader.uVkFormat);
+	if (!pInfo) {
+		LOGE("Unsupported KTX2 format %u", sHeader.uVkFormat);
+		return false;
+	}
+	const uint32_t uLevelCount = std::max(1u, sHeader.uLevelCount);
+	if (sHeader.uPixelWidth == 0 || uLevelCount > mipLevelCount(sHeader.uPixelWidth, std::max(1u, sHeader.uPixelHeight))) {
+		LOGE("Invalid KTX2 extent %ux%u with %u levels", sHeader.uPixelWidth, sHeader.uPixelHeight, uLevelCount);
+		return false;
+	}
+	if (sizeof(SKtx2Header) + sizeof(SKtx2LevelIndex) * uLevelCount > uSize) {
+		LOGE("KTX2 level index is truncated");
+		return false;
+	}
+
+	SKtx2Image sImage;
+	sImage.uVkFormat = sHeader.uVkFormat;
+	sImage.uWidth = sHeader.uPixelWidth;
+	sImage.uHeight = std::max(1u, sHeader.uPixelHeight);
+	sImage.vecLevels.reserve(uLevelCount);
+	for (uint32_t uLevel = 0; uLevel < uLevelCount; ++uLevel) {
+		SKtx2LevelIndex sIndex;
+		std::memcpy(&sIndex, pBytes + sizeof(SKtx2Header) + sizeof(SKtx2LevelIndex) * uLevel, sizeof(sIndex));
+		SKtx2Level sLevel;
+		sLevel.uWidth = std::max(1u, sImage.uWidth >> uLevel);
+		sLevel.uHeight = std::max(1u, sImage.uHeight >> uLevel);
+		if (sIndex.uByteOffset > uSize || sIndex.uByteLength > uSize - sIndex.uByteOffset ||
+			sIndex.uByteLength < levelByteSize(*pInfo, sLevel.uWidth, sLevel.uHeight)) {
+			LOGE("KTX2 level %u is out of bounds", uLevel);
+			return false;
+		}
+		sLevel.pData = pBytes + sIndex.uByteOffset;
+		sLevel.uSize = static_cast<size_t>(sIndex.uByteLength);
+		sImage.vecLevels.push_back(sLevel);
+	}
+	outImage = std::move(sImage);
+	return true;
+}
+
+bool writeKtx2(uint32_t uVkFormat, const std::vector<SKtx2LevelData>& vecLevels, std::vector<uint8_t>& outBytes) {
+	const SFormatInfo* pInfo = findFormat(uVkFormat);
+	if (!pInfo || vecLevels.empty()) {
+		LOGE("writeKtx2: unsupported format %u or no levels", uVkFormat);
+		return false;
+	}
+	for (size_t i = 0; i < vecLevels.size(); ++i) {
+		const SKtx2LevelData& sLevel = vecLevels[i];
+		if (sLevel.vecBytes.size() != levelByteSize(*pInfo, sLevel.uWidth, sLevel.uHeight)) {
+			LOGE("writeKtx2: level %zu has %zu bytes, expected %zu", i, sLevel.vecBytes.size(), levelByteSize(*pInfo, sLevel.uWidth, sLevel.uHeight));
+			return false;
+		}
+	}
+
+	const std::vector<uint8_t> vecDfd = buildDfd(*pInfo);
+	const size_t uLevelCount = vecLevels.size();
+	const size_t uDfdOffset = sizeof(SKtx2Header) + sizeof(SKtx2LevelIndex) * uLevelCount;
+
+	SKtx2Header sHeader{};
+	std::memcpy(sHeader.auIdentifier, kIdentifier, sizeof(kIdentifier));
+	sHeader.uVkFormat = uVkFormat;
+	sHeader.uTypeSize = pInfo->uTypeSize;
+	sHeader.uPixelWidth = vecLevels.front().uWidth;
+	sHeader.uPixelHeight = vecLevels.front().uHeight;
+	sHeader.uFaceCount = 1;
+	sHeader.uLevelCount = static_cast<uint32_t>(uLevelCount);
+	sHeader.uDfdByteOffset = static_cast<uint32_t>(uDfdOffset);
+	sHeader.uDfdByteLength = static_cast<uint32_t>(vecDfd.size());
+
+	outBytes.assign(uDfdOffset, 0);
+	outBytes.insert(outBytes.end(), vecDfd.begin(), vecDfd.end());
+
+	// Level data goes smallest first as the spec recommends for streaming.
+	std::vector<SKtx2LevelIndex> vecIndex(uLevelCount);
+	for (size_t i = uLevelCount; i-- > 0;) {
+		const size_t uOffset = alignUp(outBytes.size(), kLevelAlignment);
+		outBytes.resize(uOffset, 0);
+		outBytes.insert(outBytes.end(), vecLevels[i].vecBytes.begin(), vecLevels[i].vecBytes.end());
+		vecIndex[i].uByteOffset = uOffset;
+		vecIndex[i].uByteLength = vecLevels[i].vecBytes.size();
+		vecIndex[i].uUncompressedByteLength = vecLevels[i].vecBytes.size();
+	}
+
+	std::memcpy(outBytes.data(), &sHeader, sizeof(sHeader));
+	std::memcpy(outBytes.data() + sizeof(sHeader), vecIndex.data(), sizeof(SKtx2LevelIndex) * uLevelCount);
+	return true;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Minimal KTX2 container support: single layer, single face 2D textures with
+// no supercompression. Formats are stored as raw VkFormat values so this file
+// does not depend on Vulkan headers.
+
+constexpr const char* kKtx2Extension = ".ktx2";
+
+constexpr uint32_t kKtx2FormatR8G8B8A8Unorm = 37;
+constexpr uint32_t kKtx2FormatR8G8B8A8Srgb = 43;
+constexpr uint32_t kKtx2FormatEtc2R8G8B8Unorm = 147;
+constexpr uint32_t kKtx2FormatEtc2R8G8B8A8Unorm = 151;
+constexpr uint32_t kKtx2FormatAstc4x4Unorm = 157;
+constexpr uint32_t kKtx2FormatAstc6x6Unorm = 165;
+
+struct SKtx2Level {
+	uint32_t uWidth = 0;
+	uint32_t uHeight = 0;
+	const uint8_t* pData = nullptr;
+	size_t uSize = 0;
+};
+
+// Views into a parsed container. Level 0 is the full resolution image.
+struct SKtx2Image {
+	uint32_t uVkFormat = 0;
+	uint32_t uWidth = 0;
+	uint32_t uHeight = 0;
+	std::vector<SKtx2Level> vecLevels;
+};
+
+// Input level for the writer, largest first.
+struct SKtx2LevelData {
+	uint32_t uWidth = 0;
+	uint32_t uHeight = 0;
+	std::vector<uint8_t> vecBytes;
+};
+
+bool isKtx2(const void* pData, size_t uSize);
+
+bool isKtx2FormatBlockCompressed(uint32_t uVkFormat);
+
+bool parseKtx2(const void* pData, size_t uSize, SKtx2Image& outImage);
+
+bool writeKtx2(uint32_t uVkFormat, const std::vector<SKtx2LevelData>& vecLevels, std::vector<uint8_t>& outBytes);
@@ -0,0 +1,221 @@
+#include "LoadPipeline.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "Hash.h"
+#include "MeshOptimizer.h"
+#include "ModelCache.h"
+
+#define LOG_TAG "LoadPipeline"
+#include "Log.h"
+
+namespace {
+
+constexpr size_t kParseThreads = 1;
+constexpr size_t kReadThreads = 2;
+constexpr size_t kDecodeThreads = 2;
+constexpr size_t kMaxEncodeThreads = 4;
+
+constexpr size_t kParseQueueCapacity = 64;
+constexpr size_t kReadQueueCapacity = 256;
+// Encoded and decoded images are large, so only a few wait between stages.
+constexpr size_t kDecodeQueueCapacity = 4;
+constexpr size_t kEncodeQueueCapacity = 4;
+// Results waiting here are uploaded together, so a few more are allowed; they
+// are mostly ETC2 payloads at most a quarter the size of RGBA8.
+constexpr size_t kUploadQueueCapacity = 8;
+
+} // namespace
+
+LoadPipeline::LoadPipeline(std::shared_ptr<const AssetSource> pSource, UploadFunction uploadFunction, SLoadPipelineOptions sOptions)
+	: pAssetSource(std::move(pSource)),
+	  upload(std::move(uploadFunction)),
+	  options(std::move(sOptions)),
+	  parseQueue(kParseQueueCapacity),
+	  readQueue(kReadQueueCapacity),
+	  decodeQueue(kDecodeQueueCapacity),
+	  encodeQueue(kEncodeQueueCapacity),
+	  uploadQueue(kUploadQueueCapacity) {
+	const size_t uHardwareThreads = std::max<size_t>(std::thread::hardware_concurrency(), 2);
+	const size_t uEncodeThreads = std::min(kMaxEncodeThreads, uHardwareThreads - 1);
+
+	for (size_t i = 0; i < kParseThreads; ++i) {
+		vecThreads.emplace_back(&LoadPipeline::runParseStage, this);
+	}
+	for (size_t i = 0; i < kReadThreads; ++i) {
+		vecThreads.emplace_back(&LoadPipeline::runReadStage, this);
+	}
+	for (size_t i = 0; i < kDecodeThreads; ++i) {
+		vecThreads.emplace_back(&LoadPipeline::runDecodeStage, this);
+	}
+	for (size_t i = 0; i < uEncodeThreads; ++i) {
+		vecThreads.emplace_back(&LoadPipeline::runEncodeStage, this);
+	}
+	vecThreads.emplace_back(&LoadPipeline::runUploadStage, this);
+}
+
+LoadPipeline::~LoadPipeline() {
+	parseQueue.close();
+	readQueue.close();
+	decodeQueue.close();
+	encodeQueue.close();
+	uploadQueue.close();
+	for (std::thread& thread : vecThreads) {
+		thread.join();
+	}
+}
+
+void LoadPipeline::enqueue(SModelLoadRequest&& request) {
+	parseQueue.push(std::move(request));
+}
+
+bool LoadPipeline::reloadTexture(const std::string& strPath) {
+	return readQueue.tryPush(std::string(strPath));
+}
+
+void LoadPipeline::requestTextures(const std::vector<Material>& vecMaterials) {
+	for (const Material& material : vecMaterials) {
+		if (material.diffuseTexture.empty()) continue;
+		{
+			std::lock_guard<std::mutex> lock(texturesMutex);
+			if (!setRequestedTextures.insert(material.diffuseTexture).second) continue;
+		}
+		readQueue.push(std::string(material.diffuseTexture));
+	}
+}
+
+void LoadPipeline::runParseStage() {
+	SModelLoadRequest request;
+	while (parseQueue.pop(request)) {
+		Model model = loadModel(*pAssetSource, request.strPath, [this](const std::vector<Material>& vecMaterials) {
+			requestTextures(vecMaterials);
+		});
+		if (!model.hasGeometry()) {
+			LOGE("Model %s has no geometry and will be skipped", request.strPath.c_str());
+			continue;
+		}
+		// Catches materials the loader did not report early.
+		requestTextures(model.materials);
+		packModelStreams(model);
+
+		model.setPosition(request.afPosition[0], request.afPosition[1], request.afPosition[2]);
+		model.setScale(request.fScale);
+
+		SLoadResult result;
+		result.eKind = SLoadResult::EKind::Model;
+		result.llModelId = request.llModelId;
+		result.model = std::move(model);
+		if (!uploadQueue.push(std::move(result))) return;
+	}
+}
+
+void LoadPipeline::runReadStage() {
+	std::string strPath;
+	while (readQueue.pop(strPath)) {
+		SEncodedTexture texture;
+		texture.strPath = strPath;
+		texture.data = LoadImageFileData(*pAssetSource, strPath);
+		if (!decodeQueue.push(std::move(texture))) return;
+	}
+}
+
+void LoadPipeline::runDecodeStage() {
+	SEncodedTexture texture;
+	while (decodeQueue.pop(texture)) {
+		SLoadResult result;
+		result.eKind = SLoadResult::EKind::Texture;
+		result.strTexturePath = texture.strPath;
+
+		// ETC2 encodes of uncooked images are slow enough to be worth caching.
+		uint64_t uSourceHash = 0;
+		if (options.bEncodeTextures && texture.data && !isKtx2(texture.data.data(), texture.data.size()) &&
+			ModelCache::instance().isEnabled()) {
+			uSourceHash = hash64(texture.data.data(), texture.data.size());
+			if (ModelCache::instance().tryLoadTexture(texture.strPath, uSourceHash, textureCacheSettings(), options.vecTextureFormats,
+					result.texture, options.textureAllocator)) {
+				texture.data = AssetData();
+				if (!uploadQueue.push(std::move(result))) return;
+				continue;
+			}
+		}
+
+		// Uncooked images are re-read by the encoder or mip builder, so only
+		// KTX2 payloads and images uploaded as decoded go to staging memory here.
+		const bool bFinalAfterDecode = !options.bEncodeTextures && !options.bBuildMipChains;
+		const bool bDecodeToStaging = texture.data && (bFinalAfterDecode || isKtx2(texture.data.data(), texture.data.size()));
+		if (texture.data &&
+			!PrepareTextureFromMemory(texture.data.data(), texture.data.size(), options.vecTextureFormats, result.texture, texture.strPath,
+				bDecodeToStaging ? options.textureAllocator : TextureAllocator(), options.uMaxTextureDimension)) {
+			result.texture = STextureData();
+		}
+		// Releases the mapped asset before blocking on the next queue.
+		texture.data = AssetData();
+		const bool bNeedsEncode = result.texture.byteSize() > 0 && !bFinalAfterDecode &&
+			result.texture.uVkFormat == kKtx2FormatR8G8B8A8Unorm && result.texture.vecLevels.size() == 1;
+		if (!bNeedsEncode) {
+			if (!uploadQueue.push(std::move(result))) return;
+			continue;
+		}
+
+		SLoadResult preview;
+		if (MakeTexturePreview(result.texture, options.uPreviewMaxDimension, preview.texture)) {
+			preview.eKind = SLoadResult::EKind::Texture;
+			preview.strTexturePath = result.strTexturePath;
+			preview.bPreview = true;
+			if (!uploadQueue.push(std::move(preview))) return;
+		}
+		if (!encodeQueue.push({ std::move(result), uSourceHash })) return;
+	}
+}
+
+void LoadPipeline::runEncodeStage() {
+	SPendingEncode pending;
+	while (encodeQueue.pop(pending)) {
+		SLoadResult& result = pending.result;
+		if (encodeTexture(result.texture, result.strTexturePath)) {
+			if (pending.uSourceHash != 0) {
+				ModelCache::instance().storeTexture(result.strTexturePath, pending.uSourceHash, textureCacheSettings(), result.texture);
+			}
+		} else if (options.bBuildMipChains) {
+			GenerateTextureMips(result.texture);
+		}
+		if (!uploadQueue.push(std::move(result))) return;
+	}
+}
+
+uint64_t LoadPipeline::textureCacheSettings() const {
+	Hash64 hasher;
+	hasher.updateU64(static_cast<uint64_t>(options.eEncodeQuality));
+	hasher.updateU64(options.uMaxTextureDimension);
+	return hasher.digest();
+}
+
+bool LoadPipeline::encodeTexture(STextureData& texture, const std::string& strPath) {
+	if (!options.bEncodeTextures || texture.uVkFormat != kKtx2FormatR8G8B8A8Unorm || texture.vecLevels.size() != 1) return false;
+
+	// The mip chain adds a third to the base level.
+	const double megapixels = static_cast<double>(texture.vecLevels[0].uWidth) * texture.vecLevels[0].uHeight * (4.0 / 3.0) / 1e6;
+	const double predictedMs = megapixels * encodeMsPerMegapixel.load();
+	if (predictedMs > options.encodeBudgetMs) {
+		LOGI("Keeping %s as RGBA8: ETC2 encode would take about %.0f ms", strPath.c_str(), predictedMs);
+		return false;
+	}
+
+	const auto tStart = std::chrono::steady_clock::now();
+	if (!EncodeTextureEtc2(texture, options.vecTextureFormats, options.eEncodeQuality, options.textureAllocator)) return false;
+	const double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tStart).count();
+	if (megapixels > 0.0) {
+		encodeMsPerMegapixel.store(elapsedMs / megapixels);
+	}
+	LOGI("Encoded %s to ETC2 in %.1f ms", strPath.c_str(), elapsedMs);
+	return true;
+}
+
+void LoadPipeline::runUploadStage() {
+	std::vector<SLoadResult> vecResults;
+	while (uploadQueue.popAll(vecResults)) {
+		upload(std::move(vecResults));
+		vecResults.clear();
+	}
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "AssetSource.h"
+#include "BoundedQueue.h"
+#include "ImageLoader.h"
+#include "Model.h"
+#include "ModelLoader.h"
+
+struct SModelLoadRequest {
+	int64_t llModelId = 0;
+	std::string strPath;
+	float afPosition[3] = { 0.0f, 0.0f, 0.0f };
+	float fScale = 1.0f;
+};
+
+// Output of the pipeline, delivered to the upload callback on one thread.
+struct SLoadResult {
+	enum class EKind { Model, Texture };
+	EKind eKind = EKind::Model;
+
+	int64_t llModelId = 0;
+	Model model;
+
+	// texture has no bytes when the texture could not be read or decoded.
+	std::string strTexturePath;
+	STextureData texture;
+	// Low-resolution stand-in; the full texture for the same path follows.
+	bool bPreview = false;
+};
+
+struct SLoadPipelineOptions {
+	// Compressed KTX2 formats the device can sample.
+	std::vector<uint32_t> vecTextureFormats;
+	// Encodes uncooked PNG/JPEG textures to ETC2 on the decode threads. The
+	// results are kept in ModelCache when it is enabled.
+	bool bEncodeTextures = true;
+	EEtc2Quality eEncodeQuality = EEtc2Quality::Normal;
+	// Textures whose predicted encode time exceeds this stay RGBA8.
+	double encodeBudgetMs = 400.0;
+	// Builds RGBA8 mip chains on the decode threads, for devices that cannot
+	// generate them with linear blits.
+	bool bBuildMipChains = false;
+	// Textures are shrunk by powers of two (or lose their top KTX2 levels) until
+	// neither side exceeds this. 0 keeps the source size.
+	uint32_t uMaxTextureDimension = 0;
+	// Textures that still need an ETC2 encode or a CPU mip chain are first sent
+	// at most this large, so they show before that work finishes. 0 disables.
+	uint32_t uPreviewMaxDimension = 128;
+	// Memory the final texture bytes are written to, normally the renderer's
+	// mapped staging ring. Used for whichever step produces the bytes that get
+	// uploaded: the decode itself, or the ETC2 encode.
+	TextureAllocator textureAllocator;
+};
+
+// Loads models through five stages connected by bounded queues:
+//
+//   parse  -> runs the model loader (file reads included), interleaves the
+//             vertex streams and forwards each newly seen texture path as soon
+//             as the material table is known
+//   read   -> reads encoded texture bytes
+//   decode -> keeps GPU-ready KTX2 payloads and decodes everything else to
+//             RGBA8, sending a downscaled preview straight to upload
+//   encode -> within a time budget, re-encodes RGBA8 textures to ETC2 or
+//             builds their mip chains on the CPU
+//   upload -> hands every finished model and texture waiting at that moment to
+//             the upload callback as one batch
+//
+// Textures therefore decode while geometry is still being built, and a model
+// can be drawn with placeholder textures before its own textures arrive. All
+// CPU work happens here, so the upload callback only creates Vulkan objects.
+class LoadPipeline {
+public:
+	using UploadFunction = std::function<void(std::vector<SLoadResult>&&)>;
+
+	LoadPipeline(std::shared_ptr<const AssetSource> pSource, UploadFunction uploadFunction, SLoadPipelineOptions sOptions = {});
+	~LoadPipeline();
+
+	LoadPipeline(const LoadPipeline&) = delete;
+	LoadPipeline& operator=(const LoadPipeline&) = delete;
+
+	void enqueue(SModelLoadRequest&& request);
+
+	// Reads and decodes a texture again after the renderer evicted it. Never
+	// blocks, so it is safe to call while holding the render lock; returns false
+	// when the pipeline is too busy and the caller should retry later.
+	bool reloadTexture(const std::string& strPath);
+
+private:
+	struct SEncodedTexture {
+		std::string strPath;
+		AssetData data;
+	};
+
+	// Decoded texture waiting for the encoder. uSourceHash is the XXH64 of the
+	// encoded image, or 0 when the result should not go to the model cache.
+	struct SPendingEncode {
+		SLoadResult result;
+		uint64_t uSourceHash = 0;
+	};
+
+	void runParseStage();
+	void runReadStage();
+	void runDecodeStage();
+	void runEncodeStage();
+	void runUploadStage();
+	void requestTextures(const std::vector<Material>& vecMaterials);
+	bool encodeTexture(STextureData& texture, const std::string& strPath);
+	uint64_t textureCacheSettings() const;
+
+	std::shared_ptr<const AssetSource> pAssetSource;
+	UploadFunction upload;
+	SLoadPipelineOptions options;
+	// Measured on earlier textures; 0 until the first encode finishes.
+	std::atomic<double> encodeMsPerMegapixel{ 0.0 };
+
+	BoundedQueue<SModelLoadRequest> parseQueue;
+	BoundedQueue<std::string> readQueue;
+	BoundedQueue<SEncodedTexture> decodeQueue;
+	BoundedQueue<SPendingEncode> encodeQueue;
+	BoundedQueue<SLoadResult> uploadQueue;
+
+	std::mutex texturesMutex;
+	std::unordered_set<std::string> setRequestedTextures;
+
+	std::vector<std::thread> vecThreads;
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+// Logging macros shared by code that also builds for the host tools.
+// Define LOG_TAG before including this header.
+
+#ifdef __ANDROID__
+
+#include <android/log.h>
+
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+#else
+
+#include <cstdarg>
+#include <cstdio>
+
+// Formats the whole line first so output from worker threads does not interleave.
+inline void hostLogPrint(FILE* pStream, char cLevel, const char* pcTag, const char* pcFormat, ...)
+	__attribute__((format(printf, 4, 5)));
+
+inline void hostLogPrint(FILE* pStream, char cLevel, const char* pcTag, const char* pcFormat, ...) {
+	char acBuffer[1024];
+	va_list args;
+	va_start(args, pcFormat);
+	vsnprintf(acBuffer, sizeof(acBuffer), pcFormat, args);
+	va_end(args);
+	fprintf(pStream, "%c/%s: %s\n", cLevel, pcTag, acBuffer);
+}
+
+#define LOGI(...) hostLogPrint(stdout, 'I', LOG_TAG, __VA_ARGS__)
+#define LOGW(...) hostLogPrint(stderr, 'W', LOG_TAG, __VA_ARGS__)
+#define LOGE(...) hostLogPrint(stderr, 'E', LOG_TAG, __VA_ARGS__)
+
+#endif
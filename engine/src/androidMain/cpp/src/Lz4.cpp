@@ -0,0 +1,163 @@
+#include "Lz4.h"
+
+#include <cstring>
+
+namespace {
+
+constexpr size_t kMinMatch = 4;
+constexpr size_t kLastLiterals = 5;
+constexpr size_t kMatchSearchLimit = 12;
+constexpr size_t kMaxOffset = 65535;
+constexpr int kHashBits = 14;
+constexpr uint32_t kNoPosition = 0xFFFFFFFFu;
+
+inline uint32_t read32(const uint8_t* pBytes) {
+	uint32_t uValue;
+	std::memcpy(&uValue, pBytes, sizeof(uValue));
+	return uValue;
+}
+
+inline uint32_t hashSequence(uint32_t uSequence) {
+	return (uSequence * 2654435761u) >> (32 - kHashBits);
+}
+
+void writeLength(std::vector<uint8_t>& outBytes, size_t uLength) {
+	while (uLength >= 255) {
+		outBytes.push_back(255);
+		uLength -= 255;
+	}
+	outBytes.push_back(static_cast<uint8_t>(uLength));
+}
+
+void writeSequence(std::vector<uint8_t>& outBytes, const uint8_t* pLiterals, size_t uLiteralLength, size_t uOffset, size_t uMatchLength) {
+	const size_t uMatchCode = uMatchLength - kMinMatch;
+	const uint8_t uToken = static_cast<uint8_t>(((uLiteralLength < 15 ? uLiteralLength : 15) << 4) | (uMatchCode < 15 ? uMatchCode : 15));
+	outBytes.push_back(uToken);
+	if (uLiteralLength >= 15) {
+		writeLength(outBytes, uLiteralLength - 15);
+	}
+	outBytes.insert(outBytes.end(), pLiterals, pLiterals + uLiteralLength);
+	outBytes.push_back(static_cast<uint8_t>(uOffset & 0xFF));
+	outBytes.push_back(static_cast<uint8_t>(uOffset >> 8));
+	if (uMatchCode >= 15) {
+		writeLength(outBytes, uMatchCode - 15);
+	}
+}
+
+void writeLastLiterals(std::vector<uint8_t>& outBytes, const uint8_t* pLiterals, size_t uLiteralLength) {
+	outBytes.push_back(static_cast<uint8_t>((uLiteralLength < 15 ? uLiteralLength : 15) << 4));
+	if (uLiteralLength >= 15) {
+		writeLength(outBytes, uLiteralLength - 15);
+	}
+	outBytes.insert(outBytes.end(), pLiterals, pLiterals + uLiteralLength);
+}
+
+bool readLength(const uint8_t* pInput, size_t uInputSize, size_t& uPosition, size_t& uLength) {
+	uint8_t uByte = 255;
+	while (uByte == 255) {
+		if (uPosition >= uInputSize) return false;
+		uByte = pInput[uPosition++];
+		uLength += uByte;
+	}
+	return true;
+}
+
+} // namespace
+
+size_t lz4CompressBound(size_t uInputSize) {
+	return uInputSize + uInputSize / 255 + 16;
+}
+
+void lz4Compress(const void* pInput, size_t uInputSize, std::vector<uint8_t>& outBytes) {
+	const uint8_t* pSource = static_cast<const uint8_t*>(pInput);
+	outBytes.reserve(outBytes.size() + lz4CompressBound(uInputSize));
+
+	size_t uAnchor = 0;
+	if (uInputSize > kMatchSearchLimit) {
+		std::vector<uint32_t> vecTable(size_t(1) << kHashBits, kNoPosition);
+		const size_t uSearchEnd = uInputSize - kMatchSearchLimit;
+		const size_t uMatchEnd = uInputSize - kLastLiterals;
+		size_t uPosition = 0;
+		while (uPosition < uSearchEnd) {
+			const uint32_t uSequence = read32(pSource + uPosition);
+			const uint32_t uHash = hashSequence(uSequence);
+			const uint32_t uCandidate = vecTable[uHash];
+			vecTable[uHash] = static_cast<uint32_t>(uPosition);
+			if (uCandidate == kNoPosition || uPosition - uCandidate > kMaxOffset || read32(pSource + uCandidate) != uSequence) {
+				++uPosition;
+				continue;
+			}
+
+			size_t uLength = kMinMatch;
+			while (uPosition + uLength < uMatchEnd && pSource[uCandidate + uLength] == pSource[uPosition + uLength]) {
+				++uLength;
+			}
+			writeSequence(outBytes, pSource + uAnchor, uPosition - uAnchor, uPosition - uCandidate, uLength);
+			uPosition += uLength;
+			uAnchor = uPosition;
+			if (uPosition >= 2 && uPosition < uSearchEnd) {
+				vecTable[hashSequence(read32(pSource + uPosition - 2))] = static_cast<uint32_t>(uPosition - 2);
+			}
+		}
+	}
+	writeLastLiterals(outBytes, pSource + uAnchor, uInputSize - uAnchor);
+}
+
+bool lz4Decompress(const void* pInput, size_t uInputSize, void* pOutput, size_t uOutputSize) {
+	const uint8_t* pSource = static_cast<const uint8_t*>(pInput);
+	uint8_t* pDestination = static_cast<uint8_t*>(pOutput);
+	size_t uIn = 0;
+	size_t uOut = 0;
+
+	while (uIn < uInputSize) {
+		const uint8_t uToken = pSource[uIn++];
+
+		size_t uLiteralLength = uToken >> 4;
+		if (uLiteralLength == 15 && !readLength(pSource, uInputSize, uIn, uLiteralLength)) return false;
+		if (uLiteralLength > uInputSize - uIn || uLiteralLength > uOutputSize - uOut) return false;
+		if (uInputSize - uIn >= 16 && uOutputSize - uOut >= 16 && uLiteralLength <= 16) {
+			// Fixed-size copy of short literal runs; the excess is overwritten later.
+			std::memcpy(pDestination + uOut, pSource + uIn, 16);
+		} else {
+			std::memcpy(pDestination + uOut, pSource + uIn, uLiteralLength);
+		}
+		uIn += uLiteralLength;
+		uOut += uLiteralLength;
+		if (uIn == uInputSize) break;
+
+		if (uInputSize - uIn < 2) return false;
+		const size_t uOffset = static_cast<size_t>(pSource[uIn]) | (static_cast<size_t>(pSource[uIn + 1]) << 8);
+		uIn += 2;
+		if (uOffset == 0 || uOffset > uOut) return false;
+
+		size_t uMatchLength = uToken & 15;
+		if (uMatchLength == 15 && !readLength(pSource, uInputSize, uIn, uMatchLength)) return false;
+		uMatchLength += kMinMatch;
+		if (uMatchLength > uOutputSize - uOut) return false;
+
+		uint8_t* pCopy = pDestination + uOut;
+		if (uOffset >= uMatchLength) {
+			std::memcpy(pCopy, pCopy - uOffset, uMatchLength);
+		} else {
+			// Overlapping match: it repeats the last uOffset bytes. Short periods
+			// are widened to a multiple of at least 8 bytes so the bulk can be
+			// copied in non-overlapping 8-byte chunks.
+			size_t uStride = uOffset;
+			size_t i = 0;
+			if (uOffset < 8) {
+				uStride = uOffset * ((8 + uOffset - 1) / uOffset);
+				for (; i < uStride && i < uMatchLength; ++i) {
+					pCopy[i] = pCopy[i - uOffset];
+				}
+			}
+			for (; i + 8 <= uMatchLength; i += 8) {
+				std::memcpy(pCopy + i, pCopy + i - uStride, 8);
+			}
+			for (; i < uMatchLength; ++i) {
+				pCopy[i] = pCopy[i - uStride];
+			}
+		}
+		uOut += uMatchLength;
+	}
+	return uOut == uOutputSize;
+}
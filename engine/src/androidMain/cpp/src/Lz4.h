@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// LZ4 block format (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md)
+// without the frame layer; sizes are stored by the caller.
+
+size_t lz4CompressBound(size_t uInputSize);
+
+// Greedy single-probe compressor. Appends the compressed block to outBytes.
+void lz4Compress(const void* pInput, size_t uInputSize, std::vector<uint8_t>& outBytes);
+
+// Decompresses exactly uOutputSize bytes into pOutput. Returns false on corrupt
+// input or a size mismatch; never reads or writes out of bounds.
+bool lz4Decompress(const void* pInput, size_t uInputSize, void* pOutput, size_t uOutputSize);
@@ -0,0 +1,184 @@
+#include "MeshOptimizer.h"
+#include "CookedModel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t kUnassigned = std::numeric_limits<uint32_t>::max();
+
+struct SPackedVertexKey {
+	const float* pVertex = nullptr;
+
+	bool operator==(const SPackedVertexKey& other) const noexcept {
+		return std::memcmp(pVertex, other.pVertex, sizeof(float) * Model::kPackedVertexFloats) == 0;
+	}
+};
+
+struct SPackedVertexHash {
+	size_t operator()(const SPackedVertexKey& key) const noexcept {
+		uint32_t auBits[Model::kPackedVertexFloats];
+		std::memcpy(auBits, key.pVertex, sizeof(auBits));
+		size_t h = 0;
+		for (uint32_t uBits : auBits) {
+			h = h * 31u + uBits;
+		}
+		return h;
+	}
+};
+
+void remapVertices(Model& model, const std::vector<uint32_t>& vecRemap, size_t uNewVertexCount) {
+	std::vector<float> vecVertices(uNewVertexCount * Model::kPackedVertexFloats);
+	for (size_t i = 0; i < vecRemap.size(); ++i) {
+		if (vecRemap[i] == kUnassigned) continue;
+		std::memcpy(vecVertices.data() + static_cast<size_t>(vecRemap[i]) * Model::kPackedVertexFloats,
+			model.packedVertices.data() + i * Model::kPackedVertexFloats,
+			sizeof(float) * Model::kPackedVertexFloats);
+	}
+	for (uint32_t& uIndex : model.indices) {
+		uIndex = vecRemap[uIndex];
+	}
+	model.packedVertices.swap(vecVertices);
+}
+
+void appendMeshlet(Model& model, const std::vector<uint32_t>& vecVertices, const std::vector<uint8_t>& vecTriangles) {
+	Model::Meshlet sMeshlet;
+	sMeshlet.vertexOffset = static_cast<uint32_t>(model.meshletVertices.size());
+	sMeshlet.triangleOffset = static_cast<uint32_t>(model.meshletTriangles.size());
+	sMeshlet.vertexCount = static_cast<uint32_t>(vecVertices.size());
+	sMeshlet.triangleCount = static_cast<uint32_t>(vecTriangles.size() / 3);
+
+	float afMin[3] = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+	float afMax[3] = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+	for (uint32_t uVertex : vecVertices) {
+		const float* pPosition = model.packedVertices.data() + static_cast<size_t>(uVertex) * Model::kPackedVertexFloats;
+		for (int axis = 0; axis < 3; ++axis) {
+			afMin[axis] = std::min(afMin[axis], pPosition[axis]);
+			afMax[axis] = std::max(afMax[axis], pPosition[axis]);
+		}
+	}
+	for (int axis = 0; axis < 3; ++axis) {
+		sMeshlet.center[axis] = 0.5f * (afMin[axis] + afMax[axis]);
+	}
+	float fRadiusSq = 0.0f;
+	for (uint32_t uVertex : vecVertices) {
+		const float* pPosition = model.packedVertices.data() + static_cast<size_t>(uVertex) * Model::kPackedVertexFloats;
+		const float dx = pPosition[0] - sMeshlet.center[0];
+		const float dy = pPosition[1] - sMeshlet.center[1];
+		const float dz = pPosition[2] - sMeshlet.center[2];
+		fRadiusSq = std::max(fRadiusSq, dx * dx + dy * dy + dz * dz);
+	}
+	sMeshlet.radius = std::sqrt(fRadiusSq);
+
+	model.meshletVertices.insert(model.meshletVertices.end(), vecVertices.begin(), vecVertices.end());
+	model.meshletTriangles.insert(model.meshletTriangles.end(), vecTriangles.begin(), vecTriangles.end());
+	model.meshlets.push_back(sMeshlet);
+}
+
+} // namespace
+
+void packModelStreams(Model& model) {
+	if (model.hasPackedVertices()) return;
+	packModelVertices(model, model.packedVertices);
+	model.positions.clear();
+	model.positions.shrink_to_fit();
+	model.normals.clear();
+	model.normals.shrink_to_fit();
+	model.texcoords.clear();
+	model.texcoords.shrink_to_fit();
+}
+
+void weldVertices(Model& model) {
+	const size_t uVertexCount = model.vertexCount();
+	if (uVertexCount == 0) return;
+
+	std::unordered_map<SPackedVertexKey, uint32_t, SPackedVertexHash> mapUnique;
+	mapUnique.reserve(uVertexCount);
+	std::vector<uint32_t> vecRemap(uVertexCount, kUnassigned);
+	uint32_t uNextIndex = 0;
+	for (size_t i = 0; i < uVertexCount; ++i) {
+		SPackedVertexKey sKey{ model.packedVertices.data() + i * Model::kPackedVertexFloats };
+		auto result = mapUnique.emplace(sKey, uNextIndex);
+		if (result.second) {
+			++uNextIndex;
+		}
+		vecRemap[i] = result.first->second;
+	}
+	if (uNextIndex == uVertexCount) return;
+	remapVertices(model, vecRemap, uNextIndex);
+}
+
+void optimizeVertexFetch(Model& model) {
+	const size_t uVertexCount = model.vertexCount();
+	if (uVertexCount == 0) return;
+
+	std::vector<uint32_t> vecRemap(uVertexCount, kUnassigned);
+	uint32_t uNextIndex = 0;
+	for (uint32_t uIndex : model.indices) {
+		if (vecRemap[uIndex] == kUnassigned) {
+			vecRemap[uIndex] = uNextIndex++;
+		}
+	}
+	// Unreferenced vertices are dropped.
+	remapVertices(model, vecRemap, uNextIndex);
+}
+
+void buildMeshlets(Model& model) {
+	model.meshlets.clear();
+	model.meshletVertices.clear();
+	model.meshletTriangles.clear();
+
+	std::vector<uint8_t> vecLocalIndex(model.vertexCount(), 0xFF);
+	std::vector<uint32_t> vecVertices;
+	std::vector<uint8_t> vecTriangles;
+	vecVertices.reserve(kMeshletMaxVertices);
+	vecTriangles.reserve(kMeshletMaxTriangles * 3);
+
+	auto flush = [&]() {
+		if (!vecTriangles.empty()) {
+			appendMeshlet(model, vecVertices, vecTriangles);
+		}
+		for (uint32_t uVertex : vecVertices) {
+			vecLocalIndex[uVertex] = 0xFF;
+		}
+		vecVertices.clear();
+		vecTriangles.clear();
+	};
+
+	for (const Model::Subset& sSubset : model.subsets) {
+		const size_t uEnd = std::min(static_cast<size_t>(sSubset.indexOffset) + sSubset.indexCount, model.indices.size());
+		for (size_t i = sSubset.indexOffset; i + 3 <= uEnd; i += 3) {
+			const uint32_t auCorner[3] = { model.indices[i], model.indices[i + 1], model.indices[i + 2] };
+			size_t uNewVertices = 0;
+			for (uint32_t uCorner : auCorner) {
+				if (vecLocalIndex[uCorner] == 0xFF) ++uNewVertices;
+			}
+			if (vecVertices.size() + uNewVertices > kMeshletMaxVertices || vecTriangles.size() / 3 + 1 > kMeshletMaxTriangles) {
+				flush();
+			}
+			for (uint32_t uCorner : auCorner) {
+				if (vecLocalIndex[uCorner] == 0xFF) {
+					vecLocalIndex[uCorner] = static_cast<uint8_t>(vecVertices.size());
+					vecVertices.push_back(uCorner);
+				}
+				vecTriangles.push_back(vecLocalIndex[uCorner]);
+			}
+		}
+		// Meshlets never span subsets so each keeps a single material.
+		flush();
+	}
+}
+
+void optimizeModel(Model& model) {
+	packModelStreams(model);
+	weldVertices(model);
+	optimizeVertexFetch(model);
+	buildMeshlets(model);
+	computeModelBounds(model);
+}
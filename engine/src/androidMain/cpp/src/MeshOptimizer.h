@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+
+#include "Model.h"
+
+// Mesh processing run on every OBJ/glTF load (and so by the asset cooker before
+// a model is written in the cooked format). Every stage works on packedVertices, so callers run
+// packModelStreams first (optimizeModel does it for you).
+
+constexpr size_t kMeshletMaxVertices = 64;
+constexpr size_t kMeshletMaxTriangles = 124;
+
+// Moves the separate position/normal/texcoord streams into packedVertices.
+void packModelStreams(Model& model);
+
+// Merges bit-identical vertices and remaps the index buffer.
+void weldVertices(Model& model);
+
+// Reorders vertices by first use in the index buffer for better fetch locality.
+void optimizeVertexFetch(Model& model);
+
+// Splits each subset into clusters of at most kMeshletMaxVertices vertices and
+// kMeshletMaxTriangles triangles with a bounding sphere per cluster.
+void buildMeshlets(Model& model);
+
+// Runs all of the above and refreshes model.bounds.
+void optimizeModel(Model& model);
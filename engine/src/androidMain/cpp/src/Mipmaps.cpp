@@ -0,0 +1,159 @@
+#include "Mipmaps.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MIPMAPS_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MIPMAPS_SSE2 1
+#endif
+
+namespace {
+
+// Averages two 2x2 RGBA8 blocks (four source pixels per row) into two pixels.
+// Returns how many destination pixels were written.
+inline uint32_t downsampleTwoPixels(const uint8_t* pRow0, const uint8_t* pRow1, uint8_t* pDestination) {
+#if defined(MIPMAPS_NEON)
+	const uint8x16_t vRow0 = vld1q_u8(pRow0);
+	const uint8x16_t vRow1 = vld1q_u8(pRow1);
+	const uint16x8_t vLow = vaddl_u8(vget_low_u8(vRow0), vget_low_u8(vRow1));
+	const uint16x8_t vHigh = vaddl_u8(vget_high_u8(vRow0), vget_high_u8(vRow1));
+	const uint16x8_t vSum = vcombine_u16(
+		vadd_u16(vget_low_u16(vLow), vget_high_u16(vLow)),
+		vadd_u16(vget_low_u16(vHigh), vget_high_u16(vHigh)));
+	vst1_u8(pDestination, vmovn_u16(vrshrq_n_u16(vSum, 2)));
+	return 2;
+#elif defined(MIPMAPS_SSE2)
+	const __m128i vZero = _mm_setzero_si128();
+	const __m128i vRow0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRow0));
+	const __m128i vRow1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRow1));
+	const __m128i vLow = _mm_add_epi16(_mm_unpacklo_epi8(vRow0, vZero), _mm_unpacklo_epi8(vRow1, vZero));
+	const __m128i vHigh = _mm_add_epi16(_mm_unpackhi_epi8(vRow0, vZero), _mm_unpackhi_epi8(vRow1, vZero));
+	const __m128i vPairLow = _mm_add_epi16(vLow, _mm_srli_si128(vLow, 8));
+	const __m128i vPairHigh = _mm_add_epi16(vHigh, _mm_srli_si128(vHigh, 8));
+	__m128i vSum = _mm_unpacklo_epi64(vPairLow, vPairHigh);
+	vSum = _mm_srli_epi16(_mm_add_epi16(vSum, _mm_set1_epi16(2)), 2);
+	_mm_storel_epi64(reinterpret_cast<__m128i*>(pDestination), _mm_packus_epi16(vSum, vZero));
+	return 2;
+#else
+	(void)pRow0;
+	(void)pRow1;
+	(void)pDestination;
+	return 0;
+#endif
+}
+
+template <uint32_t C>
+void downscaleRowsToRgba8(const uint8_t* pSource, uint32_t uWidth, uint32_t uHeight, uint32_t uShift, uint8_t* pDestination) {
+	const uint32_t uDstWidth = std::max(uWidth >> uShift, 1u);
+	const uint32_t uDstHeight = std::max(uHeight >> uShift, 1u);
+	std::vector<uint32_t> vecSums(static_cast<size_t>(uDstWidth) * C);
+	for (uint32_t y = 0; y < uDstHeight; ++y) {
+		const uint32_t uRowBegin = y << uShift;
+		const uint32_t uRowEnd = std::min((y + 1) << uShift, uHeight);
+		std::fill(vecSums.begin(), vecSums.end(), 0u);
+		for (uint32_t uRow = uRowBegin; uRow < uRowEnd; ++uRow) {
+			const uint8_t* pPixel = pSource + static_cast<size_t>(uRow) * uWidth * C;
+			for (uint32_t x = 0; x < uDstWidth; ++x) {
+				const uint32_t uColumns = std::min((x + 1) << uShift, uWidth) - (x << uShift);
+				uint32_t* pSum = vecSums.data() + static_cast<size_t>(x) * C;
+				for (uint32_t i = 0; i < uColumns; ++i, pPixel += C) {
+					for (uint32_t c = 0; c < C; ++c) {
+						pSum[c] += pPixel[c];
+					}
+				}
+			}
+		}
+
+		uint8_t* pOut = pDestination + static_cast<size_t>(y) * uDstWidth * 4;
+		for (uint32_t x = 0; x < uDstWidth; ++x, pOut += 4) {
+			const uint32_t uCount = (uRowEnd - uRowBegin) * (std::min((x + 1) << uShift, uWidth) - (x << uShift));
+			uint8_t auValue[C];
+			for (uint32_t c = 0; c < C; ++c) {
+				auValue[c] = static_cast<uint8_t>((vecSums[static_cast<size_t>(x) * C + c] + uCount / 2) / uCount);
+			}
+			pOut[0] = auValue[0];
+			pOut[1] = C >= 3 ? auValue[1 % C] : auValue[0];
+			pOut[2] = C >= 3 ? auValue[2 % C] : auValue[0];
+			pOut[3] = C == 2 ? auValue[1 % C] : (C == 4 ? auValue[3 % C] : 255);
+		}
+	}
+}
+
+} // namespace
+
+void downscaleToRgba8(const uint8_t* pSource, uint32_t uWidth, uint32_t uHeight, uint32_t uChannels, uint32_t uShift, uint8_t* pDestination) {
+	switch (uChannels) {
+	case 1: downscaleRowsToRgba8<1>(pSource, uWidth, uHeight, uShift, pDestination); break;
+	case 2: downscaleRowsToRgba8<2>(pSource, uWidth, uHeight, uShift, pDestination); break;
+	case 3: downscaleRowsToRgba8<3>(pSource, uWidth, uHeight, uShift, pDestination); break;
+	default: downscaleRowsToRgba8<4>(pSource, uWidth, uHeight, uShift, pDestination); break;
+	}
+}
+
+uint32_t mipLevelCount(uint32_t uWidth, uint32_t uHeight) {
+	uint32_t uLevels = 1;
+	uint32_t uSize = std::max(uWidth, uHeight);
+	while (uSize > 1) {
+		uSize >>= 1;
+		++uLevels;
+	}
+	return uLevels;
+}
+
+size_t mipChainLayout(uint32_t uWidth, uint32_t uHeight, uint32_t uBytesPerPixel, std::vector<SMipLevel>& outLevels) {
+	const uint32_t uLevelCount = mipLevelCount(uWidth, uHeight);
+	outLevels.resize(uLevelCount);
+	size_t uOffset = 0;
+	for (uint32_t i = 0; i < uLevelCount; ++i) {
+		SMipLevel& sLevel = outLevels[i];
+		sLevel.uWidth = std::max(uWidth >> i, 1u);
+		sLevel.uHeight = std::max(uHeight >> i, 1u);
+		sLevel.uOffset = uOffset;
+		sLevel.uSize = static_cast<size_t>(sLevel.uWidth) * sLevel.uHeight * uBytesPerPixel;
+		// vkCmdCopyBufferToImage needs offsets aligned to the texel size and 4.
+		uOffset += (sLevel.uSize + 3) & ~size_t(3);
+	}
+	return uOffset;
+}
+
+void downsampleRgba8(const uint8_t* pSource, uint32_t uWidth, uint32_t uHeight, uint8_t* pDestination) {
+	const uint32_t uDstWidth = std::max(uWidth >> 1, 1u);
+	const uint32_t uDstHeight = std::max(uHeight >> 1, 1u);
+	const size_t uSrcStride = static_cast<size_t>(uWidth) * 4;
+	// Destination pixels whose 2x2 footprint lies fully inside the source.
+	const uint32_t uFullColumns = uWidth >> 1;
+
+	for (uint32_t y = 0; y < uDstHeight; ++y) {
+		const uint32_t uY0 = std::min(y * 2, uHeight - 1);
+		const uint32_t uY1 = std::min(y * 2 + 1, uHeight - 1);
+		const uint8_t* pRow0 = pSource + uY0 * uSrcStride;
+		const uint8_t* pRow1 = pSource + uY1 * uSrcStride;
+		uint8_t* pOut = pDestination + static_cast<size_t>(y) * uDstWidth * 4;
+
+		uint32_t x = 0;
+		while (x + 2 <= uFullColumns) {
+			const uint32_t uWritten = downsampleTwoPixels(pRow0 + x * 8, pRow1 + x * 8, pOut + x * 4);
+			if (uWritten == 0) break;
+			x += uWritten;
+		}
+		for (; x < uDstWidth; ++x) {
+			const uint32_t uX0 = std::min(x * 2, uWidth - 1) * 4;
+			const uint32_t uX1 = std::min(x * 2 + 1, uWidth - 1) * 4;
+			for (uint32_t c = 0; c < 4; ++c) {
+				const uint32_t uSum = pRow0[uX0 + c] + pRow0[uX1 + c] + pRow1[uX0 + c] + pRow1[uX1 + c];
+				pOut[x * 4 + c] = static_cast<uint8_t>((uSum + 2) >> 2);
+			}
+		}
+	}
+}
+
+void generateMipChainRgba8(uint8_t* pChain, const std::vector<SMipLevel>& vecLevels) {
+	for (size_t i = 1; i < vecLevels.size(); ++i) {
+		const SMipLevel& sSource = vecLevels[i - 1];
+		downsampleRgba8(pChain + sSource.uOffset, sSource.uWidth, sSource.uHeight, pChain + vecLevels[i].uOffset);
+	}
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct SMipLevel {
+	uint32_t uWidth = 0;
+	uint32_t uHeight = 0;
+	size_t uOffset = 0;
+	size_t uSize = 0;
+};
+
+// Number of levels in a full chain down to 1x1.
+uint32_t mipLevelCount(uint32_t uWidth, uint32_t uHeight);
+
+// Describes a tightly packed chain, level 0 first, and returns its total size.
+size_t mipChainLayout(uint32_t uWidth, uint32_t uHeight, uint32_t uBytesPerPixel, std::vector<SMipLevel>& outLevels);
+
+// Halves an RGBA8 image with a 2x2 box filter. Odd edges reuse the last
+// row/column.
+void downsampleRgba8(const uint8_t* pSource, uint32_t uWidth, uint32_t uHeight, uint8_t* pDestination);
+
+// Shrinks an 8-bit image with 1-4 channels by 2^uShift per side, averaging
+// each block, and writes it as RGBA8 (max(uWidth >> uShift, 1) wide). Source
+// pixels past the last full block are dropped, as in a mip chain.
+void downscaleToRgba8(const uint8_t* pSource, uint32_t uWidth, uint32_t uHeight, uint32_t uChannels, uint32_t uShift, uint8_t* pDestination);
+
+// Fills levels 1.. of an RGBA8 chain laid out by mipChainLayout. Level 0 must
+// already be in pChain.
+void generateMipChainRgba8(uint8_t* pChain, const std::vector<SMipLevel>& vecLevels);
@@ -13,6 +13,8 @@ struct Material {
 
 // Simple 3D model container for geometry, materials and transform.
 struct Model {
+	static constexpr size_t kPackedVertexFloats = 8;
+
 	std::vector<float> positions;        // xyz sequence
 	std::vector<float> normals;          // xyz sequence
 	std::vector<float> texcoords;        // uv sequence
@@ -24,6 +26,40 @@ struct Model {
 		uint16_t materialIndex = 0; // Index into materials vector
 	};
 	std::vector<Subset> subsets;
+
+	// Interleaved pos3/normal3/uv2 vertices ready for upload. Filled by the cooked
+	// loader instead of the separate streams above.
+	std::vector<float> packedVertices;
+
+	struct Bounds {
+		float min[3] = { 0.0f, 0.0f, 0.0f };
+		float max[3] = { 0.0f, 0.0f, 0.0f };
+	};
+	Bounds bounds;
+
+	// Optional reduced detail levels. Each level references a run of lodSubsets
+	// whose index ranges live in the shared indices vector after the base level.
+	struct Lod {
+		uint32_t subsetOffset = 0;
+		uint32_t subsetCount = 0;
+		float error = 0.0f;         // Object-space simplification error
+	};
+	std::vector<Lod> lods;
+	std::vector<Subset> lodSubsets;
+
+	// Optional meshlet clusters of the base level.
+	struct Meshlet {
+		uint32_t vertexOffset = 0;   // Into meshletVertices
+		uint32_t triangleOffset = 0; // Into meshletTriangles (3 bytes per triangle)
+		uint32_t vertexCount = 0;
+		uint32_t triangleCount = 0;
+		float center[3] = { 0.0f, 0.0f, 0.0f };
+		float radius = 0.0f;
+	};
+	std::vector<Meshlet> meshlets;
+	std::vector<uint32_t> meshletVertices;
+	std::vector<uint8_t> meshletTriangles;
+
 	float position[3] = { 0.0f, 0.0f, 0.0f }; // model translation
 	float scale = 1.0f;
 	float rotation[3] = { 0.0f, 0.0f, 0.0f };
@@ -45,6 +81,9 @@ struct Model {
 	}
 
 	size_t vertexCount() const {
+		if (positions.empty()) {
+			return packedVertices.size() / kPackedVertexFloats;
+		}
 		return positions.size() / 3;
 	}
 
@@ -57,7 +96,11 @@ struct Model {
 	}
 
 	bool hasGeometry() const {
-		return !positions.empty() && !indices.empty();
+		return (!positions.empty() || !packedVertices.empty()) && !indices.empty();
+	}
+
+	bool hasPackedVertices() const {
+		return !packedVertices.empty();
 	}
 
 	bool hasNormals() const {
@@ -0,0 +1,327 @@
+#include "ModelCache.h"
+#include "CookedModel.h"
+#include "Hash.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define LOG_TAG "ModelCache"
+#include "Log.h"
+
+namespace {
+
+constexpr uint32_t kEntryMagic = 0x45434D4Bu; // "KMCE"
+constexpr uint32_t kEntryVersion = 1;
+constexpr const char* kEntryExtension = ".kmc";
+
+// Bump when loader or optimizer output changes so stale entries stop matching.
+constexpr uint64_t kLoaderOptions = 1;
+// Likewise for the ETC2 encoder and the mip filter.
+constexpr uint64_t kTextureEncoderVersion = 1;
+constexpr uint64_t kTextureEntryTag = 0x5845544B; // "KTEX"
+
+struct SEntryHeader {
+	uint32_t uMagic;
+	uint32_t uVersion;
+	uint32_t uDependencyCount;
+	uint32_t uReserved;
+	uint64_t uKey;
+	uint64_t uCookedOffset;
+	uint64_t uCookedSize;
+};
+static_assert(sizeof(SEntryHeader) == 40, "Unexpected cache entry header size");
+
+// The path is part of the key: files with identical bytes in different
+// directories resolve different buffers, materials and textures.
+uint64_t computeKey(const std::string& strModelName, uint64_t uSourceHash) {
+	Hash64 hasher;
+	hasher.updateU64(strModelName.size());
+	hasher.update(strModelName.data(), strModelName.size());
+	hasher.updateU64(uSourceHash);
+	hasher.updateU64(kCookedModelVersion);
+	hasher.updateU64(kLoaderOptions);
+	return hasher.digest();
+}
+
+// Tagged so a texture and a model at the same path never share a key.
+uint64_t computeTextureKey(const std::string& strPath, uint64_t uSourceHash, uint64_t uSettings) {
+	Hash64 hasher;
+	hasher.updateU64(kTextureEntryTag);
+	hasher.updateU64(strPath.size());
+	hasher.update(strPath.data(), strPath.size());
+	hasher.updateU64(uSourceHash);
+	hasher.updateU64(uSettings);
+	hasher.updateU64(kTextureEncoderVersion);
+	return hasher.digest();
+}
+
+bool makeDirectories(const std::string& strPath) {
+	for (size_t uPos = 1; uPos <= strPath.size(); ++uPos) {
+		if (uPos != strPath.size() && strPath[uPos] != '/') continue;
+		const std::string strPrefix = strPath.substr(0, uPos);
+		if (mkdir(strPrefix.c_str(), 0700) != 0 && errno != EEXIST) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool endsWith(const std::string& strValue, const char* pSuffix) {
+	const size_t uLength = std::strlen(pSuffix);
+	return strValue.size() >= uLength && strValue.compare(strValue.size() - uLength, uLength, pSuffix) == 0;
+}
+
+} // namespace
+
+ModelCache& ModelCache::instance() {
+	static ModelCache sCache;
+	return sCache;
+}
+
+void ModelCache::configure(const std::string& strPath, uint64_t uLimit) {
+	std::lock_guard<std::mutex> lock(mutex);
+	strDirectory.clear();
+	uMaxBytes = uLimit;
+	if (strPath.empty()) return;
+	if (!makeDirectories(strPath)) {
+		LOGE("Failed to create cache directory %s: %s", strPath.c_str(), std::strerror(errno));
+		return;
+	}
+	strDirectory = strPath;
+	LOGI("Model cache at %s, limit %" PRIu64 " bytes", strDirectory.c_str(), uMaxBytes);
+}
+
+bool ModelCache::isEnabled() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return !strDirectory.empty();
+}
+
+std::string ModelCache::entryPath(uint64_t uKey) const {
+	char acName[32];
+	std::snprintf(acName, sizeof(acName), "%016" PRIx64, uKey);
+	return strDirectory + "/" + acName + kEntryExtension;
+}
+
+AssetData ModelCache::loadEntry(const AssetSource* pAssetSource, const std::string& strName, uint64_t uKey) {
+	std::string strPath;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (strDirectory.empty()) return AssetData();
+		strPath = entryPath(uKey);
+	}
+	const AssetData entry = mapFile(strPath);
+	if (!entry) return AssetData();
+
+	SEntryHeader sHeader {};
+	if (entry.size() < sizeof(sHeader)) return AssetData();
+	std::memcpy(&sHeader, entry.data(), sizeof(sHeader));
+	if (sHeader.uMagic != kEntryMagic || sHeader.uVersion != kEntryVersion || sHeader.uKey != uKey || sHeader.uDependencyCount == 0 ||
+		sHeader.uCookedOffset > entry.size() || sHeader.uCookedSize > entry.size() - sHeader.uCookedOffset) {
+		LOGW("Ignoring corrupt cache entry %s", strPath.c_str());
+		return AssetData();
+	}
+
+	size_t uCursor = sizeof(sHeader);
+	for (uint32_t i = 0; i < sHeader.uDependencyCount; ++i) {
+		uint64_t uHash = 0;
+		uint32_t uPathLength = 0;
+		if (uCursor + sizeof(uHash) + sizeof(uPathLength) > sHeader.uCookedOffset) return AssetData();
+		std::memcpy(&uHash, entry.data() + uCursor, sizeof(uHash));
+		std::memcpy(&uPathLength, entry.data() + uCursor + sizeof(uHash), sizeof(uPathLength));
+		uCursor += sizeof(uHash) + sizeof(uPathLength);
+		if (uCursor + uPathLength > sHeader.uCookedOffset) return AssetData();
+		const std::string strDependency(reinterpret_cast<const char*>(entry.data() + uCursor), uPathLength);
+		uCursor += uPathLength;
+		if (i == 0) {
+			// Entries are stored with the asset itself as first dependency.
+			if (strDependency != strName) return AssetData();
+			continue;
+		}
+		if (!pAssetSource) return AssetData();
+
+		const AssetData dependency = pAssetSource->open(strDependency);
+		if (!dependency || hash64(dependency.data(), dependency.size()) != uHash) {
+			LOGI("Cache entry for '%s' is stale: %s changed", strName.c_str(), strDependency.c_str());
+			return AssetData();
+		}
+	}
+
+	// The mtime doubles as the LRU timestamp.
+	utimensat(AT_FDCWD, strPath.c_str(), nullptr, 0);
+	return entry.slice(static_cast<size_t>(sHeader.uCookedOffset), static_cast<size_t>(sHeader.uCookedSize));
+}
+
+void ModelCache::writeEntry(const std::string& strName, uint64_t uKey, const std::vector<SDependency>& vecDependencies,
+	const std::vector<uint8_t>& vecPayload) {
+	std::vector<uint8_t> vecEntry(sizeof(SEntryHeader));
+	for (const SDependency& sDependency : vecDependencies) {
+		const uint32_t uPathLength = static_cast<uint32_t>(sDependency.strPath.size());
+		const size_t uOffset = vecEntry.size();
+		vecEntry.resize(uOffset + sizeof(sDependency.uHash) + sizeof(uPathLength) + uPathLength);
+		std::memcpy(vecEntry.data() + uOffset, &sDependency.uHash, sizeof(sDependency.uHash));
+		std::memcpy(vecEntry.data() + uOffset + sizeof(sDependency.uHash), &uPathLength, sizeof(uPathLength));
+		std::memcpy(vecEntry.data() + uOffset + sizeof(sDependency.uHash) + sizeof(uPathLength), sDependency.strPath.data(), uPathLength);
+	}
+	vecEntry.resize((vecEntry.size() + kCookedModelAlignment - 1) & ~(kCookedModelAlignment - 1), 0);
+
+	SEntryHeader sHeader {};
+	sHeader.uMagic = kEntryMagic;
+	sHeader.uVersion = kEntryVersion;
+	sHeader.uDependencyCount = static_cast<uint32_t>(vecDependencies.size());
+	sHeader.uKey = uKey;
+	sHeader.uCookedOffset = vecEntry.size();
+	sHeader.uCookedSize = vecPayload.size();
+	std::memcpy(vecEntry.data(), &sHeader, sizeof(sHeader));
+	vecEntry.insert(vecEntry.end(), vecPayload.begin(), vecPayload.end());
+
+	static std::atomic<uint32_t> s_uTempCounter{0};
+	std::string strPath;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (strDirectory.empty()) return;
+		strPath = entryPath(uKey);
+	}
+	// Other threads or processes may be cooking the same asset; each writes its
+	// own temp file and the rename makes whichever finishes last visible whole.
+	char acSuffix[48];
+	std::snprintf(acSuffix, sizeof(acSuffix), ".tmp.%d.%u", static_cast<int>(getpid()), s_uTempCounter.fetch_add(1));
+	const std::string strTempPath = strPath + acSuffix;
+
+	FILE* pFile = std::fopen(strTempPath.c_str(), "wb");
+	if (!pFile) {
+		LOGE("Failed to create cache entry %s: %s", strTempPath.c_str(), std::strerror(errno));
+		return;
+	}
+	const bool bWritten = std::fwrite(vecEntry.data(), 1, vecEntry.size(), pFile) == vecEntry.size();
+	const bool bClosed = std::fclose(pFile) == 0;
+	if (!bWritten || !bClosed || std::rename(strTempPath.c_str(), strPath.c_str()) != 0) {
+		LOGE("Failed to write cache entry %s", strPath.c_str());
+		std::remove(strTempPath.c_str());
+		return;
+	}
+	LOGI("Cached '%s' as %s (%zu bytes)", strName.c_str(), strPath.c_str(), vecEntry.size());
+	evictToLimit();
+}
+
+bool ModelCache::tryLoad(const AssetSource& assetSource, const std::string& strModelName, Model& outModel) {
+	if (!isEnabled()) return false;
+	const AssetData source = assetSource.open(strModelName);
+	if (!source) return false;
+	const AssetData cooked = loadEntry(&assetSource, strModelName, computeKey(strModelName, hash64(source.data(), source.size())));
+	if (!cooked) return false;
+	if (!readCookedModel(cooked.data(), cooked.size(), outModel)) {
+		LOGW("Ignoring unreadable cache entry for '%s'", strModelName.c_str());
+		return false;
+	}
+	return true;
+}
+
+void ModelCache::store(const std::string& strModelName, const std::vector<SDependency>& vecDependencies, const Model& model) {
+	if (vecDependencies.empty() || vecDependencies.front().strPath != strModelName) return;
+
+	std::vector<uint8_t> vecCooked;
+	if (!writeCookedModel(model, vecCooked)) return;
+	writeEntry(strModelName, computeKey(strModelName, vecDependencies.front().uHash), vecDependencies, vecCooked);
+}
+
+bool ModelCache::tryLoadTexture(const std::string& strPath, uint64_t uSourceHash, uint64_t uSettings,
+	const std::vector<uint32_t>& vecSupportedFormats, STextureData& outTexture, const TextureAllocator& allocator) {
+	const AssetData ktx = loadEntry(nullptr, strPath, computeTextureKey(strPath, uSourceHash, uSettings));
+	if (!ktx) return false;
+	if (!isKtx2(ktx.data(), ktx.size()) ||
+		!PrepareTextureFromMemory(ktx.data(), ktx.size(), vecSupportedFormats, outTexture, strPath, allocator)) {
+		LOGW("Ignoring unreadable cache entry for '%s'", strPath.c_str());
+		outTexture = STextureData();
+		return false;
+	}
+	return true;
+}
+
+void ModelCache::storeTexture(const std::string& strPath, uint64_t uSourceHash, uint64_t uSettings, const STextureData& texture) {
+	if (!isEnabled()) return;
+
+	std::vector<SKtx2LevelData> vecLevels(texture.vecLevels.size());
+	for (size_t i = 0; i < vecLevels.size(); ++i) {
+		const SMipLevel& sLevel = texture.vecLevels[i];
+		if (sLevel.uOffset + sLevel.uSize > texture.byteSize()) return;
+		vecLevels[i].uWidth = sLevel.uWidth;
+		vecLevels[i].uHeight = sLevel.uHeight;
+		vecLevels[i].vecBytes.assign(texture.bytes() + sLevel.uOffset, texture.bytes() + sLevel.uOffset + sLevel.uSize);
+	}
+	std::vector<uint8_t> vecKtx;
+	if (!writeKtx2(texture.uVkFormat, vecLevels, vecKtx)) return;
+	writeEntry(strPath, computeTextureKey(strPath, uSourceHash, uSettings), { { strPath, uSourceHash } }, vecKtx);
+}
+
+void ModelCache::evictToLimit() {
+	std::lock_guard<std::mutex> lock(mutex);
+	if (strDirectory.empty() || uMaxBytes == 0) return;
+
+	DIR* pDir = opendir(strDirectory.c_str());
+	if (!pDir) return;
+
+	struct SEntry {
+		std::string strPath;
+		uint64_t uSize;
+		time_t tAccess;
+	};
+	std::vector<SEntry> vecEntries;
+	uint64_t uTotalBytes = 0;
+	const time_t tNow = time(nullptr);
+	while (dirent* pEntry = readdir(pDir)) {
+		const std::string strName = pEntry->d_name;
+		const std::string strPath = strDirectory + "/" + strName;
+		struct stat sStat {};
+		if (stat(strPath.c_str(), &sStat) != 0 || !S_ISREG(sStat.st_mode)) continue;
+		if (endsWith(strName, kEntryExtension)) {
+			vecEntries.push_back({ strPath, static_cast<uint64_t>(sStat.st_size), sStat.st_mtime });
+			uTotalBytes += static_cast<uint64_t>(sStat.st_size);
+		} else if (strName.find(".tmp.") != std::string::npos && tNow - sStat.st_mtime > 3600) {
+			// Left behind by a writer that died before renaming.
+			std::remove(strPath.c_str());
+		}
+	}
+	closedir(pDir);
+
+	if (uTotalBytes <= uMaxBytes) return;
+	std::sort(vecEntries.begin(), vecEntries.end(), [](const SEntry& a, const SEntry& b) {
+		return a.tAccess < b.tAccess;
+	});
+	for (const SEntry& sEntry : vecEntries) {
+		if (uTotalBytes <= uMaxBytes) break;
+		if (std::remove(sEntry.strPath.c_str()) == 0) {
+			uTotalBytes -= sEntry.uSize;
+			LOGI("Evicted %s (%" PRIu64 " bytes)", sEntry.strPath.c_str(), sEntry.uSize);
+		}
+	}
+}
+
+AssetData HashingAssetSource::open(const std::string& strPath) const {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = mapOpened.find(strPath);
+		if (it != mapOpened.end()) return it->second;
+	}
+	AssetData data = inner.open(strPath);
+	if (!data) return data;
+	const uint64_t uHash = hash64(data.data(), data.size());
+	std::lock_guard<std::mutex> lock(mutex);
+	if (mapOpened.emplace(strPath, data).second) {
+		vecDependencies.push_back({ strPath, uHash });
+	}
+	return data;
+}
+
+std::vector<ModelCache::SDependency> HashingAssetSource::dependencies() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return vecDependencies;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "AssetSource.h"
+#include "ImageLoader.h"
+#include "Model.h"
+
+// On-disk cache of cooked models built from OBJ/glTF sources at runtime, and of
+// textures the load pipeline encoded to ETC2 (stored as KTX2).
+//
+// Entries are keyed by the XXH64 of the source file bytes and the loader
+// options and remember the hash of every extra file the load touched (MTL,
+// glTF buffers), so edits to any of them invalidate the entry. Writers use a
+// temp file plus rename so concurrent loads never observe partial entries. The
+// directory is capped in size with least-recently-used eviction by mtime.
+class ModelCache {
+public:
+	struct SDependency {
+		std::string strPath;
+		uint64_t uHash = 0;
+	};
+
+	static ModelCache& instance();
+
+	// An empty path disables the cache.
+	void configure(const std::string& strPath, uint64_t uLimit);
+	bool isEnabled() const;
+
+	// Returns true and fills outModel when a valid entry exists.
+	bool tryLoad(const AssetSource& assetSource, const std::string& strModelName, Model& outModel);
+
+	// vecDependencies must start with strModelName itself.
+	void store(const std::string& strModelName, const std::vector<SDependency>& vecDependencies, const Model& model);
+
+	// uSourceHash is the XXH64 of the encoded image and uSettings whatever else
+	// changes the encoder output. A hit is prepared like a cooked KTX2 file, so
+	// its levels land in allocator memory.
+	bool tryLoadTexture(const std::string& strPath, uint64_t uSourceHash, uint64_t uSettings,
+		const std::vector<uint32_t>& vecSupportedFormats, STextureData& outTexture, const TextureAllocator& allocator);
+	void storeTexture(const std::string& strPath, uint64_t uSourceHash, uint64_t uSettings, const STextureData& texture);
+
+private:
+	std::string entryPath(uint64_t uKey) const;
+	// Returns the payload of a valid, up to date entry, or an empty handle.
+	AssetData loadEntry(const AssetSource* pAssetSource, const std::string& strName, uint64_t uKey);
+	void writeEntry(const std::string& strName, uint64_t uKey, const std::vector<SDependency>& vecDependencies,
+		const std::vector<uint8_t>& vecPayload);
+	void evictToLimit();
+
+	mutable std::mutex mutex;
+	std::string strDirectory;
+	uint64_t uMaxBytes = 0;
+};
+
+// Forwards to another source and records the hash of every file opened, so the
+// cache can list a model's dependencies. Repeated opens reuse the first read.
+class HashingAssetSource : public AssetSource {
+public:
+	explicit HashingAssetSource(const AssetSource& source) : inner(source) {}
+
+	AssetData open(const std::string& strPath) const override;
+
+	std::vector<ModelCache::SDependency> dependencies() const;
+
+private:
+	const AssetSource& inner;
+	mutable std::mutex mutex;
+	mutable std::unordered_map<std::string, AssetData> mapOpened;
+	mutable std::vector<ModelCache::SDependency> vecDependencies;
+};
@@ -1,7 +1,7 @@
 #include "ModelLoader.h"
-
-#include <android/log.h>
-#include <android/asset_manager.h>
+#include "CookedModel.h"
+#include "MeshOptimizer.h"
+#include "ModelCache.h"
 
 #include <algorithm>
 #include <array>
@@ -22,9 +22,7 @@
 #include "cgltf.h"
 
 #define LOG_TAG "ModelLoader"
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
-#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, LOG_TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#include "Log.h"
 
 namespace {
 
@@ -60,29 +58,12 @@ std::string trim(const std::string& value) {
 	return std::string(begin, end);
 }
 
-std::string readAssetFile(AAssetManager* manager, const std::string& path) {
-	if (!manager) return {};
-	AAsset* asset = AAssetManager_open(manager, path.c_str(), AASSET_MODE_STREAMING);
-	if (!asset) {
-		LOGE("Failed to open asset: %s", path.c_str());
-		return {};
-	}
-	off_t length = AAsset_getLength(asset);
-	if (length <= 0) {
-		AAsset_close(asset);
+std::string readAssetFile(const AssetSource& source, const std::string& path) {
+	const AssetData data = source.open(path);
+	if (!data) {
 		return {};
 	}
-	std::string contents(static_cast<size_t>(length), '\0');
-	int64_t read = AAsset_read(asset, contents.data(), length);
-	AAsset_close(asset);
-	if (read < 0) {
-		LOGE("Failed to read asset: %s", path.c_str());
-		return {};
-	}
-	if (read != length) {
-		contents.resize(static_cast<size_t>(read));
-	}
-	return contents;
+	return std::string(data.view());
 }
 
 std::string directoryOf(const std::string& path) {
@@ -434,7 +415,7 @@ void parseMtlContents(const std::string& mtlText, const std::string& baseDir, Mo
 }
 
 struct SAssetFileContext {
-	AAssetManager* pAssetManager = nullptr;
+	const AssetSource* pAssetSource = nullptr;
 	std::string strBasePath;
 };
 
@@ -447,12 +428,12 @@ cgltf_result assetFileRead(const cgltf_memory_options* pMemoryOptions,
 		return cgltf_result_invalid_options;
 	}
 	const SAssetFileContext* pContext = static_cast<const SAssetFileContext*>(pFileOptions->user_data);
-	if (!pContext || !pContext->pAssetManager || path == nullptr) {
+	if (!pContext || !pContext->pAssetSource || path == nullptr) {
 		return cgltf_result_io_error;
 	}
 	std::string strAssetPath(path);
 	const std::string strResolvedPath = resolveAssetUri(pContext->strBasePath, strAssetPath);
-	const std::string strFileData = readAssetFile(pContext->pAssetManager, strResolvedPath);
+	const std::string strFileData = readAssetFile(*pContext->pAssetSource, strResolvedPath);
 	if (strFileData.empty()) {
 		return cgltf_result_file_not_found;
 	}
@@ -655,18 +636,14 @@ void processGltfNodeTree(const cgltf_node* pNode,
 
 } // namespace
 
-static Model loadObjModelInternal(AAssetManager* assetManager, const std::string& modelName) {
+static Model loadObjModelInternal(const AssetSource& assetSource, const std::string& modelName, const MaterialsCallback& onMaterials) {
 	Model model;
-	if (!assetManager) {
-		LOGE("loadObjModelInternal called with null asset manager");
-		return model;
-	}
 	if (modelName.empty()) {
 		LOGE("Model name is empty");
 		return model;
 	}
 
-	const std::string objText = readAssetFile(assetManager, modelName);
+	const std::string objText = readAssetFile(assetSource, modelName);
 	if (objText.empty()) {
 		LOGE("OBJ asset is empty: %s", modelName.c_str());
 		return model;
@@ -708,13 +685,16 @@ static Model loadObjModelInternal(AAssetManager* assetManager, const std::string
 			std::string mtlFile;
 			while (libs >> mtlFile) {
 				const std::string mtlPath = joinPaths(baseDir, mtlFile);
-				const std::string mtlText = readAssetFile(assetManager, mtlPath);
+				const std::string mtlText = readAssetFile(assetSource, mtlPath);
 				if (mtlText.empty()) {
 					LOGE("Failed to read MTL file: %s", mtlPath.c_str());
 					continue;
 				}
 				parseMtlContents(mtlText, baseDir, model, materialLookup);
 			}
+			if (onMaterials) {
+				onMaterials(model.materials);
+			}
 		} else if (keyword == "usemtl") {
 			if (!remainder.empty()) {
 				currentMaterialIndex = ensureMaterial(model, remainder, materialLookup);
@@ -834,21 +814,17 @@ static Model loadObjModelInternal(AAssetManager* assetManager, const std::string
 	return model;
 }
 
-static Model loadGltfModelInternal(AAssetManager* pAssetManager, const std::string& strModelName) {
+static Model loadGltfModelInternal(const AssetSource& assetSource, const std::string& strModelName, const MaterialsCallback& onMaterials) {
 	using Clock = std::chrono::steady_clock;
 	const Clock::time_point tStart = Clock::now();
 	Model sModel;
-	if (!pAssetManager) {
-		LOGE("loadGltfModelInternal called with null asset manager");
-		return sModel;
-	}
 	if (strModelName.empty()) {
 		LOGE("Model name is empty");
 		return sModel;
 	}
 
 	const Clock::time_point tReadStart = Clock::now();
-	const std::string strGltfText = readAssetFile(pAssetManager, strModelName);
+	const std::string strGltfText = readAssetFile(assetSource, strModelName);
 	const Clock::time_point tReadEnd = Clock::now();
 	if (strGltfText.empty()) {
 		const double readMs = std::chrono::duration<double, std::milli>(tReadEnd - tReadStart).count();
@@ -859,7 +835,7 @@ static Model loadGltfModelInternal(AAssetManager* pAssetManager, const std::stri
 	const std::string strBaseDir = directoryOf(strModelName);
 
 	SAssetFileContext sFileContext;
-	sFileContext.pAssetManager = pAssetManager;
+	sFileContext.pAssetSource = &assetSource;
 	sFileContext.strBasePath = strBaseDir;
 
 	cgltf_options sOptions{};
@@ -991,6 +967,9 @@ static Model loadGltfModelInternal(AAssetManager* pAssetManager, const std::stri
 		sModel.materials.push_back(sDefaultMaterial);
 		mapMaterialByName["Default"] = 0;
 	}
+	if (onMaterials) {
+		onMaterials(sModel.materials);
+	}
 
 	sModel.subsets.clear();
 
@@ -1047,42 +1026,83 @@ static Model loadGltfModelInternal(AAssetManager* pAssetManager, const std::stri
 	return sModel;
 }
 
-Model loadModel(AAssetManager* pAssetManager, const std::string& strModelName) {
-	const auto startTime = std::chrono::high_resolution_clock::now();
-	if (!pAssetManager) {
-		LOGE("loadModel called with null asset manager");
+static Model loadCookedModelInternal(const AssetSource& assetSource, const std::string& strModelName) {
+	const AssetData data = assetSource.open(strModelName);
+	Model sModel;
+	if (!data || !readCookedModel(data.data(), data.size(), sModel)) {
+		LOGE("Failed to read cooked model: %s", strModelName.c_str());
 		return {};
 	}
+	LOGI("Loaded cooked model '%s': %zu vertices, %zu triangles, %zu materials, %zu lods, %zu meshlets",
+		strModelName.c_str(),
+		sModel.vertexCount(),
+		sModel.triangleCount(),
+		sModel.materials.size(),
+		sModel.lods.size(),
+		sModel.meshlets.size());
+	return sModel;
+}
+
+// Lowercase extension including the dot, or empty when there is none.
+static std::string modelExtension(const std::string& strModelName) {
+	const std::string::size_type uDotPos = strModelName.find_last_of('.');
+	if (uDotPos == std::string::npos) return {};
+	std::string strExtension = strModelName.substr(uDotPos);
+	std::transform(strExtension.begin(), strExtension.end(), strExtension.begin(), [](unsigned char ch) {
+		return static_cast<char>(std::tolower(ch));
+	});
+	return strExtension;
+}
+
+Model loadModel(const AssetSource& assetSource, const std::string& strModelName, const MaterialsCallback& onMaterials) {
+	const auto startTime = std::chrono::high_resolution_clock::now();
 	if (strModelName.empty()) {
 		LOGE("Model name is empty");
 		return {};
 	}
 
-	std::string strNormalizedName = strModelName;
-	std::transform(strNormalizedName.begin(), strNormalizedName.end(), strNormalizedName.begin(), [](unsigned char ch) {
-		return static_cast<char>(std::tolower(ch));
-	});
+	const std::string strExtension = modelExtension(strModelName);
 
-	std::string strExtension;
-	const std::string::size_type uDotPos = strNormalizedName.find_last_of('.');
-	if (uDotPos != std::string::npos) {
-		strExtension = strNormalizedName.substr(uDotPos);
-	}
+	if (strExtension == ".obj" || strExtension == ".gltf") {
+		const auto sourceStart = std::chrono::high_resolution_clock::now();
+		const bool bCacheEnabled = ModelCache::instance().isEnabled();
+		// Shared by the lookup and the fallback load so each file is read once.
+		const HashingAssetSource recordingSource(assetSource);
+		const AssetSource& loadSource = bCacheEnabled ? static_cast<const AssetSource&>(recordingSource) : assetSource;
+		Model cached;
+		if (bCacheEnabled && ModelCache::instance().tryLoad(recordingSource, strModelName, cached)) {
+			if (onMaterials) {
+				onMaterials(cached.materials);
+			}
+			const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - sourceStart).count();
+			LOGI("loadModel: '%s' served from cache in %.2f ms", strModelName.c_str(), milliseconds);
+			return cached;
+		}
 
-	if (strExtension == ".obj") {
-		const auto objStart = std::chrono::high_resolution_clock::now();
-		Model model = loadObjModelInternal(pAssetManager, strModelName);
-		const auto objEnd = std::chrono::high_resolution_clock::now();
-		const double milliseconds = std::chrono::duration<double, std::milli>(objEnd - objStart).count();
-		LOGI("loadModel: OBJ '%s' finished in %.2f ms", strModelName.c_str(), milliseconds);
+		Model model = strExtension == ".obj" ? loadObjModelInternal(loadSource, strModelName, onMaterials)
+			: loadGltfModelInternal(loadSource, strModelName, onMaterials);
+		// Optimized with or without the cache, so an asset always yields the
+		// same vertex and index buffers.
+		if (model.hasGeometry()) {
+			optimizeModel(model);
+			if (bCacheEnabled) {
+				ModelCache::instance().store(strModelName, recordingSource.dependencies(), model);
+			}
+		}
+		const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - sourceStart).count();
+		LOGI("loadModel: '%s' loaded%s in %.2f ms", strModelName.c_str(), bCacheEnabled ? " and cached" : "", milliseconds);
 		return model;
 	}
-	if (strExtension == ".gltf") {
-		const auto gltfStart = std::chrono::high_resolution_clock::now();
-		Model model = loadGltfModelInternal(pAssetManager, strModelName);
-		const auto gltfEnd = std::chrono::high_resolution_clock::now();
-		const double milliseconds = std::chrono::duration<double, std::milli>(gltfEnd - gltfStart).count();
-		LOGI("loadModel: glTF '%s' finished in %.2f ms", strModelName.c_str(), milliseconds);
+
+	if (strExtension == kCookedModelExtension) {
+		const auto cookedStart = std::chrono::high_resolution_clock::now();
+		Model model = loadCookedModelInternal(assetSource, strModelName);
+		if (onMaterials && model.hasGeometry()) {
+			onMaterials(model.materials);
+		}
+		const auto cookedEnd = std::chrono::high_resolution_clock::now();
+		const double milliseconds = std::chrono::duration<double, std::milli>(cookedEnd - cookedStart).count();
+		LOGI("loadModel: cooked '%s' finished in %.2f ms", strModelName.c_str(), milliseconds);
 		return model;
 	}
 
@@ -1094,3 +1114,67 @@ Model loadModel(AAssetManager* pAssetManager, const std::string& strModelName) {
 }
 
 
+
+void benchmarkModelLoaders(const AssetSource& assetSource, const std::vector<std::string>& vecModelNames, int nIterations,
+	const std::atomic<bool>* pCancel) {
+	using Clock = std::chrono::high_resolution_clock;
+	if (nIterations <= 0) return;
+	const auto cancelled = [pCancel]() { return pCancel && pCancel->load(std::memory_order_relaxed); };
+
+	for (const std::string& strModelName : vecModelNames) {
+		const std::string strExtension = modelExtension(strModelName);
+		if (strExtension != ".obj" && strExtension != ".gltf") {
+			LOGW("benchmark: '%s' is not a source model, skipping", strModelName.c_str());
+			continue;
+		}
+		const std::string strCookedName = strModelName.substr(0, strModelName.size() - strExtension.size()) + kCookedModelExtension;
+		const AssetData cookedData = assetSource.open(strCookedName);
+		if (!cookedData) {
+			LOGW("benchmark: '%s' has no cooked asset '%s', run asset_cooker first", strModelName.c_str(), strCookedName.c_str());
+			continue;
+		}
+		const size_t uCookedSize = cookedData.size();
+
+		// Both loops open, read and parse through the same source; the source
+		// loaders are called directly so ModelCache cannot serve the model.
+		Model sSource;
+		double sourceTotalMs = 0.0;
+		for (int i = 0; i < nIterations; ++i) {
+			if (cancelled()) return;
+			const Clock::time_point tStart = Clock::now();
+			sSource = strExtension == ".obj" ? loadObjModelInternal(assetSource, strModelName, {})
+				: loadGltfModelInternal(assetSource, strModelName, {});
+			sourceTotalMs += std::chrono::duration<double, std::milli>(Clock::now() - tStart).count();
+		}
+		if (!sSource.hasGeometry()) {
+			LOGW("benchmark: '%s' produced no geometry, skipping", strModelName.c_str());
+			continue;
+		}
+
+		double cookedTotalMs = 0.0;
+		for (int i = 0; i < nIterations; ++i) {
+			if (cancelled()) return;
+			const Clock::time_point tStart = Clock::now();
+			const Model sCooked = loadCookedModelInternal(assetSource, strCookedName);
+			cookedTotalMs += std::chrono::duration<double, std::milli>(Clock::now() - tStart).count();
+			if (!sCooked.hasGeometry()) {
+				cookedTotalMs = -1.0;
+				break;
+			}
+		}
+		if (cookedTotalMs < 0.0) {
+			LOGW("benchmark: failed to read cooked '%s', skipping", strCookedName.c_str());
+			continue;
+		}
+
+		const double sourceMs = sourceTotalMs / nIterations;
+		const double cookedMs = cookedTotalMs / nIterations;
+		LOGI("benchmark '%s': source %.3f ms, cooked %.3f ms (%.1fx), cooked size %zu bytes, %d iterations",
+			strModelName.c_str(),
+			sourceMs,
+			cookedMs,
+			cookedMs > 0.0 ? sourceMs / cookedMs : 0.0,
+			uCookedSize,
+			nIterations);
+	}
+}
@@ -1,10 +1,22 @@
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <string>
-#include <android/asset_manager.h>
+#include <vector>
 
+#include "AssetSource.h"
 #include "Model.h"
 
-Model loadModel(AAssetManager* assetManager, const std::string& modelName);
+// Called as soon as the material table is known, before geometry is built, so
+// texture loading can start early. It may run more than once for OBJ files with
+// several MTL libraries; each call receives the full table so far.
+using MaterialsCallback = std::function<void(const std::vector<Material>&)>;
 
+Model loadModel(const AssetSource& assetSource, const std::string& modelName, const MaterialsCallback& onMaterials = {});
 
+// Compares average load times of each source model (bypassing the model cache)
+// against its cooked sibling written by asset_cooker, both opened through
+// assetSource. Results are logged; pCancel is polled between iterations.
+void benchmarkModelLoaders(const AssetSource& assetSource, const std::vector<std::string>& modelNames, int iterations,
+	const std::atomic<bool>* pCancel = nullptr);
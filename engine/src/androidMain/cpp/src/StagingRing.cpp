@@ -0,0 +1,71 @@
+#include "StagingRing.h"
+
+StagingBlock::StagingBlock(std::shared_ptr<StagingRing> pOwner, unsigned char* pBytes, size_t uBlockOffset, size_t uBlockSize)
+	: pRing(std::move(pOwner)),
+	  pData(pBytes),
+	  uOffset(uBlockOffset),
+	  uSize(uBlockSize) {}
+
+StagingBlock::~StagingBlock() {
+	pRing->release(uOffset);
+}
+
+StagingRing::StagingRing(void* pMapped, size_t uRingCapacity)
+	: pBase(static_cast<unsigned char*>(pMapped)),
+	  uCapacity(uRingCapacity & ~(kAlignment - 1)) {}
+
+std::shared_ptr<StagingRing> StagingRing::create(void* pMapped, size_t uCapacity) {
+	return std::shared_ptr<StagingRing>(new StagingRing(pMapped, uCapacity));
+}
+
+std::shared_ptr<StagingBlock> StagingRing::allocate(size_t uSize) {
+	const size_t uReserved = (uSize + kAlignment - 1) & ~(kAlignment - 1);
+	if (uReserved == 0 || uReserved > uCapacity) return nullptr;
+
+	size_t uOffset = 0;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!deqRanges.empty()) {
+			const size_t uTail = deqRanges.front().uOffset;
+			const size_t uHead = deqRanges.back().uOffset + deqRanges.back().uSize;
+			if (deqRanges.back().uOffset >= uTail) {
+				// Live ranges are contiguous: free space is after the head and
+				// before the tail.
+				if (uCapacity - uHead >= uReserved) {
+					uOffset = uHead;
+				} else if (uTail >= uReserved) {
+					uOffset = 0;
+				} else {
+					return nullptr;
+				}
+			} else if (uTail - uHead >= uReserved) {
+				uOffset = uHead;
+			} else {
+				return nullptr;
+			}
+		}
+		deqRanges.push_back(SRange{ uOffset, uReserved, false });
+	}
+	return std::shared_ptr<StagingBlock>(new StagingBlock(shared_from_this(), pBase + uOffset, uOffset, uSize));
+}
+
+size_t StagingRing::usedBytes() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	if (deqRanges.empty()) return 0;
+	const size_t uTail = deqRanges.front().uOffset;
+	const size_t uHead = deqRanges.back().uOffset + deqRanges.back().uSize;
+	return uHead > uTail ? uHead - uTail : uCapacity - uTail + uHead;
+}
+
+void StagingRing::release(size_t uOffset) {
+	std::lock_guard<std::mutex> lock(mutex);
+	for (SRange& sRange : deqRanges) {
+		if (sRange.uOffset == uOffset && !sRange.bReleased) {
+			sRange.bReleased = true;
+			break;
+		}
+	}
+	while (!deqRanges.empty() && deqRanges.front().bReleased) {
+		deqRanges.pop_front();
+	}
+}
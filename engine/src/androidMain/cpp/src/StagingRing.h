@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+class StagingRing;
+
+// A range of a StagingRing. Its space goes back to the ring when the block is
+// destroyed, so holders keep it alive until the GPU has finished reading.
+class StagingBlock {
+public:
+	~StagingBlock();
+
+	StagingBlock(const StagingBlock&) = delete;
+	StagingBlock& operator=(const StagingBlock&) = delete;
+
+	unsigned char* data() const { return pData; }
+	size_t size() const { return uSize; }
+	// Byte offset from the start of the ring's buffer.
+	size_t offset() const { return uOffset; }
+
+private:
+	friend class StagingRing;
+	StagingBlock(std::shared_ptr<StagingRing> pOwner, unsigned char* pBytes, size_t uBlockOffset, size_t uBlockSize);
+
+	std::shared_ptr<StagingRing> pRing;
+	unsigned char* pData = nullptr;
+	size_t uOffset = 0;
+	size_t uSize = 0;
+};
+
+// Hands out blocks of a persistently mapped buffer in FIFO order. Blocks may be
+// released in any order; their space is reclaimed once every older block has
+// been released too. Safe to use from several threads.
+class StagingRing : public std::enable_shared_from_this<StagingRing> {
+public:
+	static constexpr size_t kAlignment = 16;
+
+	static std::shared_ptr<StagingRing> create(void* pMapped, size_t uCapacity);
+
+	// Returns null when the ring has no room, so callers fall back to heap
+	// memory instead of waiting for the GPU.
+	std::shared_ptr<StagingBlock> allocate(size_t uSize);
+
+	size_t capacity() const { return uCapacity; }
+	size_t usedBytes() const;
+
+private:
+	struct SRange {
+		size_t uOffset;
+		size_t uSize;
+		bool bReleased;
+	};
+
+	StagingRing(void* pMapped, size_t uCapacity);
+	void release(size_t uOffset);
+
+	friend class StagingBlock;
+
+	unsigned char* pBase = nullptr;
+	size_t uCapacity = 0;
+	mutable std::mutex mutex;
+	std::deque<SRange> deqRanges;
+};
@@ -0,0 +1,199 @@
+#include "TlsfAllocator.h"
+
+namespace {
+
+inline uint32_t highestBit(uint64_t uValue) {
+	return 63 - static_cast<uint32_t>(__builtin_clzll(uValue));
+}
+
+inline uint32_t lowestBit(uint64_t uValue) {
+	return static_cast<uint32_t>(__builtin_ctzll(uValue));
+}
+
+} // namespace
+
+TlsfAllocator::TlsfAllocator(uint64_t uSize) : uTotalSize(uSize) {
+	for (auto& aHeads : aFreeHeads) {
+		for (uint32_t& uHead : aHeads) {
+			uHead = kNone;
+		}
+	}
+	if (uSize == 0) return;
+	const uint32_t uRange = newRange();
+	vecRanges[uRange].uSize = uSize;
+	insertFree(uRange);
+}
+
+// Sizes below kSecondLevelCount get a class each; larger ones are split into
+// kSecondLevelCount linear classes per power of two.
+void TlsfAllocator::mapping(uint64_t uSize, uint32_t& uFirst, uint32_t& uSecond) {
+	if (uSize < kSecondLevelCount) {
+		uFirst = 0;
+		uSecond = static_cast<uint32_t>(uSize);
+		return;
+	}
+	const uint32_t uBit = highestBit(uSize);
+	uFirst = uBit - kSecondLevelBits + 1;
+	uSecond = static_cast<uint32_t>(uSize >> (uBit - kSecondLevelBits)) - kSecondLevelCount;
+}
+
+// Rounds the request up to the next class boundary, so every range in the
+// class found is large enough.
+uint32_t TlsfAllocator::findFreeRange(uint64_t uSize) const {
+	if (uSize >= kSecondLevelCount) {
+		const uint64_t uRound = (uint64_t(1) << (highestBit(uSize) - kSecondLevelBits)) - 1;
+		if (uSize > UINT64_MAX - uRound) return kNone;
+		uSize += uRound;
+	}
+	uint32_t uFirst = 0;
+	uint32_t uSecond = 0;
+	mapping(uSize, uFirst, uSecond);
+	if (uFirst >= kFirstLevelCount) return kNone;
+
+	uint32_t uSecondMap = aSecondLevelMap[uFirst] & (~0u << uSecond);
+	if (uSecondMap == 0) {
+		const uint64_t uFirstMap = uFirst + 1 < 64 ? uFirstLevelMap & (~uint64_t(0) << (uFirst + 1)) : 0;
+		if (uFirstMap == 0) return kNone;
+		uFirst = lowestBit(uFirstMap);
+		uSecondMap = aSecondLevelMap[uFirst];
+	}
+	return aFreeHeads[uFirst][lowestBit(uSecondMap)];
+}
+
+uint64_t TlsfAllocator::allocate(uint64_t uSize, uint64_t uAlignment) {
+	if (uSize == 0) uSize = 1;
+	if (uAlignment == 0) uAlignment = 1;
+	auto fits = [&](uint32_t uRange) {
+		const SRange& sRange = vecRanges[uRange];
+		const uint64_t uPadding = ((sRange.uOffset + uAlignment - 1) & ~(uAlignment - 1)) - sRange.uOffset;
+		return uPadding <= sRange.uSize && uSize <= sRange.uSize - uPadding;
+	};
+	uint32_t uRange = findFreeRange(uSize);
+	if (uRange == kNone || !fits(uRange)) {
+		// Any range of this class can hold the request at any alignment.
+		uRange = uAlignment > 1 && uSize <= UINT64_MAX - uAlignment ? findFreeRange(uSize + uAlignment - 1) : kNone;
+		if (uRange == kNone) return kInvalidOffset;
+	}
+	removeFree(uRange);
+
+	const uint64_t uPadding = ((vecRanges[uRange].uOffset + uAlignment - 1) & ~(uAlignment - 1)) - vecRanges[uRange].uOffset;
+	if (uPadding > 0) {
+		insertFree(splitFront(uRange, uPadding));
+	}
+	if (vecRanges[uRange].uSize > uSize) {
+		const uint32_t uAllocated = splitFront(uRange, uSize);
+		insertFree(uRange);
+		uRange = uAllocated;
+	}
+	SRange& sRange = vecRanges[uRange];
+	sRange.bFree = false;
+	uUsedBytes += sRange.uSize;
+	mapAllocated[sRange.uOffset] = uRange;
+	return sRange.uOffset;
+}
+
+void TlsfAllocator::free(uint64_t uOffset) {
+	auto it = mapAllocated.find(uOffset);
+	if (it == mapAllocated.end()) return;
+	uint32_t uRange = it->second;
+	mapAllocated.erase(it);
+	uUsedBytes -= vecRanges[uRange].uSize;
+
+	const uint32_t uNext = vecRanges[uRange].uNextPhysical;
+	if (uNext != kNone && vecRanges[uNext].bFree) {
+		removeFree(uNext);
+		mergeWithNext(uRange);
+	}
+	const uint32_t uPrev = vecRanges[uRange].uPrevPhysical;
+	if (uPrev != kNone && vecRanges[uPrev].bFree) {
+		removeFree(uPrev);
+		mergeWithNext(uPrev);
+		uRange = uPrev;
+	}
+	insertFree(uRange);
+}
+
+void TlsfAllocator::insertFree(uint32_t uRange) {
+	SRange& sRange = vecRanges[uRange];
+	uint32_t uFirst = 0;
+	uint32_t uSecond = 0;
+	mapping(sRange.uSize, uFirst, uSecond);
+	uint32_t& uHead = aFreeHeads[uFirst][uSecond];
+	sRange.bFree = true;
+	sRange.uPrevFree = kNone;
+	sRange.uNextFree = uHead;
+	if (uHead != kNone) {
+		vecRanges[uHead].uPrevFree = uRange;
+	}
+	uHead = uRange;
+	aSecondLevelMap[uFirst] |= 1u << uSecond;
+	uFirstLevelMap |= uint64_t(1) << uFirst;
+}
+
+void TlsfAllocator::removeFree(uint32_t uRange) {
+	SRange& sRange = vecRanges[uRange];
+	uint32_t uFirst = 0;
+	uint32_t uSecond = 0;
+	mapping(sRange.uSize, uFirst, uSecond);
+	if (sRange.uPrevFree != kNone) {
+		vecRanges[sRange.uPrevFree].uNextFree = sRange.uNextFree;
+	} else {
+		aFreeHeads[uFirst][uSecond] = sRange.uNextFree;
+	}
+	if (sRange.uNextFree != kNone) {
+		vecRanges[sRange.uNextFree].uPrevFree = sRange.uPrevFree;
+	}
+	if (aFreeHeads[uFirst][uSecond] == kNone) {
+		aSecondLevelMap[uFirst] &= ~(1u << uSecond);
+		if (aSecondLevelMap[uFirst] == 0) {
+			uFirstLevelMap &= ~(uint64_t(1) << uFirst);
+		}
+	}
+	sRange.bFree = false;
+	sRange.uPrevFree = kNone;
+	sRange.uNextFree = kNone;
+}
+
+uint32_t TlsfAllocator::newRange() {
+	if (!vecUnusedRanges.empty()) {
+		const uint32_t uRange = vecUnusedRanges.back();
+		vecUnusedRanges.pop_back();
+		vecRanges[uRange] = SRange{};
+		return uRange;
+	}
+	vecRanges.emplace_back();
+	return static_cast<uint32_t>(vecRanges.size() - 1);
+}
+
+void TlsfAllocator::releaseRange(uint32_t uRange) {
+	vecUnusedRanges.push_back(uRange);
+}
+
+uint32_t TlsfAllocator::splitFront(uint32_t uRange, uint64_t uSize) {
+	const uint32_t uFront = newRange();
+	SRange& sFront = vecRanges[uFront];
+	SRange& sRange = vecRanges[uRange];
+	sFront.uOffset = sRange.uOffset;
+	sFront.uSize = uSize;
+	sFront.uPrevPhysical = sRange.uPrevPhysical;
+	sFront.uNextPhysical = uRange;
+	if (sRange.uPrevPhysical != kNone) {
+		vecRanges[sRange.uPrevPhysical].uNextPhysical = uFront;
+	}
+	sRange.uPrevPhysical = uFront;
+	sRange.uOffset += uSize;
+	sRange.uSize -= uSize;
+	return uFront;
+}
+
+void TlsfAllocator::mergeWithNext(uint32_t uRange) {
+	const uint32_t uNext = vecRanges[uRange].uNextPhysical;
+	SRange& sRange = vecRanges[uRange];
+	const SRange& sNext = vecRanges[uNext];
+	sRange.uSize += sNext.uSize;
+	sRange.uNextPhysical = sNext.uNextPhysical;
+	if (sNext.uNextPhysical != kNone) {
+		vecRanges[sNext.uNextPhysical].uPrevPhysical = uRange;
+	}
+	releaseRange(uNext);
+}
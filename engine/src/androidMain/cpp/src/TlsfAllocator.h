@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Two-level segregated fit placement of ranges in a fixed-size span (a device
+// memory block). Free ranges are bucketed by size class, so finding a fit and
+// freeing (with coalescing of neighbours) take constant time. Only offsets are
+// managed; the caller owns the memory. Not thread-safe.
+class TlsfAllocator {
+public:
+	static constexpr uint64_t kInvalidOffset = UINT64_MAX;
+
+	explicit TlsfAllocator(uint64_t uSize);
+
+	TlsfAllocator(const TlsfAllocator&) = delete;
+	TlsfAllocator& operator=(const TlsfAllocator&) = delete;
+
+	// uAlignment must be a power of two. Returns kInvalidOffset when no free
+	// range can hold the request.
+	uint64_t allocate(uint64_t uSize, uint64_t uAlignment);
+	// uOffset must come from allocate().
+	void free(uint64_t uOffset);
+
+	uint64_t size() const { return uTotalSize; }
+	uint64_t usedBytes() const { return uUsedBytes; }
+	size_t allocationCount() const { return mapAllocated.size(); }
+	bool empty() const { return mapAllocated.empty(); }
+
+private:
+	static constexpr uint32_t kSecondLevelBits = 4;
+	static constexpr uint32_t kSecondLevelCount = 1u << kSecondLevelBits;
+	static constexpr uint32_t kFirstLevelCount = 64 - kSecondLevelBits + 1;
+	static constexpr uint32_t kNone = UINT32_MAX;
+
+	struct SRange {
+		uint64_t uOffset = 0;
+		uint64_t uSize = 0;
+		// Neighbours in address order, and in the free list of its size class.
+		uint32_t uPrevPhysical = kNone;
+		uint32_t uNextPhysical = kNone;
+		uint32_t uPrevFree = kNone;
+		uint32_t uNextFree = kNone;
+		bool bFree = false;
+	};
+
+	static void mapping(uint64_t uSize, uint32_t& uFirst, uint32_t& uSecond);
+	uint32_t findFreeRange(uint64_t uSize) const;
+	void insertFree(uint32_t uRange);
+	void removeFree(uint32_t uRange);
+	uint32_t newRange();
+	void releaseRange(uint32_t uRange);
+	// Splits uSize bytes off the front of uRange into a new range that is
+	// returned; uRange keeps the rest.
+	uint32_t splitFront(uint32_t uRange, uint64_t uSize);
+	void mergeWithNext(uint32_t uRange);
+
+	uint64_t uTotalSize = 0;
+	uint64_t uUsedBytes = 0;
+	uint64_t uFirstLevelMap = 0;
+	uint32_t aSecondLevelMap[kFirstLevelCount] = {};
+	uint32_t aFreeHeads[kFirstLevelCount][kSecondLevelCount];
+	std::vector<SRange> vecRanges;
+	std::vector<uint32_t> vecUnusedRanges;
+	std::unordered_map<uint64_t, uint32_t> mapAllocated;
+};
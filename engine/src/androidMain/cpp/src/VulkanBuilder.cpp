@@ -1,4 +1,6 @@
 #include "VulkanBuilder.h"
+#include <algorithm>
+#include <cstring>
 #include <android/log.h>
 
 #define LOG_TAG "VKBuilder"
@@ -6,6 +8,9 @@
 #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
 
 namespace {
+// Upper bound for the texture table; the device limits may lower it.
+constexpr uint32_t kMaxTextureTableSize = 4096;
+
 const char* transformToString(VkSurfaceTransformFlagBitsKHR transform) {
 	switch (transform) {
 	case VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR: return "IDENTITY";
@@ -40,7 +45,15 @@ VulkanBuilder& VulkanBuilder::buildInstance() {
 	appInfo.applicationVersion = VK_MAKE_VERSION(1,0,0);
 	appInfo.pEngineName = "NoEngine";
 	appInfo.engineVersion = VK_MAKE_VERSION(1,0,0);
-	appInfo.apiVersion = VK_API_VERSION_1_1;
+	// Vulkan 1.2 makes descriptor indexing core; older loaders stay on 1.1.
+	auto enumerateInstanceVersion = reinterpret_cast<PFN_vkEnumerateInstanceVersion>(
+		vkGetInstanceProcAddr(VK_NULL_HANDLE, "vkEnumerateInstanceVersion"));
+	uint32_t loaderVersion = VK_API_VERSION_1_0;
+	if (enumerateInstanceVersion) {
+		enumerateInstanceVersion(&loaderVersion);
+	}
+	apiVersion = loaderVersion >= VK_API_VERSION_1_2 ? VK_API_VERSION_1_2 : VK_API_VERSION_1_1;
+	appInfo.apiVersion = apiVersion;
 
 	const char* exts[] = {"VK_KHR_surface", "VK_KHR_android_surface"};
 
@@ -78,6 +91,16 @@ VulkanBuilder& VulkanBuilder::pickPhysicalDevice() {
 			if ((qprops[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) && presentSupport) {
 				physicalDevice = d;
 				graphicsQueueFamily = i;
+				transferQueueFamily = i;
+				for (uint32_t j = 0; j < qCount; ++j) {
+					const VkQueueFlags flags = qprops[j].queueFlags;
+					if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))) {
+						transferQueueFamily = j;
+						break;
+					}
+				}
+				LOGI("Uploads use queue family %u (%s)", transferQueueFamily,
+					transferQueueFamily == graphicsQueueFamily ? "graphics" : "transfer only");
 				return *this;
 			}
 		}
@@ -88,25 +111,103 @@ VulkanBuilder& VulkanBuilder::pickPhysicalDevice() {
 
 VulkanBuilder& VulkanBuilder::buildDeviceAndQueue() {
 	float priority = 1.0f;
-	VkDeviceQueueCreateInfo qci{ };
-	qci.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-	qci.queueFamilyIndex = graphicsQueueFamily;
-	qci.queueCount = 1;
-	qci.pQueuePriorities = &priority;
+	VkDeviceQueueCreateInfo qci[2]{ };
+	qci[0].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+	qci[0].queueFamilyIndex = graphicsQueueFamily;
+	qci[0].queueCount = 1;
+	qci[0].pQueuePriorities = &priority;
+	qci[1] = qci[0];
+	qci[1].queueFamilyIndex = transferQueueFamily;
 
-	const char* exts[] = {"VK_KHR_swapchain"};
+	std::vector<const char*> exts = {"VK_KHR_swapchain"};
 
 	VkDeviceCreateInfo dci{ };
 	dci.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-	dci.queueCreateInfoCount = 1;
-	dci.pQueueCreateInfos = &qci;
-	dci.enabledExtensionCount = 1;
-	dci.ppEnabledExtensionNames = exts;
+	dci.queueCreateInfoCount = transferQueueFamily == graphicsQueueFamily ? 1 : 2;
+	dci.pQueueCreateInfos = qci;
+
+	// Features for one texture array indexed per draw and updated while in use.
+	VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures{ };
+	indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+	VkPhysicalDeviceFeatures2 features{ };
+	features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	bool needsExtension = false;
+	textureTableCapacity = queryTextureTableCapacity(needsExtension);
+	if (textureTableCapacity > 0) {
+		if (needsExtension) {
+			exts.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+		}
+		features.features.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+		indexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+		indexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+		indexingFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+		features.pNext = &indexingFeatures;
+		dci.pNext = &features;
+	}
+	LOGI("Texture table capacity %u (%s)", textureTableCapacity,
+		textureTableCapacity == 0 ? "descriptor indexing unavailable" : needsExtension ? "VK_EXT_descriptor_indexing" : "Vulkan 1.2");
+
+	dci.enabledExtensionCount = static_cast<uint32_t>(exts.size());
+	dci.ppEnabledExtensionNames = exts.data();
 	check(vkCreateDevice(physicalDevice, &dci, nullptr, &device), "vkCreateDevice");
 	vkGetDeviceQueue(device, graphicsQueueFamily, 0, &graphicsQueue);
+	vkGetDeviceQueue(device, transferQueueFamily, 0, &transferQueue);
 	return *this;
 }
 
+// Descriptor indexing is core from Vulkan 1.2 and VK_EXT_descriptor_indexing
+// before that. Returns 0 when a needed feature is missing.
+uint32_t VulkanBuilder::queryTextureTableCapacity(bool& outNeedsExtension) const {
+	VkPhysicalDeviceProperties props{ };
+	vkGetPhysicalDeviceProperties(physicalDevice, &props);
+	const bool core = apiVersion >= VK_API_VERSION_1_2 && props.apiVersion >= VK_API_VERSION_1_2;
+	if (!core) {
+		uint32_t count = 0;
+		vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &count, nullptr);
+		std::vector<VkExtensionProperties> extensions(count);
+		vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &count, extensions.data());
+		const bool found = std::any_of(extensions.begin(), extensions.end(), [](const VkExtensionProperties& ext) {
+			return std::strcmp(ext.extensionName, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME) == 0;
+		});
+		if (!found) return 0;
+	}
+	outNeedsExtension = !core;
+
+	// Core in Vulkan 1.1, but Android's loader only exports it from API 28.
+	auto getFeatures2 = reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2>(
+		vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceFeatures2"));
+	auto getProperties2 = reinterpret_cast<PFN_vkGetPhysicalDeviceProperties2>(
+		vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceProperties2"));
+	if (!getFeatures2 || !getProperties2) return 0;
+
+	VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures{ };
+	indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+	VkPhysicalDeviceFeatures2 features{ };
+	features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	features.pNext = &indexingFeatures;
+	getFeatures2(physicalDevice, &features);
+	if (!features.features.shaderSampledImageArrayDynamicIndexing ||
+		!indexingFeatures.descriptorBindingPartiallyBound ||
+		!indexingFeatures.descriptorBindingSampledImageUpdateAfterBind ||
+		!indexingFeatures.descriptorBindingUpdateUnusedWhilePending) {
+		return 0;
+	}
+
+	VkPhysicalDeviceDescriptorIndexingProperties indexingProps{ };
+	indexingProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+	VkPhysicalDeviceProperties2 props2{ };
+	props2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	props2.pNext = &indexingProps;
+	getProperties2(physicalDevice, &props2);
+	return std::min({
+		kMaxTextureTableSize,
+		indexingProps.maxPerStageDescriptorUpdateAfterBindSamplers,
+		indexingProps.maxPerStageDescriptorUpdateAfterBindSampledImages,
+		indexingProps.maxPerStageUpdateAfterBindResources,
+		indexingProps.maxDescriptorSetUpdateAfterBindSamplers,
+		indexingProps.maxDescriptorSetUpdateAfterBindSampledImages });
+}
+
 VulkanBuilder& VulkanBuilder::buildSwapchain(uint32_t width, uint32_t height) {
 	VkSurfaceCapabilitiesKHR caps{};
 	check(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physicalDevice, surface, &caps), "vkGetPhysicalDeviceSurfaceCapabilitiesKHR");
@@ -264,6 +365,11 @@ VulkanBuilder& VulkanBuilder::setDescriptorSetLayouts(const std::vector<VkDescri
 	return *this;
 }
 
+VulkanBuilder& VulkanBuilder::setTextureTableSize(uint32_t size) {
+	textureTableSize = size;
+	return *this;
+}
+
 VulkanBuilder& VulkanBuilder::buildPipeline() {
 	auto createShaderModule = [&](const std::vector<uint32_t>& code, VkShaderModule& out) {
 		VkShaderModuleCreateInfo ci{};
@@ -287,6 +393,11 @@ VulkanBuilder& VulkanBuilder::buildPipeline() {
 	stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
 	stages[1].module = fragModule;
 	stages[1].pName = "main";
+	VkSpecializationMapEntry tableSizeEntry{ 0, 0, sizeof(uint32_t) };
+	VkSpecializationInfo tableSizeInfo{ 1, &tableSizeEntry, sizeof(uint32_t), &textureTableSize };
+	if (textureTableSize > 0) {
+		stages[1].pSpecializationInfo = &tableSizeInfo;
+	}
 
 	VkVertexInputBindingDescription binding{};
 	binding.binding = 0;
@@ -368,18 +479,22 @@ VulkanBuilder& VulkanBuilder::buildPipeline() {
 	depthStencil.depthBoundsTestEnable = VK_FALSE;
 	depthStencil.stencilTestEnable = VK_FALSE;
 
-	// Push constants for camera rotation, viewport size, distance, model translation, scale, and model rotation (13 floats)
-	VkPushConstantRange pushConstantRange{};
-	pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-	pushConstantRange.offset = 0;
-	pushConstantRange.size = sizeof(float) * 15;
+	// Push constants for camera rotation, viewport size, distance, model translation, scale, and model rotation (15 floats),
+	// then the material constants for the fragment shader
+	VkPushConstantRange pushConstantRanges[2]{};
+	pushConstantRanges[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	pushConstantRanges[0].offset = 0;
+	pushConstantRanges[0].size = sizeof(float) * 15;
+	pushConstantRanges[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	pushConstantRanges[1].offset = kMaterialConstantsOffset;
+	pushConstantRanges[1].size = sizeof(MaterialConstants);
 	
 	VkPipelineLayoutCreateInfo layoutCi{};
 	layoutCi.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 	layoutCi.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
 	layoutCi.pSetLayouts = descriptorSetLayouts.empty() ? nullptr : descriptorSetLayouts.data();
-	layoutCi.pushConstantRangeCount = 1;
-	layoutCi.pPushConstantRanges = &pushConstantRange;
+	layoutCi.pushConstantRangeCount = 2;
+	layoutCi.pPushConstantRanges = pushConstantRanges;
 	check(vkCreatePipelineLayout(device, &layoutCi, nullptr, &pipelineLayout), "vkCreatePipelineLayout");
 
 	VkGraphicsPipelineCreateInfo gpci{};
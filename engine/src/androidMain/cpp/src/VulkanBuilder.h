@@ -5,6 +5,16 @@
 #include <android/native_window.h>
 #include <android/asset_manager.h>
 
+// Fragment push constants describing the material of a draw. They follow the
+// 15 vertex floats, at an offset aligned for the vec4.
+struct MaterialConstants {
+	float baseColorFactor[4];
+	int32_t hasTexture;
+	// Element of the texture table, when one is used.
+	int32_t textureIndex;
+};
+constexpr uint32_t kMaterialConstantsOffset = 64;
+
 // VulkanBuilder encapsulates Vulkan setup in easy-to-follow steps.
 class VulkanBuilder {
 public:
@@ -24,6 +34,9 @@ public:
 	VulkanBuilder& setVertexSpirv(const std::vector<uint32_t>& vert);
 	VulkanBuilder& setFragmentSpirv(const std::vector<uint32_t>& frag);
 	VulkanBuilder& setDescriptorSetLayouts(const std::vector<VkDescriptorSetLayout>& layouts);
+	// Array size of the fragment shader's texture table (specialisation
+	// constant 0); 0 for shaders without one.
+	VulkanBuilder& setTextureTableSize(uint32_t size);
 
 	// Swapchain dependent cleanup (does not destroy device/instance/surface)
 	void cleanupSwapchain();
@@ -35,6 +48,10 @@ public:
 	uint32_t getGraphicsQueueFamily() const { return graphicsQueueFamily; }
 	VkDevice getDevice() const { return device; }
 	VkQueue getGraphicsQueue() const { return graphicsQueue; }
+	// A transfer-only family when the device has one (its copy engine), else
+	// the graphics family and queue.
+	uint32_t getTransferQueueFamily() const { return transferQueueFamily; }
+	VkQueue getTransferQueue() const { return transferQueue; }
 	VkSwapchainKHR getSwapchain() const { return swapchain; }
 	VkFormat getSwapchainFormat() const { return swapchainFormat; }
 	VkExtent2D getSwapchainExtent() const { return swapchainExtent; }
@@ -45,21 +62,28 @@ public:
 	VkPipelineLayout getPipelineLayout() const { return pipelineLayout; }
 	VkPipeline getGraphicsPipeline() const { return graphicsPipeline; }
 	VkFormat getDepthFormat() const { return depthFormat; }
+	// Textures one descriptor-indexed array can hold when the device was created
+	// with descriptor indexing, 0 otherwise.
+	uint32_t getTextureTableCapacity() const { return textureTableCapacity; }
 
 private:
 	void check(VkResult r, const char* what);
 	VkFormat findSupportedFormat(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features) const;
 	VkFormat findDepthFormat() const;
+	uint32_t queryTextureTableCapacity(bool& outNeedsExtension) const;
 
 	ANativeWindow* window;
 	AAssetManager* assets;
 
 	VkInstance instance = VK_NULL_HANDLE;
+	uint32_t apiVersion = VK_API_VERSION_1_1;
 	VkSurfaceKHR surface = VK_NULL_HANDLE;
 	VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
 	uint32_t graphicsQueueFamily = 0;
+	uint32_t transferQueueFamily = 0;
 	VkDevice device = VK_NULL_HANDLE;
 	VkQueue graphicsQueue = VK_NULL_HANDLE;
+	VkQueue transferQueue = VK_NULL_HANDLE;
 
 	VkSwapchainKHR swapchain = VK_NULL_HANDLE;
 	VkFormat swapchainFormat{};
@@ -76,6 +100,8 @@ private:
 	std::vector<uint32_t> vertSpv;
 	std::vector<uint32_t> fragSpv;
 	std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
+	uint32_t textureTableCapacity = 0;
+	uint32_t textureTableSize = 0;
 };
 
 
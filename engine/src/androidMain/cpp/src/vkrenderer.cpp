@@ -10,19 +10,29 @@
 #include <utility>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <deque>
+#include <functional>
 #include <cstdio>
 #include <limits>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <mutex>
 #include <thread>
 
+#include "AssetPack.h"
 #include "ImageLoader.h"
-
-static constexpr size_t INVALID_TEXTURE_INDEX = std::numeric_limits<size_t>::max();
+#include "LoadPipeline.h"
+#include "Mipmaps.h"
+#include "StagingRing.h"
+#include "TlsfAllocator.h"
 #include "ModelLoader.h"
+#include "CookedModel.h"
+#include "ModelCache.h"
 #include "VulkanBuilder.h"
 #include "Camera.h"
 
@@ -30,37 +40,154 @@ static constexpr size_t INVALID_TEXTURE_INDEX = std::numeric_limits<size_t>::max
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
 #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
 
+static constexpr size_t INVALID_TEXTURE_INDEX = std::numeric_limits<size_t>::max();
+static constexpr uint32_t INVALID_TABLE_INDEX = std::numeric_limits<uint32_t>::max();
+static constexpr size_t DEDICATED_ALLOCATION = std::numeric_limits<size_t>::max();
+static constexpr size_t NO_GEOMETRY_PAGE = std::numeric_limits<size_t>::max();
+static constexpr VkDeviceSize VERTEX_STRIDE = sizeof(float) * Model::kPackedVertexFloats;
+static_assert((VERTEX_STRIDE & (VERTEX_STRIDE - 1)) == 0, "Arena placement needs a power-of-two vertex stride");
+
+// Device memory of one buffer or image: a range of a shared MemoryBlock, or an
+// allocation of its own when block is DEDICATED_ALLOCATION.
+struct GpuAllocation {
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	VkDeviceSize offset = 0;
+	VkDeviceSize size = 0;
+	// Host-visible memory stays mapped while allocated.
+	unsigned char* mapped = nullptr;
+	uint32_t memoryType = 0;
+	size_t block = DEDICATED_ALLOCATION;
+};
+
+struct MemoryBlock {
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	VkDeviceSize size = 0;
+	uint32_t memoryType = 0;
+	// Buffers and optimal-tiling images get separate blocks when the device's
+	// bufferImageGranularity would otherwise require padding between them.
+	bool linear = true;
+	unsigned char* mapped = nullptr;
+	std::unique_ptr<TlsfAllocator> placement;
+};
+
+struct HeapUsage {
+	VkDeviceSize heapSize = 0;
+	// Reserved by blocks and dedicated allocations, and actually handed out.
+	VkDeviceSize reservedBytes = 0;
+	VkDeviceSize usedBytes = 0;
+	uint32_t blockCount = 0;
+	uint32_t allocationCount = 0;
+	uint32_t dedicatedCount = 0;
+};
+
+// One vertex and one index buffer shared by many models. Ranges are placed
+// with TlsfAllocator, so freed ranges are reused by later models.
+struct GeometryPage {
+	VkBuffer vertexBuffer = VK_NULL_HANDLE;
+	GpuAllocation vertexMemory;
+	std::unique_ptr<TlsfAllocator> vertexRanges;
+	VkBuffer indexBuffer = VK_NULL_HANDLE;
+	GpuAllocation indexMemory;
+	std::unique_ptr<TlsfAllocator> indexRanges;
+};
+
+// A model's place in the geometry arena. Draws pass firstVertex as
+// vertexOffset and add firstIndex to their index offsets.
+struct GeometrySlice {
+	size_t page = NO_GEOMETRY_PAGE;
+	VkDeviceSize vertexBytes = 0;
+	VkDeviceSize indexBytes = 0;
+	int32_t firstVertex = 0;
+	uint32_t firstIndex = 0;
+};
+
 struct GpuModel {
 	int64_t id = 0;
 	Model cpu;
-	VkBuffer vertexBuffer = VK_NULL_HANDLE;
-	VkDeviceMemory vertexMemory = VK_NULL_HANDLE;
-	VkBuffer indexBuffer = VK_NULL_HANDLE;
-	VkDeviceMemory indexMemory = VK_NULL_HANDLE;
+	GeometrySlice geometry;
 	std::vector<size_t> materialTextureIndices;
 };
 
 struct TextureResource {
 	std::string key;
 	VkImage image = VK_NULL_HANDLE;
-	VkDeviceMemory memory = VK_NULL_HANDLE;
+	GpuAllocation memory;
 	VkImageView view = VK_NULL_HANDLE;
+	// Owned by g.samplers.
 	VkSampler sampler = VK_NULL_HANDLE;
 	VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
 	uint32_t width = 0;
 	uint32_t height = 0;
+	uint32_t mipLevels = 1;
+	// File textures can be evicted and streamed back in; an evicted texture keeps
+	// its slot (and index) with image == VK_NULL_HANDLE.
+	std::string sourcePath;
+	VkDeviceSize memoryBytes = 0;
+	// g.currentFrame when last drawn or uploaded; both sides hold g_stateMutex.
+	uint64_t lastUsedFrame = 0;
+	bool reloadRequested = false;
+	// Low-resolution stand-in, replaced when the full texture is uploaded.
+	bool preview = false;
+	// Element of g.textureTableSet; unused without a texture table.
+	uint32_t tableIndex = INVALID_TABLE_INDEX;
+};
+
+// Texture sets are never freed back to their pool; released sets are reused,
+// so pools need no FREE_DESCRIPTOR_SET_BIT and cannot fragment.
+struct DescriptorPoolBlock {
+	VkDescriptorPool pool = VK_NULL_HANDLE;
+	uint32_t capacity = 0;
+	uint32_t allocated = 0;
+};
+
+struct CachedSampler {
+	VkSamplerCreateInfo info{};
+	VkSampler sampler = VK_NULL_HANDLE;
+};
+
+// Destruction of objects that frames recorded up to frame may still use.
+struct DeferredDeletion {
+	uint64_t frame = 0;
+	std::function<void()> destroy;
+};
+
+struct UploadedTexture {
+	TextureResource texture;
+	VkFormat format = VK_FORMAT_UNDEFINED;
+	bool gpuMipmaps = false;
+};
+
+// Copies submitted to the transfer queue together. Nothing in a batch is seen
+// by frames until its fence has signalled and the batch is published.
+struct UploadBatch {
+	VkCommandBuffer cmd = VK_NULL_HANDLE;
+	VkFence fence = VK_NULL_HANDLE;
+	// Only with a separate transfer family: signalled with the fence and waited
+	// on by the frame that takes ownership of the batch's resources.
+	VkSemaphore semaphore = VK_NULL_HANDLE;
+	bool submitted = false;
+	// A failed submission never signals the fence.
+	VkResult submitResult = VK_SUCCESS;
+	std::vector<VkBuffer> stagingBuffers;
+	std::vector<GpuAllocation> stagingMemory;
+	std::vector<std::shared_ptr<StagingBlock>> stagingBlocks;
+	std::vector<UploadedTexture> textures;
+	std::vector<GpuModel> models;
 };
 
 struct VulkanState {
 	ANativeWindow* window = nullptr;
 	AAssetManager* assetManager = nullptr;
+	std::shared_ptr<const AssetSource> assetSource;
 	VulkanBuilder* builder = nullptr;
 	VkInstance instance = VK_NULL_HANDLE;
 	VkSurfaceKHR surface = VK_NULL_HANDLE;
 	VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
 	uint32_t graphicsQueueFamily = 0;
+	uint32_t transferQueueFamily = 0;
 	VkDevice device = VK_NULL_HANDLE;
 	VkQueue graphicsQueue = VK_NULL_HANDLE;
+	VkQueue transferQueue = VK_NULL_HANDLE;
 	VkSwapchainKHR swapchain = VK_NULL_HANDLE;
 	VkFormat swapchainFormat{};
 	VkExtent2D swapchainExtent{};
@@ -68,7 +195,7 @@ struct VulkanState {
 	std::vector<VkImageView> swapchainImageViews;
 	VkFormat depthFormat = VK_FORMAT_UNDEFINED;
 	std::vector<VkImage> depthImages;
-	std::vector<VkDeviceMemory> depthImageMemory;
+	std::vector<GpuAllocation> depthImageMemory;
 	std::vector<VkImageView> depthImageViews;
 	VkRenderPass renderPass = VK_NULL_HANDLE;
 	VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
@@ -79,21 +206,70 @@ struct VulkanState {
 	std::vector<VkSemaphore> imageAvailable;
 	std::vector<VkSemaphore> renderFinished;
 	std::vector<VkFence> inFlightFences;
-	size_t currentFrame = 0;
+	// Read by the upload thread to schedule deferred destruction, so it only
+	// changes under g_stateMutex.
+	uint64_t currentFrame = 0;
 	bool initialized = false;
 	Camera camera;
 	VkSurfaceTransformFlagBitsKHR surfaceTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
 	std::vector<GpuModel> models;
 	VkDescriptorSetLayout textureDescriptorSetLayout = VK_NULL_HANDLE;
+	// Texture table pool, or per-texture set pools chained as they fill up.
 	VkDescriptorPool textureDescriptorPool = VK_NULL_HANDLE;
+	std::vector<DescriptorPoolBlock> textureSetPools;
+	std::vector<VkDescriptorSet> freeTextureSets;
+	// With descriptor indexing every texture lives in one array, bound once per
+	// command buffer; otherwise each texture has its own set.
+	uint32_t textureTableCapacity = 0;
+	VkDescriptorSet textureTableSet = VK_NULL_HANDLE;
+	std::vector<uint32_t> freeTableIndices;
+	uint32_t nextTableIndex = 0;
 	VkCommandPool uploadCommandPool = VK_NULL_HANDLE;
+	VkFence uploadFence = VK_NULL_HANDLE;
+	VkCommandPool transferCommandPool = VK_NULL_HANDLE;
+	// Oldest first; the last one is still being recorded unless submitted.
+	std::deque<UploadBatch> uploadBatches;
+	std::vector<VkFence> freeUploadFences;
+	std::vector<VkSemaphore> freeUploadSemaphores;
+	VkBuffer stagingRingBuffer = VK_NULL_HANDLE;
+	GpuAllocation stagingRingMemory;
+	std::shared_ptr<StagingRing> stagingRing;
 	std::vector<TextureResource> textures;
 	std::unordered_map<std::string, size_t> textureCache;
+	std::unordered_set<std::string> failedTextures;
 	size_t defaultTextureIndex = INVALID_TEXTURE_INDEX;
+	VkDeviceSize residentTextureBytes = 0;
+	// Oldest first, so frames only grow towards the back.
+	std::deque<DeferredDeletion> deletionQueue;
+	// One sampler per distinct create info, shared by every texture using it.
+	std::vector<CachedSampler> samplers;
+	VkPhysicalDeviceMemoryProperties memoryProperties{};
+	VkDeviceSize bufferImageGranularity = 1;
+	// The main device-local heap is also host-visible (typical of mobile GPUs).
+	bool unifiedMemory = false;
+	// Slots of released blocks are reused, so allocations keep their index.
+	std::vector<MemoryBlock> memoryBlocks;
+	std::array<HeapUsage, VK_MAX_MEMORY_HEAPS> dedicatedUsage{};
+	std::vector<GeometryPage> geometryPages;
 };
 
 static VulkanState g;
 static std::mutex g_stateMutex;
+// Serialises submissions: the render thread submits and presents without
+// g_stateMutex, and uploads may share its queue.
+static std::mutex g_queueMutex;
+static std::mutex g_loadPipelineMutex;
+static std::shared_ptr<LoadPipeline> g_loadPipeline;
+// The benchmark reads through g.assetSource, whose APK source holds a raw
+// AAssetManager, so the thread is joined before teardown instead of detached.
+static std::mutex g_benchmarkMutex;
+static std::thread g_benchmarkThread;
+static std::atomic<bool> g_benchmarkCancel{false};
+// Applied when the pipeline is created in nativeInit.
+static SLoadPipelineOptions g_loadPipelineOptions;
+// Device memory file textures may occupy before least recently used ones are
+// evicted; 0 disables eviction. Guarded by g_stateMutex.
+static VkDeviceSize g_textureBudgetBytes = 256ull * 1024 * 1024;
 
 static const char* surfaceTransformName(VkSurfaceTransformFlagBitsKHR transform) {
 	switch (transform) {
@@ -133,6 +309,14 @@ static GpuModel* findModelById(int64_t modelId) {
 			return &model;
 		}
 	}
+	// Still uploading; changes made now carry over when it is published.
+	for (auto& batch : g.uploadBatches) {
+		for (auto& model : batch.models) {
+			if (model.id == modelId) {
+				return &model;
+			}
+		}
+	}
 	return nullptr;
 }
 
@@ -148,8 +332,7 @@ static void check(VkResult r, const char* what) {
 }
 
 static uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
-	VkPhysicalDeviceMemoryProperties memProps;
-	vkGetPhysicalDeviceMemoryProperties(g.physicalDevice, &memProps);
+	const VkPhysicalDeviceMemoryProperties& memProps = g.memoryProperties;
 	for (uint32_t i = 0; i < memProps.memoryTypeCount; i++) {
 		if ((typeFilter & (1 << i)) && (memProps.memoryTypes[i].propertyFlags & properties) == properties) {
 			return i;
@@ -159,33 +342,258 @@ static uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags proper
 	abort();
 }
 
-static void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags props, VkBuffer& buffer, VkDeviceMemory& memory) {
+static void initMemoryAllocator() {
+	vkGetPhysicalDeviceMemoryProperties(g.physicalDevice, &g.memoryProperties);
+	VkPhysicalDeviceProperties props{};
+	vkGetPhysicalDeviceProperties(g.physicalDevice, &props);
+	g.bufferImageGranularity = std::max<VkDeviceSize>(props.limits.bufferImageGranularity, 1);
+
+	// A small host-visible window onto a discrete GPU's VRAM does not count.
+	uint32_t largestDeviceHeap = 0;
+	for (uint32_t i = 1; i < g.memoryProperties.memoryHeapCount; ++i) {
+		const VkMemoryHeap& heap = g.memoryProperties.memoryHeaps[i];
+		const VkMemoryHeap& largest = g.memoryProperties.memoryHeaps[largestDeviceHeap];
+		const bool deviceLocal = heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+		const bool largestDeviceLocal = largest.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+		if (deviceLocal && (!largestDeviceLocal || heap.size > largest.size)) {
+			largestDeviceHeap = i;
+		}
+	}
+	const VkMemoryPropertyFlags unified = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	g.unifiedMemory = false;
+	for (uint32_t i = 0; i < g.memoryProperties.memoryTypeCount; ++i) {
+		const VkMemoryType& type = g.memoryProperties.memoryTypes[i];
+		if ((type.propertyFlags & unified) == unified && type.heapIndex == largestDeviceHeap) {
+			g.unifiedMemory = true;
+		}
+	}
+	LOGI("Geometry is %s", g.unifiedMemory ? "written straight to unified memory" : "staged into device-local memory");
+}
+
+static uint32_t heapOfMemoryType(uint32_t memoryType) {
+	return g.memoryProperties.memoryTypes[memoryType].heapIndex;
+}
+
+// 256 MB blocks on heaps above 4 GB and 64 MB otherwise, but never more than an
+// eighth of a small heap such as a host-visible slice of VRAM.
+static VkDeviceSize memoryBlockSize(uint32_t memoryType) {
+	const VkDeviceSize heapSize = g.memoryProperties.memoryHeaps[heapOfMemoryType(memoryType)].size;
+	const VkDeviceSize preferred = heapSize > 4ull * 1024 * 1024 * 1024 ? 256ull * 1024 * 1024 : 64ull * 1024 * 1024;
+	return std::min(preferred, heapSize / 8);
+}
+
+static VkResult allocateDeviceMemory(VkDeviceSize size, uint32_t memoryType, VkDeviceMemory& memory, unsigned char*& mapped) {
+	VkMemoryAllocateInfo ai{};
+	ai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	ai.allocationSize = size;
+	ai.memoryTypeIndex = memoryType;
+	VkResult result = vkAllocateMemory(g.device, &ai, nullptr, &memory);
+	if (result != VK_SUCCESS) return result;
+	mapped = nullptr;
+	if (g.memoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+		void* data = nullptr;
+		check(vkMapMemory(g.device, memory, 0, VK_WHOLE_SIZE, 0, &data), "vkMapMemory");
+		mapped = static_cast<unsigned char*>(data);
+	}
+	return VK_SUCCESS;
+}
+
+static void freeDeviceMemory(VkDeviceMemory memory, unsigned char* mapped) {
+	if (mapped) vkUnmapMemory(g.device, memory);
+	vkFreeMemory(g.device, memory, nullptr);
+}
+
+static std::vector<HeapUsage> computeHeapUsage() {
+	std::vector<HeapUsage> heaps(g.dedicatedUsage.begin(), g.dedicatedUsage.begin() + g.memoryProperties.memoryHeapCount);
+	for (uint32_t i = 0; i < g.memoryProperties.memoryHeapCount; ++i) {
+		heaps[i].heapSize = g.memoryProperties.memoryHeaps[i].size;
+	}
+	for (const MemoryBlock& block : g.memoryBlocks) {
+		if (!block.memory) continue;
+		HeapUsage& heap = heaps[heapOfMemoryType(block.memoryType)];
+		heap.reservedBytes += block.size;
+		heap.usedBytes += block.placement->usedBytes();
+		heap.blockCount += 1;
+		heap.allocationCount += static_cast<uint32_t>(block.placement->allocationCount());
+	}
+	return heaps;
+}
+
+static void logHeapUsage() {
+	const std::vector<HeapUsage> heaps = computeHeapUsage();
+	for (size_t i = 0; i < heaps.size(); ++i) {
+		const HeapUsage& heap = heaps[i];
+		if (heap.reservedBytes == 0) continue;
+		LOGI("Memory heap %zu: %llu of %llu reserved bytes used, %u blocks, %u sub-allocations, %u dedicated (heap %llu bytes)", i,
+			static_cast<unsigned long long>(heap.usedBytes), static_cast<unsigned long long>(heap.reservedBytes),
+			heap.blockCount, heap.allocationCount, heap.dedicatedCount, static_cast<unsigned long long>(heap.heapSize));
+	}
+}
+
+static bool allocateDedicated(const VkMemoryRequirements& req, uint32_t memoryType, GpuAllocation& allocation) {
+	if (allocateDeviceMemory(req.size, memoryType, allocation.memory, allocation.mapped) != VK_SUCCESS) return false;
+	allocation.offset = 0;
+	allocation.size = req.size;
+	allocation.memoryType = memoryType;
+	allocation.block = DEDICATED_ALLOCATION;
+	HeapUsage& heap = g.dedicatedUsage[heapOfMemoryType(memoryType)];
+	heap.reservedBytes += req.size;
+	heap.usedBytes += req.size;
+	heap.allocationCount += 1;
+	heap.dedicatedCount += 1;
+	return true;
+}
+
+static bool allocateFromBlock(size_t index, const VkMemoryRequirements& req, GpuAllocation& allocation) {
+	MemoryBlock& block = g.memoryBlocks[index];
+	const uint64_t offset = block.placement->allocate(req.size, req.alignment);
+	if (offset == TlsfAllocator::kInvalidOffset) return false;
+	allocation.memory = block.memory;
+	allocation.offset = offset;
+	allocation.size = req.size;
+	allocation.mapped = block.mapped ? block.mapped + offset : nullptr;
+	allocation.memoryType = block.memoryType;
+	allocation.block = index;
+	return true;
+}
+
+// Places a resource in a shared block of a matching memory type, adding a block
+// when none has room. Resources larger than half a block get their own memory.
+static GpuAllocation allocateGpuMemory(const VkMemoryRequirements& req, VkMemoryPropertyFlags props, bool linear) {
+	const uint32_t memoryType = findMemoryType(req.memoryTypeBits, props);
+	const VkDeviceSize blockSize = memoryBlockSize(memoryType);
+	const bool separateKinds = g.bufferImageGranularity > 1;
+	GpuAllocation allocation;
+	if (req.size > blockSize / 2) {
+		if (!allocateDedicated(req, memoryType, allocation)) {
+			check(VK_ERROR_OUT_OF_DEVICE_MEMORY, "vkAllocateMemory(dedicated)");
+		}
+		return allocation;
+	}
+	size_t freeSlot = g.memoryBlocks.size();
+	for (size_t i = 0; i < g.memoryBlocks.size(); ++i) {
+		const MemoryBlock& block = g.memoryBlocks[i];
+		if (!block.memory) {
+			freeSlot = std::min(freeSlot, i);
+			continue;
+		}
+		if (block.memoryType != memoryType || (separateKinds && block.linear != linear)) continue;
+		if (allocateFromBlock(i, req, allocation)) return allocation;
+	}
+
+	MemoryBlock block;
+	block.size = blockSize;
+	block.memoryType = memoryType;
+	block.linear = linear;
+	VkResult result = allocateDeviceMemory(blockSize, memoryType, block.memory, block.mapped);
+	if (result != VK_SUCCESS) {
+		// The heap may still fit the resource on its own.
+		if (!allocateDedicated(req, memoryType, allocation)) {
+			check(result, "vkAllocateMemory(block)");
+		}
+		return allocation;
+	}
+	block.placement = std::make_unique<TlsfAllocator>(blockSize);
+	if (freeSlot == g.memoryBlocks.size()) {
+		g.memoryBlocks.push_back(std::move(block));
+	} else {
+		g.memoryBlocks[freeSlot] = std::move(block);
+	}
+	LOGI("Added %llu byte memory block for type %u", static_cast<unsigned long long>(blockSize), memoryType);
+	logHeapUsage();
+	// Alignment padding can still exceed the fresh block's free range.
+	if (!allocateFromBlock(freeSlot, req, allocation) && !allocateDedicated(req, memoryType, allocation)) {
+		check(VK_ERROR_OUT_OF_DEVICE_MEMORY, "vkAllocateMemory(dedicated)");
+	}
+	return allocation;
+}
+
+// Empty blocks are released unless they are the last of their kind, which
+// avoids reallocating a block when one resource is replaced by another.
+static void freeGpuMemory(GpuAllocation& allocation) {
+	if (!allocation.memory) return;
+	if (allocation.block == DEDICATED_ALLOCATION) {
+		freeDeviceMemory(allocation.memory, allocation.mapped);
+		HeapUsage& heap = g.dedicatedUsage[heapOfMemoryType(allocation.memoryType)];
+		heap.reservedBytes -= allocation.size;
+		heap.usedBytes -= allocation.size;
+		heap.allocationCount -= 1;
+		heap.dedicatedCount -= 1;
+	} else {
+		MemoryBlock& block = g.memoryBlocks[allocation.block];
+		block.placement->free(allocation.offset);
+		const bool hasSibling = block.placement->empty() && std::any_of(g.memoryBlocks.begin(), g.memoryBlocks.end(), [&](const MemoryBlock& other) {
+			return &other != &block && other.memory && other.memoryType == block.memoryType && other.linear == block.linear;
+		});
+		if (hasSibling) {
+			freeDeviceMemory(block.memory, block.mapped);
+			block = MemoryBlock{};
+			logHeapUsage();
+		}
+	}
+	allocation = GpuAllocation{};
+}
+
+static void destroyMemoryBlocks() {
+	for (MemoryBlock& block : g.memoryBlocks) {
+		if (!block.memory) continue;
+		if (!block.placement->empty()) {
+			LOGE("Memory block of type %u still holds %zu allocations", block.memoryType, block.placement->allocationCount());
+		}
+		freeDeviceMemory(block.memory, block.mapped);
+	}
+	g.memoryBlocks.clear();
+	g.dedicatedUsage = {};
+}
+
+// Runs destroy once every frame recorded so far has finished with the GPU, so
+// objects can be released without waiting for the device to go idle.
+static void deferDeletion(std::function<void()> destroy) {
+	g.deletionQueue.push_back(DeferredDeletion{ g.currentFrame, std::move(destroy) });
+}
+
+// Called after waiting on the fence of the frame about to be recorded, which
+// leaves at most framesInFlight frames running. deviceIdle runs everything.
+static void runDeferredDeletions(bool deviceIdle) {
+	const uint64_t framesInFlight = g.inFlightFences.size();
+	while (!g.deletionQueue.empty() && (deviceIdle || g.deletionQueue.front().frame + framesInFlight <= g.currentFrame)) {
+		std::function<void()> destroy = std::move(g.deletionQueue.front().destroy);
+		g.deletionQueue.pop_front();
+		destroy();
+	}
+}
+
+// Buffers shared with uploads are concurrent between the graphics and transfer
+// families, so copying into one range needs no ownership transfer of the rest.
+static void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags props, VkBuffer& buffer, GpuAllocation& memory,
+	bool sharedWithUploads = false) {
+	const uint32_t queueFamilies[2] = { g.graphicsQueueFamily, g.transferQueueFamily };
 	VkBufferCreateInfo bi{};
 	bi.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
 	bi.size = size;
 	bi.usage = usage;
 	bi.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	if (sharedWithUploads && g.transferQueueFamily != g.graphicsQueueFamily) {
+		bi.sharingMode = VK_SHARING_MODE_CONCURRENT;
+		bi.queueFamilyIndexCount = 2;
+		bi.pQueueFamilyIndices = queueFamilies;
+	}
 	check(vkCreateBuffer(g.device, &bi, nullptr, &buffer), "vkCreateBuffer");
 
 	VkMemoryRequirements req{};
 	vkGetBufferMemoryRequirements(g.device, buffer, &req);
-
-	VkMemoryAllocateInfo ai{};
-	ai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	ai.allocationSize = req.size;
-	ai.memoryTypeIndex = findMemoryType(req.memoryTypeBits, props);
-	check(vkAllocateMemory(g.device, &ai, nullptr, &memory), "vkAllocateMemory");
-	check(vkBindBufferMemory(g.device, buffer, memory, 0), "vkBindBufferMemory");
+	memory = allocateGpuMemory(req, props, true);
+	check(vkBindBufferMemory(g.device, buffer, memory.memory, memory.offset), "vkBindBufferMemory");
 }
 
-static void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usage, VkImage& image, VkDeviceMemory& memory) {
+static void createImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageUsageFlags usage, VkImage& image, GpuAllocation& memory) {
 	VkImageCreateInfo ici{};
 	ici.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
 	ici.imageType = VK_IMAGE_TYPE_2D;
 	ici.extent.width = width;
 	ici.extent.height = height;
 	ici.extent.depth = 1;
-	ici.mipLevels = 1;
+	ici.mipLevels = mipLevels;
 	ici.arrayLayers = 1;
 	ici.format = format;
 	ici.tiling = VK_IMAGE_TILING_OPTIMAL;
@@ -197,16 +605,11 @@ static void createImage(uint32_t width, uint32_t height, VkFormat format, VkImag
 
 	VkMemoryRequirements memReq{};
 	vkGetImageMemoryRequirements(g.device, image, &memReq);
-
-	VkMemoryAllocateInfo alloc{};
-	alloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	alloc.allocationSize = memReq.size;
-	alloc.memoryTypeIndex = findMemoryType(memReq.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-	check(vkAllocateMemory(g.device, &alloc, nullptr, &memory), "vkAllocateMemory(image)");
-	check(vkBindImageMemory(g.device, image, memory, 0), "vkBindImageMemory");
+	memory = allocateGpuMemory(memReq, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, false);
+	check(vkBindImageMemory(g.device, image, memory.memory, memory.offset), "vkBindImageMemory");
 }
 
-static VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectMask) {
+static VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectMask, uint32_t mipLevels) {
 	VkImageViewCreateInfo viewInfo{};
 	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
 	viewInfo.image = image;
@@ -214,7 +617,7 @@ static VkImageView createImageView(VkImage image, VkFormat format, VkImageAspect
 	viewInfo.format = format;
 	viewInfo.subresourceRange.aspectMask = aspectMask;
 	viewInfo.subresourceRange.baseMipLevel = 0;
-	viewInfo.subresourceRange.levelCount = 1;
+	viewInfo.subresourceRange.levelCount = mipLevels;
 	viewInfo.subresourceRange.baseArrayLayer = 0;
 	viewInfo.subresourceRange.layerCount = 1;
 	VkImageView imageView = VK_NULL_HANDLE;
@@ -222,7 +625,42 @@ static VkImageView createImageView(VkImage image, VkFormat format, VkImageAspect
 	return imageView;
 }
 
-static VkSampler createSampler() {
+static bool sameSamplerState(const VkSamplerCreateInfo& a, const VkSamplerCreateInfo& b) {
+	return a.flags == b.flags &&
+		a.magFilter == b.magFilter &&
+		a.minFilter == b.minFilter &&
+		a.mipmapMode == b.mipmapMode &&
+		a.addressModeU == b.addressModeU &&
+		a.addressModeV == b.addressModeV &&
+		a.addressModeW == b.addressModeW &&
+		a.mipLodBias == b.mipLodBias &&
+		a.anisotropyEnable == b.anisotropyEnable &&
+		a.maxAnisotropy == b.maxAnisotropy &&
+		a.compareEnable == b.compareEnable &&
+		a.compareOp == b.compareOp &&
+		a.minLod == b.minLod &&
+		a.maxLod == b.maxLod &&
+		a.borderColor == b.borderColor &&
+		a.unnormalizedCoordinates == b.unnormalizedCoordinates;
+}
+
+// Returns the cached sampler for this state, creating it on first use. Callers
+// must not destroy it; the cache is released with the texture resources.
+static VkSampler getSampler(const VkSamplerCreateInfo& samplerInfo) {
+	for (const CachedSampler& cached : g.samplers) {
+		if (sameSamplerState(cached.info, samplerInfo)) return cached.sampler;
+	}
+	CachedSampler cached;
+	cached.info = samplerInfo;
+	cached.info.pNext = nullptr;
+	check(vkCreateSampler(g.device, &samplerInfo, nullptr, &cached.sampler), "vkCreateSampler");
+	g.samplers.push_back(cached);
+	return cached.sampler;
+}
+
+// The sampler every texture is drawn with. The LOD range is left open so the
+// image view decides how many levels are sampled, letting all textures share it.
+static VkSampler getTextureSampler() {
 	VkSamplerCreateInfo samplerInfo{};
 	samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
 	samplerInfo.magFilter = VK_FILTER_LINEAR;
@@ -239,10 +677,8 @@ static VkSampler createSampler() {
 	samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
 	samplerInfo.mipLodBias = 0.0f;
 	samplerInfo.minLod = 0.0f;
-	samplerInfo.maxLod = 0.0f;
-	VkSampler sampler = VK_NULL_HANDLE;
-	check(vkCreateSampler(g.device, &samplerInfo, nullptr, &sampler), "vkCreateSampler");
-	return sampler;
+	samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+	return getSampler(samplerInfo);
 }
 
 static VkCommandBuffer beginSingleTimeCommands() {
@@ -262,21 +698,32 @@ static VkCommandBuffer beginSingleTimeCommands() {
 	return cmd;
 }
 
-static void endSingleTimeCommands(VkCommandBuffer cmd) {
+static void endSingleTimeCommands(VkCommandBuffer cmd, const std::vector<VkSemaphore>& waitSemaphores = {}) {
 	if (!cmd) return;
 	check(vkEndCommandBuffer(cmd), "vkEndCommandBuffer(single)");
+	const std::vector<VkPipelineStageFlags> waitStages(waitSemaphores.size(), VK_PIPELINE_STAGE_TRANSFER_BIT);
 	VkSubmitInfo submit{};
 	submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submit.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+	submit.pWaitSemaphores = waitSemaphores.data();
+	submit.pWaitDstStageMask = waitStages.data();
 	submit.commandBufferCount = 1;
 	submit.pCommandBuffers = &cmd;
-	VkResult submitResult = vkQueueSubmit(g.graphicsQueue, 1, &submit, VK_NULL_HANDLE);
+	// Waits on a fence rather than the queue so frames already in flight are not
+	// drained as well.
+	VkResult submitResult = VK_SUCCESS;
+	{
+		std::lock_guard<std::mutex> queueGuard(g_queueMutex);
+		submitResult = vkQueueSubmit(g.graphicsQueue, 1, &submit, g.uploadFence);
+	}
 	if (submitResult == VK_ERROR_DEVICE_LOST) {
 		LOGE("vkQueueSubmit(single) reported VK_ERROR_DEVICE_LOST");
 		vkFreeCommandBuffers(g.device, g.uploadCommandPool, 1, &cmd);
 		return;
 	}
 	check(submitResult, "vkQueueSubmit(single)");
-	check(vkQueueWaitIdle(g.graphicsQueue), "vkQueueWaitIdle(single)");
+	check(vkWaitForFences(g.device, 1, &g.uploadFence, VK_TRUE, UINT64_MAX), "vkWaitForFences(single)");
+	check(vkResetFences(g.device, 1, &g.uploadFence), "vkResetFences(single)");
 	vkFreeCommandBuffers(g.device, g.uploadCommandPool, 1, &cmd);
 }
 
@@ -284,7 +731,7 @@ static bool hasStencilComponent(VkFormat format) {
 	return format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT;
 }
 
-static void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, VkImageAspectFlags aspectMask) {
+static void recordImageLayoutTransition(VkCommandBuffer cmd, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, VkImageAspectFlags aspectMask, uint32_t mipLevels) {
 	VkImageAspectFlags resolvedAspect = aspectMask;
 	if ((aspectMask & VK_IMAGE_ASPECT_DEPTH_BIT) && hasStencilComponent(format)) {
 		resolvedAspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
@@ -292,8 +739,6 @@ static void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout
 	if (!resolvedAspect) {
 		resolvedAspect = VK_IMAGE_ASPECT_COLOR_BIT;
 	}
-	VkCommandBuffer cmd = beginSingleTimeCommands();
-	if (!cmd) return;
 
 	VkImageMemoryBarrier barrier{};
 	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -304,7 +749,7 @@ static void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout
 	barrier.image = image;
 	barrier.subresourceRange.aspectMask = resolvedAspect;
 	barrier.subresourceRange.baseMipLevel = 0;
-	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.levelCount = mipLevels;
 	barrier.subresourceRange.baseArrayLayer = 0;
 	barrier.subresourceRange.layerCount = 1;
 
@@ -338,34 +783,108 @@ static void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout
 		0, nullptr,
 		0, nullptr,
 		1, &barrier);
-
-	endSingleTimeCommands(cmd);
 }
 
-static void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height) {
+static void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, VkImageAspectFlags aspectMask, uint32_t mipLevels = 1) {
 	VkCommandBuffer cmd = beginSingleTimeCommands();
 	if (!cmd) return;
+	recordImageLayoutTransition(cmd, image, format, oldLayout, newLayout, aspectMask, mipLevels);
+	endSingleTimeCommands(cmd);
+}
 
-	VkBufferImageCopy region{};
-	region.bufferOffset = 0;
-	region.bufferRowLength = 0;
-	region.bufferImageHeight = 0;
-	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	region.imageSubresource.mipLevel = 0;
-	region.imageSubresource.baseArrayLayer = 0;
-	region.imageSubresource.layerCount = 1;
-	region.imageOffset = {0, 0, 0};
-	region.imageExtent = {width, height, 1};
+// Level offsets are relative to bufferOffset.
+static void recordCopyBufferToImage(VkCommandBuffer cmd, VkBuffer buffer, VkDeviceSize bufferOffset, VkImage image, const std::vector<SMipLevel>& levels) {
+	std::vector<VkBufferImageCopy> regions(levels.size());
+	for (size_t i = 0; i < levels.size(); ++i) {
+		VkBufferImageCopy& region = regions[i];
+		region.bufferOffset = bufferOffset + static_cast<VkDeviceSize>(levels[i].uOffset);
+		region.bufferRowLength = 0;
+		region.bufferImageHeight = 0;
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel = static_cast<uint32_t>(i);
+		region.imageSubresource.baseArrayLayer = 0;
+		region.imageSubresource.layerCount = 1;
+		region.imageOffset = {0, 0, 0};
+		region.imageExtent = {levels[i].uWidth, levels[i].uHeight, 1};
+	}
 
 	vkCmdCopyBufferToImage(
 		cmd,
 		buffer,
 		image,
 		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-		1,
-		&region);
+		static_cast<uint32_t>(regions.size()),
+		regions.data());
+}
 
-	endSingleTimeCommands(cmd);
+static bool supportsLinearBlit(VkFormat format) {
+	VkFormatProperties props{};
+	vkGetPhysicalDeviceFormatProperties(g.physicalDevice, format, &props);
+	const VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+		VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+	return (props.optimalTilingFeatures & required) == required;
+}
+
+// Expects every level in TRANSFER_DST_OPTIMAL with level 0 filled. Each level is
+// blitted from the previous one and all levels end in SHADER_READ_ONLY_OPTIMAL.
+static void recordMipmapBlits(VkCommandBuffer cmd, VkImage image, uint32_t width, uint32_t height, uint32_t mipLevels) {
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = 1;
+
+	int32_t mipWidth = static_cast<int32_t>(width);
+	int32_t mipHeight = static_cast<int32_t>(height);
+	for (uint32_t level = 1; level < mipLevels; ++level) {
+		barrier.subresourceRange.baseMipLevel = level - 1;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+			0, nullptr, 0, nullptr, 1, &barrier);
+
+		const int32_t nextWidth = std::max(mipWidth / 2, 1);
+		const int32_t nextHeight = std::max(mipHeight / 2, 1);
+		VkImageBlit blit{};
+		blit.srcOffsets[1] = {mipWidth, mipHeight, 1};
+		blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.srcSubresource.mipLevel = level - 1;
+		blit.srcSubresource.baseArrayLayer = 0;
+		blit.srcSubresource.layerCount = 1;
+		blit.dstOffsets[1] = {nextWidth, nextHeight, 1};
+		blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.dstSubresource.mipLevel = level;
+		blit.dstSubresource.baseArrayLayer = 0;
+		blit.dstSubresource.layerCount = 1;
+		vkCmdBlitImage(cmd,
+			image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			1, &blit, VK_FILTER_LINEAR);
+
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+			0, nullptr, 0, nullptr, 1, &barrier);
+
+		mipWidth = nextWidth;
+		mipHeight = nextHeight;
+	}
+
+	barrier.subresourceRange.baseMipLevel = mipLevels - 1;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+		0, nullptr, 0, nullptr, 1, &barrier);
 }
 
 static void createUploadCommandPoolIfNeeded() {
@@ -375,6 +894,162 @@ static void createUploadCommandPoolIfNeeded() {
 	info.queueFamilyIndex = g.graphicsQueueFamily;
 	info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
 	check(vkCreateCommandPool(g.device, &info, nullptr, &g.uploadCommandPool), "vkCreateCommandPool(upload)");
+	info.queueFamilyIndex = g.transferQueueFamily;
+	check(vkCreateCommandPool(g.device, &info, nullptr, &g.transferCommandPool), "vkCreateCommandPool(transfer)");
+
+	VkFenceCreateInfo fenceInfo{};
+	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	check(vkCreateFence(g.device, &fenceInfo, nullptr, &g.uploadFence), "vkCreateFence(upload)");
+}
+
+// Uploads on a transfer-only family hand their resources over to the graphics
+// family with a release barrier there and a matching acquire in a frame.
+static bool uploadsTransferOwnership() {
+	return g.transferQueueFamily != g.graphicsQueueFamily;
+}
+
+// The batch uploads are recorded into, opened on first use after the last
+// submitUploadBatch().
+static UploadBatch& openUploadBatch() {
+	if (!g.uploadBatches.empty() && !g.uploadBatches.back().submitted) {
+		return g.uploadBatches.back();
+	}
+	UploadBatch batch;
+	VkCommandBufferAllocateInfo alloc{};
+	alloc.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	alloc.commandPool = g.transferCommandPool;
+	alloc.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	alloc.commandBufferCount = 1;
+	check(vkAllocateCommandBuffers(g.device, &alloc, &batch.cmd), "vkAllocateCommandBuffers(transfer)");
+	VkCommandBufferBeginInfo begin{};
+	begin.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	check(vkBeginCommandBuffer(batch.cmd, &begin), "vkBeginCommandBuffer(transfer)");
+
+	if (!g.freeUploadFences.empty()) {
+		batch.fence = g.freeUploadFences.back();
+		g.freeUploadFences.pop_back();
+	} else {
+		VkFenceCreateInfo fenceInfo{};
+		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		check(vkCreateFence(g.device, &fenceInfo, nullptr, &batch.fence), "vkCreateFence(transfer)");
+	}
+	if (uploadsTransferOwnership()) {
+		if (!g.freeUploadSemaphores.empty()) {
+			batch.semaphore = g.freeUploadSemaphores.back();
+			g.freeUploadSemaphores.pop_back();
+		} else {
+			VkSemaphoreCreateInfo semaphoreInfo{};
+			semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+			check(vkCreateSemaphore(g.device, &semaphoreInfo, nullptr, &batch.semaphore), "vkCreateSemaphore(transfer)");
+		}
+	}
+	g.uploadBatches.push_back(std::move(batch));
+	return g.uploadBatches.back();
+}
+
+// Submits the open batch, if any, without waiting for it.
+static VkResult submitUploadBatch() {
+	if (g.uploadBatches.empty() || g.uploadBatches.back().submitted) return VK_SUCCESS;
+	UploadBatch& batch = g.uploadBatches.back();
+	batch.submitted = true;
+	check(vkEndCommandBuffer(batch.cmd), "vkEndCommandBuffer(transfer)");
+	VkSubmitInfo submit{};
+	submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submit.commandBufferCount = 1;
+	submit.pCommandBuffers = &batch.cmd;
+	if (batch.semaphore) {
+		submit.signalSemaphoreCount = 1;
+		submit.pSignalSemaphores = &batch.semaphore;
+	}
+	VkResult submitResult = VK_SUCCESS;
+	{
+		std::lock_guard<std::mutex> queueGuard(g_queueMutex);
+		submitResult = vkQueueSubmit(g.transferQueue, 1, &submit, batch.fence);
+	}
+	batch.submitResult = submitResult;
+	if (submitResult == VK_ERROR_DEVICE_LOST) {
+		LOGE("vkQueueSubmit(transfer) reported VK_ERROR_DEVICE_LOST");
+		return submitResult;
+	}
+	check(submitResult, "vkQueueSubmit(transfer)");
+	return submitResult;
+}
+
+// Frees what only the copies needed; the fence and semaphore go back to their
+// free lists once unused.
+static void releaseUploadBatch(UploadBatch& batch) {
+	for (VkBuffer buffer : batch.stagingBuffers) {
+		vkDestroyBuffer(g.device, buffer, nullptr);
+	}
+	for (GpuAllocation& memory : batch.stagingMemory) {
+		freeGpuMemory(memory);
+	}
+	batch.stagingBuffers.clear();
+	batch.stagingMemory.clear();
+	batch.stagingBlocks.clear();
+	vkFreeCommandBuffers(g.device, g.transferCommandPool, 1, &batch.cmd);
+	batch.cmd = VK_NULL_HANDLE;
+	check(vkResetFences(g.device, 1, &batch.fence), "vkResetFences(transfer)");
+	g.freeUploadFences.push_back(batch.fence);
+	batch.fence = VK_NULL_HANDLE;
+}
+
+// Only once the device is idle.
+static void destroyUploadBatches() {
+	for (UploadBatch& batch : g.uploadBatches) {
+		for (UploadedTexture& uploaded : batch.textures) {
+			if (uploaded.texture.image) vkDestroyImage(g.device, uploaded.texture.image, nullptr);
+			freeGpuMemory(uploaded.texture.memory);
+			g.residentTextureBytes -= uploaded.texture.memoryBytes;
+		}
+		releaseUploadBatch(batch);
+		if (batch.semaphore) g.freeUploadSemaphores.push_back(batch.semaphore);
+	}
+	g.uploadBatches.clear();
+	for (VkSemaphore semaphore : g.freeUploadSemaphores) {
+		vkDestroySemaphore(g.device, semaphore, nullptr);
+	}
+	g.freeUploadSemaphores.clear();
+	for (VkFence fence : g.freeUploadFences) {
+		vkDestroyFence(g.device, fence, nullptr);
+	}
+	g.freeUploadFences.clear();
+}
+
+// Ownership transfer of a texture from the transfer family to the graphics
+// family. The release (on the transfer queue) and the acquire (in a frame) must
+// use the same layouts.
+static void recordTextureOwnershipTransfer(VkCommandBuffer cmd, const TextureResource& texture, VkImageLayout newLayout, bool release) {
+	const bool toTransfer = newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcAccessMask = release ? VK_ACCESS_TRANSFER_WRITE_BIT : 0;
+	barrier.dstAccessMask = release ? 0 : toTransfer ? VK_ACCESS_TRANSFER_WRITE_BIT : VK_ACCESS_SHADER_READ_BIT;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout = newLayout;
+	barrier.srcQueueFamilyIndex = g.transferQueueFamily;
+	barrier.dstQueueFamilyIndex = g.graphicsQueueFamily;
+	barrier.image = texture.image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseMipLevel = 0;
+	barrier.subresourceRange.levelCount = texture.mipLevels;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = 1;
+	const VkPipelineStageFlags dstStage = release ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT
+		: toTransfer ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStage, 0,
+		0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+// Makes geometry copied by earlier transfer commands readable by vertex input.
+static void recordGeometryUploadBarrier(VkCommandBuffer cmd) {
+	VkMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+	vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0,
+		1, &barrier, 0, nullptr, 0, nullptr);
 }
 
 static void createTextureDescriptorSetLayoutIfNeeded() {
@@ -382,232 +1057,865 @@ static void createTextureDescriptorSetLayoutIfNeeded() {
 	VkDescriptorSetLayoutBinding binding{};
 	binding.binding = 0;
 	binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	binding.descriptorCount = 1;
+	binding.descriptorCount = g.textureTableCapacity > 0 ? g.textureTableCapacity : 1;
 	binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-	binding.pImmutableSamplers = nullptr;
+	// Every texture uses the same sampler, so it is baked into the layout.
+	const std::vector<VkSampler> immutableSamplers(binding.descriptorCount, getTextureSampler());
+	binding.pImmutableSamplers = immutableSamplers.data();
 
 	VkDescriptorSetLayoutCreateInfo info{};
 	info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
 	info.bindingCount = 1;
 	info.pBindings = &binding;
+	// Table elements are written while frames that sample other elements are
+	// in flight, and unused elements may hold nothing or destroyed textures.
+	const VkDescriptorBindingFlags tableFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+		VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+	VkDescriptorSetLayoutBindingFlagsCreateInfo flagsInfo{};
+	flagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+	flagsInfo.bindingCount = 1;
+	flagsInfo.pBindingFlags = &tableFlags;
+	if (g.textureTableCapacity > 0) {
+		info.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+		info.pNext = &flagsInfo;
+	}
 	check(vkCreateDescriptorSetLayout(g.device, &info, nullptr, &g.textureDescriptorSetLayout), "vkCreateDescriptorSetLayout(texture)");
 }
 
+// Per-texture sets come from allocateTextureSet(); only the texture table needs
+// its pool up front.
 static void createTextureDescriptorPoolIfNeeded() {
-	if (g.textureDescriptorPool || !g.device) return;
-	const uint32_t maxTextures = 256;
+	if (g.textureDescriptorPool || g.textureTableCapacity == 0 || !g.device) return;
 	VkDescriptorPoolSize poolSize{};
 	poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	poolSize.descriptorCount = maxTextures;
+	poolSize.descriptorCount = g.textureTableCapacity;
 
 	VkDescriptorPoolCreateInfo info{};
 	info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
 	info.poolSizeCount = 1;
 	info.pPoolSizes = &poolSize;
-	info.maxSets = maxTextures;
-	info.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
-	check(vkCreateDescriptorPool(g.device, &info, nullptr, &g.textureDescriptorPool), "vkCreateDescriptorPool(texture)");
-}
-
-static size_t createTextureFromPixels(const std::string& key, uint32_t width, uint32_t height, const unsigned char* pixels, size_t size) {
-	createUploadCommandPoolIfNeeded();
-	createTextureDescriptorSetLayoutIfNeeded();
-	createTextureDescriptorPoolIfNeeded();
-	if (!g.device) return INVALID_TEXTURE_INDEX;
-
-	VkBuffer stagingBuffer = VK_NULL_HANDLE;
-	VkDeviceMemory stagingMemory = VK_NULL_HANDLE;
-	createBuffer(static_cast<VkDeviceSize>(size), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-		stagingBuffer, stagingMemory);
-
-	void* data = nullptr;
-	check(vkMapMemory(g.device, stagingMemory, 0, static_cast<VkDeviceSize>(size), 0, &data), "vkMapMemory(texture staging)");
-	std::memcpy(data, pixels, size);
-	vkUnmapMemory(g.device, stagingMemory);
-
-	TextureResource texture;
-	texture.key = key;
-	texture.width = width;
-	texture.height = height;
+	info.maxSets = 1;
+	info.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+	check(vkCreateDescriptorPool(g.device, &info, nullptr, &g.textureDescriptorPool), "vkCreateDescriptorPool(texture table)");
 
-	createImage(width, height, VK_FORMAT_R8G8B8A8_UNORM,
-		VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-		texture.image, texture.memory);
+	VkDescriptorSetAllocateInfo alloc{};
+	alloc.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	alloc.descriptorPool = g.textureDescriptorPool;
+	alloc.descriptorSetCount = 1;
+	alloc.pSetLayouts = &g.textureDescriptorSetLayout;
+	check(vkAllocateDescriptorSets(g.device, &alloc, &g.textureTableSet), "vkAllocateDescriptorSets(texture table)");
+}
 
-	transitionImageLayout(texture.image, VK_FORMAT_R8G8B8A8_UNORM,
-		VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT);
-	copyBufferToImage(stagingBuffer, texture.image, width, height);
-	transitionImageLayout(texture.image, VK_FORMAT_R8G8B8A8_UNORM,
-		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT);
+static void logTextureSetOccupancy() {
+	uint32_t capacity = 0;
+	uint32_t allocated = 0;
+	for (const DescriptorPoolBlock& block : g.textureSetPools) {
+		capacity += block.capacity;
+		allocated += block.allocated;
+	}
+	LOGI("Texture descriptor pools: %zu pools, %u of %u sets allocated, %zu recycled sets free",
+		g.textureSetPools.size(), allocated, capacity, g.freeTextureSets.size());
+}
 
-	vkDestroyBuffer(g.device, stagingBuffer, nullptr);
-	vkFreeMemory(g.device, stagingMemory, nullptr);
+static DescriptorPoolBlock& addTextureSetPool() {
+	// Each pool is twice the previous one, so thousands of textures need few pools.
+	const uint32_t firstPoolSets = 256;
+	const uint32_t maxPoolSets = 4096;
+	const uint32_t capacity = g.textureSetPools.empty() ? firstPoolSets : std::min(maxPoolSets, std::max(firstPoolSets, g.textureSetPools.back().capacity * 2));
+	VkDescriptorPoolSize poolSize{};
+	poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	poolSize.descriptorCount = capacity;
 
-	texture.view = createImageView(texture.image, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT);
-	texture.sampler = createSampler();
+	VkDescriptorPoolCreateInfo info{};
+	info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	info.poolSizeCount = 1;
+	info.pPoolSizes = &poolSize;
+	info.maxSets = capacity;
+	DescriptorPoolBlock block;
+	block.capacity = capacity;
+	check(vkCreateDescriptorPool(g.device, &info, nullptr, &block.pool), "vkCreateDescriptorPool(texture)");
+	g.textureSetPools.push_back(block);
+	logTextureSetOccupancy();
+	return g.textureSetPools.back();
+}
 
+// Returns a recycled texture set, or allocates one from the newest pool and
+// chains another pool when that one is exhausted.
+static VkDescriptorSet allocateTextureSet() {
+	if (!g.freeTextureSets.empty()) {
+		VkDescriptorSet set = g.freeTextureSets.back();
+		g.freeTextureSets.pop_back();
+		return set;
+	}
 	VkDescriptorSetAllocateInfo alloc{};
 	alloc.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-	alloc.descriptorPool = g.textureDescriptorPool;
 	alloc.descriptorSetCount = 1;
 	alloc.pSetLayouts = &g.textureDescriptorSetLayout;
-	check(vkAllocateDescriptorSets(g.device, &alloc, &texture.descriptorSet), "vkAllocateDescriptorSets(texture)");
+	VkDescriptorSet set = VK_NULL_HANDLE;
+	if (!g.textureSetPools.empty() && g.textureSetPools.back().allocated < g.textureSetPools.back().capacity) {
+		DescriptorPoolBlock& block = g.textureSetPools.back();
+		alloc.descriptorPool = block.pool;
+		VkResult result = vkAllocateDescriptorSets(g.device, &alloc, &set);
+		if (result == VK_SUCCESS) {
+			++block.allocated;
+			return set;
+		}
+		if (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL) {
+			check(result, "vkAllocateDescriptorSets(texture)");
+		}
+		// The driver ran out before maxSets; stop handing out from this pool.
+		block.capacity = block.allocated;
+	}
+	DescriptorPoolBlock& block = addTextureSetPool();
+	alloc.descriptorPool = block.pool;
+	check(vkAllocateDescriptorSets(g.device, &alloc, &set), "vkAllocateDescriptorSets(texture)");
+	++block.allocated;
+	return set;
+}
 
-	VkDescriptorImageInfo imageInfo{};
-	imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-	imageInfo.imageView = texture.view;
-	imageInfo.sampler = texture.sampler;
+struct TextureUpload {
+	std::string key;
+	const STextureData* source = nullptr;
+	// Set for file textures so they can be streamed back in after eviction.
+	std::string sourcePath;
+	bool preview = false;
+};
 
-	VkWriteDescriptorSet write{};
-	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	write.dstSet = texture.descriptorSet;
-	write.dstBinding = 0;
-	write.dstArrayElement = 0;
-	write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	write.descriptorCount = 1;
-	write.pImageInfo = &imageInfo;
-	vkUpdateDescriptorSets(g.device, 1, &write, 0, nullptr);
+// Staging memory for one submission; larger batches are split, and a single
+// texture above the limit gets a submission of its own.
+static constexpr VkDeviceSize MAX_TEXTURE_STAGING_BYTES = 64ull * 1024 * 1024;
+// Covers every texel block size we upload and the 4-byte copy offset rule.
+static constexpr VkDeviceSize TEXTURE_STAGING_ALIGNMENT = 16;
+// Persistently mapped; the load pipeline decodes and encodes into it.
+static constexpr VkDeviceSize TEXTURE_STAGING_RING_BYTES = 32ull * 1024 * 1024;
 
-	const size_t index = g.textures.size();
-	g.textures.push_back(texture);
-	g.textureCache[key] = index;
-	return index;
+static void createStagingRing() {
+	createBuffer(TEXTURE_STAGING_RING_BYTES, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		g.stagingRingBuffer, g.stagingRingMemory);
+	g.stagingRing = StagingRing::create(g.stagingRingMemory.mapped, static_cast<size_t>(TEXTURE_STAGING_RING_BYTES));
 }
 
-static size_t ensureTextureForMaterial(const Material& material) {
-	std::string key;
-	if (!material.diffuseTexture.empty()) {
-		key = "file:" + material.diffuseTexture;
-		auto it = g.textureCache.find(key);
-		if (it != g.textureCache.end()) {
-			return it->second;
+// Blocks still held elsewhere only touch the ring's bookkeeping, never the
+// unmapped memory.
+static void destroyStagingRing() {
+	g.stagingRing.reset();
+	if (!g.device) return;
+	freeGpuMemory(g.stagingRingMemory);
+	if (g.stagingRingBuffer) {
+		vkDestroyBuffer(g.device, g.stagingRingBuffer, nullptr);
+		g.stagingRingBuffer = VK_NULL_HANDLE;
+	}
+}
+
+// Records the upload of textures[first, last) into the open upload batch.
+// Textures already in the staging ring are copied from there; the rest share
+// one temporary staging buffer, both kept until the batch completes. A single
+// RGBA8 level gets a mip chain generated on the GPU; any other input
+// (compressed, pre-mipped KTX2 or chains built by the load pipeline) is copied
+// as is.
+static void uploadTextureBatch(const std::vector<TextureUpload>& uploads, size_t first, size_t last) {
+	struct PendingTexture {
+		const TextureUpload* upload = nullptr;
+		VkFormat format = VK_FORMAT_UNDEFINED;
+		std::vector<SMipLevel> levels;
+		bool gpuMipmaps = false;
+		std::vector<uint8_t> chain;
+		bool inRing = false;
+		VkDeviceSize stagingOffset = 0;
+		TextureResource texture;
+	};
+
+	std::vector<PendingTexture> pending;
+	pending.reserve(last - first);
+	VkDeviceSize stagingSize = 0;
+	for (size_t i = first; i < last; ++i) {
+		const STextureData& source = *uploads[i].source;
+		PendingTexture item;
+		item.upload = &uploads[i];
+		item.format = static_cast<VkFormat>(source.uVkFormat);
+		const uint32_t width = source.vecLevels[0].uWidth;
+		const uint32_t height = source.vecLevels[0].uHeight;
+		const bool buildMips = item.format == VK_FORMAT_R8G8B8A8_UNORM && source.vecLevels.size() == 1;
+
+		item.levels = source.vecLevels;
+		if (buildMips) {
+			mipChainLayout(width, height, 4, item.levels);
+		}
+		const uint32_t mipLevels = static_cast<uint32_t>(item.levels.size());
+		item.gpuMipmaps = buildMips && mipLevels > 1 && supportsLinearBlit(item.format);
+
+		// Without linear blit support the whole chain is built on the CPU and
+		// copied in one go.
+		if (buildMips && !item.gpuMipmaps && mipLevels > 1) {
+			item.chain.resize(item.levels.back().uOffset + item.levels.back().uSize);
+			std::memcpy(item.chain.data(), source.bytes(), std::min(source.byteSize(), item.levels[0].uSize));
+			generateMipChainRgba8(item.chain.data(), item.levels);
 		}
 
-		std::vector<unsigned char> pixels;
-		int width = 0;
-		int height = 0;
-		if (LoadImageFromFile(material.diffuseTexture, 4, pixels, width, height)) {
-			const size_t size = static_cast<size_t>(width) * static_cast<size_t>(height) * 4;
-			if (size == pixels.size()) {
-				return createTextureFromPixels(key, static_cast<uint32_t>(width), static_cast<uint32_t>(height), pixels.data(), pixels.size());
-			}
+		item.texture.key = item.upload->key;
+		item.texture.width = width;
+		item.texture.height = height;
+		item.texture.mipLevels = mipLevels;
+		if (item.gpuMipmaps) {
+			item.levels.resize(1);
+		}
+
+		item.inRing = source.pStaging && item.chain.empty() && g.stagingRingBuffer;
+		if (item.inRing) {
+			item.stagingOffset = static_cast<VkDeviceSize>(source.pStaging->offset());
+		} else {
+			const size_t uploadSize = item.chain.empty() ? source.byteSize() : item.chain.size();
+			item.stagingOffset = stagingSize;
+			stagingSize = (stagingSize + uploadSize + TEXTURE_STAGING_ALIGNMENT - 1) & ~(TEXTURE_STAGING_ALIGNMENT - 1);
+		}
+		pending.push_back(std::move(item));
+	}
+
+	VkBuffer stagingBuffer = VK_NULL_HANDLE;
+	GpuAllocation stagingMemory;
+	if (stagingSize > 0) {
+		createBuffer(stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			stagingBuffer, stagingMemory);
+
+		for (PendingTexture& item : pending) {
+			if (item.inRing) continue;
+			const STextureData& source = *item.upload->source;
+			const unsigned char* uploadData = item.chain.empty() ? source.bytes() : item.chain.data();
+			const size_t uploadSize = item.chain.empty() ? source.byteSize() : item.chain.size();
+			std::memcpy(stagingMemory.mapped + item.stagingOffset, uploadData, uploadSize);
+			std::vector<uint8_t>().swap(item.chain);
+		}
+	}
+
+	UploadBatch& batch = openUploadBatch();
+	VkCommandBuffer cmd = batch.cmd;
+	for (PendingTexture& item : pending) {
+		TextureResource& texture = item.texture;
+		VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+		if (item.gpuMipmaps) {
+			usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+		}
+		createImage(texture.width, texture.height, texture.mipLevels, item.format, usage, texture.image, texture.memory);
+		texture.memoryBytes = texture.memory.size;
+		texture.sourcePath = item.upload->sourcePath;
+		texture.preview = item.upload->preview;
+		texture.lastUsedFrame = g.currentFrame;
+		g.residentTextureBytes += texture.memory.size;
+
+		recordImageLayoutTransition(cmd, texture.image, item.format,
+			VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT, texture.mipLevels);
+		recordCopyBufferToImage(cmd, item.inRing ? g.stagingRingBuffer : stagingBuffer, item.stagingOffset, texture.image, item.levels);
+		if (uploadsTransferOwnership()) {
+			// Blits need the graphics queue; the frame acquiring the image runs them.
+			recordTextureOwnershipTransfer(cmd, texture,
+				item.gpuMipmaps ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, true);
+		} else if (item.gpuMipmaps) {
+			recordMipmapBlits(cmd, texture.image, texture.width, texture.height, texture.mipLevels);
 		} else {
-			LOGE("Falling back to diffuse color for material %s", material.name.c_str());
+			recordImageLayoutTransition(cmd, texture.image, item.format,
+				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT, texture.mipLevels);
+		}
+		if (item.inRing) {
+			batch.stagingBlocks.push_back(item.upload->source->pStaging);
 		}
+		batch.textures.push_back(UploadedTexture{ std::move(texture), item.format, item.gpuMipmaps });
 	}
+	if (stagingBuffer) {
+		batch.stagingBuffers.push_back(stagingBuffer);
+		batch.stagingMemory.push_back(stagingMemory);
+	}
+}
 
-	const float r = std::clamp(material.diffuseColor[0], 0.0f, 1.0f);
-	const float gCol = std::clamp(material.diffuseColor[1], 0.0f, 1.0f);
-	const float b = std::clamp(material.diffuseColor[2], 0.0f, 1.0f);
-	const unsigned char r8 = static_cast<unsigned char>(r * 255.0f);
-	const unsigned char g8 = static_cast<unsigned char>(gCol * 255.0f);
-	const unsigned char b8 = static_cast<unsigned char>(b * 255.0f);
+static void createTextures(const std::vector<TextureUpload>& uploads) {
+	createUploadCommandPoolIfNeeded();
+	createTextureDescriptorSetLayoutIfNeeded();
+	createTextureDescriptorPoolIfNeeded();
+	if (!g.device) return;
 
-	char buffer[64];
-	std::snprintf(buffer, sizeof(buffer), "color:%u_%u_%u", r8, g8, b8);
-	key = buffer;
-	auto itColor = g.textureCache.find(key);
-	if (itColor != g.textureCache.end()) {
-		return itColor->second;
+	size_t first = 0;
+	VkDeviceSize batchBytes = 0;
+	for (size_t i = 0; i < uploads.size(); ++i) {
+		const VkDeviceSize bytes = uploads[i].source->pStaging ? 0 : uploads[i].source->byteSize();
+		if (i > first && batchBytes + bytes > MAX_TEXTURE_STAGING_BYTES) {
+			uploadTextureBatch(uploads, first, i);
+			submitUploadBatch();
+			first = i;
+			batchBytes = 0;
+		}
+		batchBytes += bytes;
+	}
+	if (first < uploads.size()) {
+		uploadTextureBatch(uploads, first, uploads.size());
 	}
+}
 
-	unsigned char solid[4] = { r8, g8, b8, 255 };
-	return createTextureFromPixels(key, 1, 1, solid, sizeof(solid));
+static std::string textureKeyForFile(const std::string& path) {
+	return "file:" + path;
+}
+
+// Materials without a usable file texture draw with their diffuse colour alone.
+static bool hasFileTexture(const Material& material) {
+	return !material.diffuseTexture.empty() && g.failedTextures.count(textureKeyForFile(material.diffuseTexture)) == 0;
+}
+
+// File textures are decoded by the load pipeline. Until one arrives this returns
+// INVALID_TEXTURE_INDEX and the material draws with its diffuse colour.
+static size_t ensureTextureForMaterial(const Material& material) {
+	if (!hasFileTexture(material)) return INVALID_TEXTURE_INDEX;
+	auto it = g.textureCache.find(textureKeyForFile(material.diffuseTexture));
+	return it != g.textureCache.end() ? it->second : INVALID_TEXTURE_INDEX;
 }
 
 static void destroyTextureResources() {
 	if (!g.device) {
 		g.textures.clear();
 		g.textureCache.clear();
+		g.failedTextures.clear();
+		g.samplers.clear();
 		g.defaultTextureIndex = INVALID_TEXTURE_INDEX;
 		return;
 	}
 	for (auto& texture : g.textures) {
-		if (texture.sampler) vkDestroySampler(g.device, texture.sampler, nullptr);
 		if (texture.view) vkDestroyImageView(g.device, texture.view, nullptr);
 		if (texture.image) vkDestroyImage(g.device, texture.image, nullptr);
-		if (texture.memory) vkFreeMemory(g.device, texture.memory, nullptr);
+		freeGpuMemory(texture.memory);
 	}
 	g.textures.clear();
 	g.textureCache.clear();
+	g.failedTextures.clear();
+	g.residentTextureBytes = 0;
+	g.textureTableSet = VK_NULL_HANDLE;
+	g.freeTableIndices.clear();
+	g.nextTableIndex = 0;
 	if (g.textureDescriptorPool) {
 		vkDestroyDescriptorPool(g.device, g.textureDescriptorPool, nullptr);
 		g.textureDescriptorPool = VK_NULL_HANDLE;
 	}
-	if (g.textureDescriptorSetLayout) {
-		vkDestroyDescriptorSetLayout(g.device, g.textureDescriptorSetLayout, nullptr);
-		g.textureDescriptorSetLayout = VK_NULL_HANDLE;
+	for (const DescriptorPoolBlock& block : g.textureSetPools) {
+		vkDestroyDescriptorPool(g.device, block.pool, nullptr);
+	}
+	g.textureSetPools.clear();
+	g.freeTextureSets.clear();
+	if (g.textureDescriptorSetLayout) {
+		vkDestroyDescriptorSetLayout(g.device, g.textureDescriptorSetLayout, nullptr);
+		g.textureDescriptorSetLayout = VK_NULL_HANDLE;
+	}
+	for (const CachedSampler& cached : g.samplers) {
+		vkDestroySampler(g.device, cached.sampler, nullptr);
+	}
+	g.samplers.clear();
+	if (g.uploadCommandPool) {
+		vkDestroyCommandPool(g.device, g.uploadCommandPool, nullptr);
+		g.uploadCommandPool = VK_NULL_HANDLE;
+	}
+	if (g.transferCommandPool) {
+		vkDestroyCommandPool(g.device, g.transferCommandPool, nullptr);
+		g.transferCommandPool = VK_NULL_HANDLE;
+	}
+	if (g.uploadFence) {
+		vkDestroyFence(g.device, g.uploadFence, nullptr);
+		g.uploadFence = VK_NULL_HANDLE;
+	}
+	g.defaultTextureIndex = INVALID_TEXTURE_INDEX;
+}
+
+static void destroyDepthResources() {
+	if (!g.device) {
+		g.depthImages.clear();
+		g.depthImageMemory.clear();
+		g.depthImageViews.clear();
+		g.depthFormat = VK_FORMAT_UNDEFINED;
+		return;
+	}
+	for (size_t i = 0; i < g.depthImageViews.size(); ++i) {
+		if (g.depthImageViews[i]) {
+			vkDestroyImageView(g.device, g.depthImageViews[i], nullptr);
+		}
+	}
+	for (size_t i = 0; i < g.depthImages.size(); ++i) {
+		if (g.depthImages[i]) {
+			vkDestroyImage(g.device, g.depthImages[i], nullptr);
+		}
+		if (g.depthImageMemory.size() > i) {
+			freeGpuMemory(g.depthImageMemory[i]);
+		}
+	}
+	g.depthImages.clear();
+	g.depthImageMemory.clear();
+	g.depthImageViews.clear();
+	g.depthFormat = VK_FORMAT_UNDEFINED;
+}
+
+static void createDepthResources() {
+	if (!g.device) return;
+	destroyDepthResources();
+	if (g.builder) {
+		g.depthFormat = g.builder->getDepthFormat();
+	}
+	if (g.depthFormat == VK_FORMAT_UNDEFINED) {
+		g.depthFormat = VK_FORMAT_D32_SFLOAT;
+	}
+	g.depthImages.resize(g.swapchainImages.size(), VK_NULL_HANDLE);
+	g.depthImageMemory.resize(g.swapchainImages.size());
+	g.depthImageViews.resize(g.swapchainImages.size(), VK_NULL_HANDLE);
+
+	VkImageAspectFlags aspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+	if (hasStencilComponent(g.depthFormat)) {
+		aspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
+	}
+
+	for (size_t i = 0; i < g.swapchainImages.size(); ++i) {
+		createImage(g.swapchainExtent.width, g.swapchainExtent.height, 1, g.depthFormat,
+			VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, g.depthImages[i], g.depthImageMemory[i]);
+		transitionImageLayout(g.depthImages[i], g.depthFormat, VK_IMAGE_LAYOUT_UNDEFINED,
+			VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, aspect);
+		g.depthImageViews[i] = createImageView(g.depthImages[i], g.depthFormat, aspect, 1);
+	}
+	LOGI("Depth resources recreated for %zu images at %ux%u format=%d", g.swapchainImages.size(), g.swapchainExtent.width, g.swapchainExtent.height, g.depthFormat);
+}
+
+// Releases a texture's device objects but keeps its slot for streaming it back.
+// Frames in flight may still sample it, so they are destroyed, and its set or
+// table element reused, only once those frames have finished.
+static void evictTexture(TextureResource& texture) {
+	deferDeletion([view = texture.view, image = texture.image, memory = texture.memory,
+			descriptorSet = texture.descriptorSet, tableIndex = texture.tableIndex]() mutable {
+		if (view) vkDestroyImageView(g.device, view, nullptr);
+		if (image) vkDestroyImage(g.device, image, nullptr);
+		freeGpuMemory(memory);
+		if (descriptorSet) g.freeTextureSets.push_back(descriptorSet);
+		if (tableIndex != INVALID_TABLE_INDEX) g.freeTableIndices.push_back(tableIndex);
+	});
+	g.residentTextureBytes -= texture.memoryBytes;
+	texture.memory = GpuAllocation{};
+	texture.sampler = VK_NULL_HANDLE;
+	texture.view = VK_NULL_HANDLE;
+	texture.image = VK_NULL_HANDLE;
+	texture.descriptorSet = VK_NULL_HANDLE;
+	texture.tableIndex = INVALID_TABLE_INDEX;
+	texture.memoryBytes = 0;
+	texture.reloadRequested = false;
+}
+
+// Evicts least recently drawn file textures until resident textures fit the
+// budget. Textures drawn by frames still in flight would be streamed straight
+// back in, so they are kept and the budget may be exceeded while everything
+// resident is on screen.
+static void enforceTextureBudget() {
+	if (g_textureBudgetBytes == 0 || g.residentTextureBytes <= g_textureBudgetBytes) return;
+	const uint64_t framesInFlight = g.inFlightFences.size();
+	std::vector<size_t> candidates;
+	for (size_t i = 0; i < g.textures.size(); ++i) {
+		const TextureResource& texture = g.textures[i];
+		if (texture.image && !texture.sourcePath.empty() && texture.lastUsedFrame + framesInFlight < g.currentFrame) {
+			candidates.push_back(i);
+		}
+	}
+	std::sort(candidates.begin(), candidates.end(), [](size_t a, size_t b) {
+		return g.textures[a].lastUsedFrame < g.textures[b].lastUsedFrame;
+	});
+	size_t evicted = 0;
+	VkDeviceSize freed = 0;
+	for (size_t index : candidates) {
+		if (g.residentTextureBytes <= g_textureBudgetBytes) break;
+		freed += g.textures[index].memoryBytes;
+		evictTexture(g.textures[index]);
+		++evicted;
+	}
+	if (evicted > 0) {
+		LOGI("Evicted %zu textures (%llu bytes), %llu of %llu budget bytes resident", evicted,
+			static_cast<unsigned long long>(freed),
+			static_cast<unsigned long long>(g.residentTextureBytes),
+			static_cast<unsigned long long>(g_textureBudgetBytes));
+	}
+}
+
+static void requestTextureReload(TextureResource& texture) {
+	if (texture.reloadRequested || texture.sourcePath.empty()) return;
+	std::shared_ptr<LoadPipeline> pipeline;
+	{
+		std::lock_guard<std::mutex> pipelineGuard(g_loadPipelineMutex);
+		pipeline = g_loadPipeline;
+	}
+	texture.reloadRequested = pipeline && pipeline->reloadTexture(texture.sourcePath);
+}
+
+// Marks a texture as used by the frame being recorded. Returns null for
+// textures that cannot be sampled; evicted ones are queued for streaming.
+static const TextureResource* acquireTextureForDraw(size_t textureIndex) {
+	if (textureIndex >= g.textures.size()) return nullptr;
+	TextureResource& texture = g.textures[textureIndex];
+	if (!texture.image) {
+		requestTextureReload(texture);
+		return nullptr;
+	}
+	if (g.textureTableSet && texture.tableIndex == INVALID_TABLE_INDEX) return nullptr;
+	texture.lastUsedFrame = g.currentFrame;
+	return &texture;
+}
+
+// Pushes a material's constants and binds its texture, or the texture table,
+// unless it is already bound. Returns false when set 0 could not be bound.
+static bool bindMaterial(VkCommandBuffer cmd, const GpuModel& model, size_t materialIndex, VkDescriptorSet& boundSet) {
+	MaterialConstants constants{ { 1.0f, 1.0f, 1.0f, 1.0f }, 0, 0 };
+	if (materialIndex < model.cpu.materials.size()) {
+		const Material& material = model.cpu.materials[materialIndex];
+		std::copy(material.diffuseColor.begin(), material.diffuseColor.end(), constants.baseColorFactor);
+	}
+	const TextureResource* texture = nullptr;
+	if (materialIndex < model.materialTextureIndices.size()) {
+		texture = acquireTextureForDraw(model.materialTextureIndices[materialIndex]);
+	}
+	constants.hasTexture = texture ? 1 : 0;
+	VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+	if (g.textureTableSet) {
+		descriptorSet = g.textureTableSet;
+		constants.textureIndex = texture ? static_cast<int32_t>(texture->tableIndex) : 0;
+	} else if (texture) {
+		descriptorSet = texture->descriptorSet;
+	} else if (!boundSet) {
+		const TextureResource* fallback = acquireTextureForDraw(g.defaultTextureIndex);
+		descriptorSet = fallback ? fallback->descriptorSet : VK_NULL_HANDLE;
+	}
+	if (descriptorSet && descriptorSet != boundSet) {
+		vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, g.pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+		boundSet = descriptorSet;
+	}
+	vkCmdPushConstants(cmd, g.pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, kMaterialConstantsOffset, sizeof(constants), &constants);
+	return boundSet != VK_NULL_HANDLE;
+}
+
+// Models sharing a geometry page are drawn without rebinding its buffers.
+static void bindGeometryPage(VkCommandBuffer cmd, size_t page, size_t& boundPage) {
+	if (page == boundPage) return;
+	const VkDeviceSize offset = 0;
+	vkCmdBindVertexBuffers(cmd, 0, 1, &g.geometryPages[page].vertexBuffer, &offset);
+	vkCmdBindIndexBuffer(cmd, g.geometryPages[page].indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+	boundPage = page;
+}
+
+// Vertex and index space of regular pages; larger models get a page sized to
+// fit them alone.
+static constexpr VkDeviceSize GEOMETRY_PAGE_VERTEX_BYTES = 32ull * 1024 * 1024;
+static constexpr VkDeviceSize GEOMETRY_PAGE_INDEX_BYTES = 16ull * 1024 * 1024;
+
+static VkMemoryPropertyFlags geometryMemoryProperties() {
+	return g.unifiedMemory
+		? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+		: VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+}
+
+static size_t addGeometryPage(VkDeviceSize vertexBytes, VkDeviceSize indexBytes) {
+	GeometryPage page;
+	createBuffer(vertexBytes, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, geometryMemoryProperties(),
+		page.vertexBuffer, page.vertexMemory, true);
+	createBuffer(indexBytes, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, geometryMemoryProperties(),
+		page.indexBuffer, page.indexMemory, true);
+	page.vertexRanges = std::make_unique<TlsfAllocator>(vertexBytes);
+	page.indexRanges = std::make_unique<TlsfAllocator>(indexBytes);
+	g.geometryPages.push_back(std::move(page));
+	LOGI("Geometry arena has %zu pages", g.geometryPages.size());
+	return g.geometryPages.size() - 1;
+}
+
+// Finds room for a model's vertices and indices in one page, adding a page
+// when none has both.
+static bool allocateGeometry(VkDeviceSize vertexBytes, VkDeviceSize indexBytes, GeometrySlice& slice) {
+	auto tryPage = [&](size_t index, GeometrySlice& slice) {
+		GeometryPage& page = g.geometryPages[index];
+		const uint64_t vertexOffset = page.vertexRanges->allocate(vertexBytes, VERTEX_STRIDE);
+		if (vertexOffset == TlsfAllocator::kInvalidOffset) return false;
+		const uint64_t indexOffset = page.indexRanges->allocate(indexBytes, sizeof(uint32_t));
+		if (indexOffset == TlsfAllocator::kInvalidOffset) {
+			page.vertexRanges->free(vertexOffset);
+			return false;
+		}
+		slice.page = index;
+		slice.vertexBytes = vertexBytes;
+		slice.indexBytes = indexBytes;
+		slice.firstVertex = static_cast<int32_t>(vertexOffset / VERTEX_STRIDE);
+		slice.firstIndex = static_cast<uint32_t>(indexOffset / sizeof(uint32_t));
+		return true;
+	};
+	for (size_t i = 0; i < g.geometryPages.size(); ++i) {
+		if (tryPage(i, slice)) return true;
+	}
+	const size_t page = addGeometryPage(std::max(vertexBytes, GEOMETRY_PAGE_VERTEX_BYTES), std::max(indexBytes, GEOMETRY_PAGE_INDEX_BYTES));
+	if (tryPage(page, slice)) return true;
+	LOGE("Geometry arena cannot place %llu vertex and %llu index bytes",
+		static_cast<unsigned long long>(vertexBytes), static_cast<unsigned long long>(indexBytes));
+	slice = GeometrySlice{};
+	return false;
+}
+
+// The model's ranges are reused only after frames in flight have stopped
+// drawing from them.
+static void destroyGpuBuffers(GpuModel& gpuModel) {
+	const GeometrySlice slice = gpuModel.geometry;
+	gpuModel.geometry = GeometrySlice{};
+	if (slice.page >= g.geometryPages.size()) return;
+	deferDeletion([slice]() {
+		GeometryPage& page = g.geometryPages[slice.page];
+		page.vertexRanges->free(static_cast<uint64_t>(slice.firstVertex) * VERTEX_STRIDE);
+		page.indexRanges->free(static_cast<uint64_t>(slice.firstIndex) * sizeof(uint32_t));
+	});
+}
+
+static void destroyGeometryArena() {
+	for (GeometryPage& page : g.geometryPages) {
+		if (page.vertexBuffer) vkDestroyBuffer(g.device, page.vertexBuffer, nullptr);
+		if (page.indexBuffer) vkDestroyBuffer(g.device, page.indexBuffer, nullptr);
+		freeGpuMemory(page.vertexMemory);
+		freeGpuMemory(page.indexMemory);
+	}
+	g.geometryPages.clear();
+}
+
+static void destroyAllModelBuffers() {
+	for (auto& model : g.models) {
+		destroyGpuBuffers(model);
+	}
+}
+
+// Adds a model to g.models, at once where its geometry can be written in
+// place, otherwise once its copies in the open upload batch have completed.
+static void uploadModel(GpuModel&& gpuModel) {
+	if (!g.device || !gpuModel.cpu.hasGeometry()) {
+		g.models.push_back(std::move(gpuModel));
+		return;
+	}
+
+	// The load pipeline interleaves vertices off the render thread; only models
+	// that bypassed it are packed here.
+	std::vector<float> interleaved;
+	if (!gpuModel.cpu.hasPackedVertices()) {
+		packModelVertices(gpuModel.cpu, interleaved);
+	}
+	const std::vector<float>& vertices = gpuModel.cpu.hasPackedVertices() ? gpuModel.cpu.packedVertices : interleaved;
+
+	VkDeviceSize vsize = sizeof(float) * vertices.size();
+	VkDeviceSize isize = sizeof(uint32_t) * gpuModel.cpu.indices.size();
+
+	// Geometry is read every frame, so the arena is device-local: written in
+	// place where that memory is host-visible, copied from staging otherwise.
+	if (!allocateGeometry(vsize, isize, gpuModel.geometry)) {
+		// Kept without geometry so the model id stays valid; it is never drawn.
+		g.models.push_back(std::move(gpuModel));
+		return;
+	}
+	const GeometrySlice& slice = gpuModel.geometry;
+	GeometryPage& page = g.geometryPages[slice.page];
+	const VkDeviceSize vertexOffset = static_cast<VkDeviceSize>(slice.firstVertex) * VERTEX_STRIDE;
+	const VkDeviceSize indexOffset = static_cast<VkDeviceSize>(slice.firstIndex) * sizeof(uint32_t);
+	gpuModel.materialTextureIndices.clear();
+	gpuModel.materialTextureIndices.resize(gpuModel.cpu.materials.size(), INVALID_TEXTURE_INDEX);
+	for (size_t i = 0; i < gpuModel.cpu.materials.size(); ++i) {
+		gpuModel.materialTextureIndices[i] = ensureTextureForMaterial(gpuModel.cpu.materials[i]);
+	}
+	if (g.unifiedMemory) {
+		std::memcpy(page.vertexMemory.mapped + vertexOffset, vertices.data(), static_cast<size_t>(vsize));
+		std::memcpy(page.indexMemory.mapped + indexOffset, gpuModel.cpu.indices.data(), static_cast<size_t>(isize));
+		g.models.push_back(std::move(gpuModel));
+		return;
+	}
+
+	createUploadCommandPoolIfNeeded();
+	UploadBatch& batch = openUploadBatch();
+	VkBuffer stagingBuffer = g.stagingRingBuffer;
+	VkDeviceSize stagingOffset = 0;
+	unsigned char* staging = nullptr;
+	std::shared_ptr<StagingBlock> block = g.stagingRing ? g.stagingRing->allocate(static_cast<size_t>(vsize + isize)) : nullptr;
+	if (block) {
+		stagingOffset = static_cast<VkDeviceSize>(block->offset());
+		staging = block->data();
+		batch.stagingBlocks.push_back(std::move(block));
+	} else {
+		GpuAllocation stagingMemory;
+		createBuffer(vsize + isize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingMemory);
+		staging = stagingMemory.mapped;
+		batch.stagingBuffers.push_back(stagingBuffer);
+		batch.stagingMemory.push_back(stagingMemory);
 	}
-	if (g.uploadCommandPool) {
-		vkDestroyCommandPool(g.device, g.uploadCommandPool, nullptr);
-		g.uploadCommandPool = VK_NULL_HANDLE;
+	std::memcpy(staging, vertices.data(), static_cast<size_t>(vsize));
+	std::memcpy(staging + vsize, gpuModel.cpu.indices.data(), static_cast<size_t>(isize));
+
+	VkBufferCopy vertexCopy{ stagingOffset, vertexOffset, vsize };
+	VkBufferCopy indexCopy{ stagingOffset + vsize, indexOffset, isize };
+	vkCmdCopyBuffer(batch.cmd, stagingBuffer, page.vertexBuffer, 1, &vertexCopy);
+	vkCmdCopyBuffer(batch.cmd, stagingBuffer, page.indexBuffer, 1, &indexCopy);
+	// Pages are concurrent across families, so a separate transfer queue only
+	// needs the frame's semaphore wait and barrier (publishCompletedUploads).
+	if (!uploadsTransferOwnership()) {
+		recordGeometryUploadBarrier(batch.cmd);
 	}
-	g.defaultTextureIndex = INVALID_TEXTURE_INDEX;
+	batch.models.push_back(std::move(gpuModel));
 }
 
-static void destroyDepthResources() {
-	if (!g.device) {
-		g.depthImages.clear();
-		g.depthImageMemory.clear();
-		g.depthImageViews.clear();
-		g.depthFormat = VK_FORMAT_UNDEFINED;
+static void resolvePendingMaterialTextures() {
+	for (auto& model : g.models) {
+		for (size_t i = 0; i < model.materialTextureIndices.size() && i < model.cpu.materials.size(); ++i) {
+			if (model.materialTextureIndices[i] == INVALID_TEXTURE_INDEX) {
+				model.materialTextureIndices[i] = ensureTextureForMaterial(model.cpu.materials[i]);
+			}
+		}
+	}
+}
+
+// Gives a texture whose upload has completed a descriptor and its cache slot.
+static void publishUploadedTexture(UploadedTexture& uploaded) {
+	TextureResource& texture = uploaded.texture;
+	// A preview finishing after its full texture is not needed any more.
+	auto cached = g.textureCache.find(texture.key);
+	if (texture.preview && cached != g.textureCache.end() && g.textures[cached->second].image && !g.textures[cached->second].preview) {
+		evictTexture(texture);
 		return;
 	}
-	for (size_t i = 0; i < g.depthImageViews.size(); ++i) {
-		if (g.depthImageViews[i]) {
-			vkDestroyImageView(g.device, g.depthImageViews[i], nullptr);
+	texture.view = createImageView(texture.image, uploaded.format, VK_IMAGE_ASPECT_COLOR_BIT, texture.mipLevels);
+	texture.sampler = getTextureSampler();
+
+	VkDescriptorImageInfo imageInfo{};
+	imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	imageInfo.imageView = texture.view;
+	imageInfo.sampler = texture.sampler;
+
+	VkWriteDescriptorSet write{};
+	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	if (g.textureTableSet) {
+		// A replaced texture keeps its element until released, so the new
+		// one always takes an element no frame in flight samples.
+		if (!g.freeTableIndices.empty()) {
+			texture.tableIndex = g.freeTableIndices.back();
+			g.freeTableIndices.pop_back();
+		} else if (g.nextTableIndex < g.textureTableCapacity) {
+			texture.tableIndex = g.nextTableIndex++;
+		} else {
+			LOGE("Texture table is full (%u), drawing %s untextured", g.textureTableCapacity, texture.key.c_str());
 		}
+		write.dstSet = g.textureTableSet;
+		write.dstArrayElement = texture.tableIndex;
+	} else {
+		texture.descriptorSet = allocateTextureSet();
+		write.dstSet = texture.descriptorSet;
+		write.dstArrayElement = 0;
 	}
-	for (size_t i = 0; i < g.depthImages.size(); ++i) {
-		if (g.depthImages[i]) {
-			vkDestroyImage(g.device, g.depthImages[i], nullptr);
-		}
-		if (g.depthImageMemory.size() > i && g.depthImageMemory[i]) {
-			vkFreeMemory(g.device, g.depthImageMemory[i], nullptr);
+	write.dstBinding = 0;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	write.descriptorCount = 1;
+	write.pImageInfo = &imageInfo;
+	if (write.dstSet && write.dstArrayElement != INVALID_TABLE_INDEX) {
+		vkUpdateDescriptorSets(g.device, 1, &write, 0, nullptr);
+	}
+
+	// Full textures replacing their preview and textures streamed back in
+	// after eviction take over the old slot, so material indices stay valid.
+	if (cached != g.textureCache.end()) {
+		TextureResource& slot = g.textures[cached->second];
+		if (slot.image) {
+			evictTexture(slot);
 		}
+		slot = std::move(texture);
+	} else {
+		g.textureCache[texture.key] = g.textures.size();
+		g.textures.push_back(std::move(texture));
 	}
-	g.depthImages.clear();
-	g.depthImageMemory.clear();
-	g.depthImageViews.clear();
-	g.depthFormat = VK_FORMAT_UNDEFINED;
 }
 
-static void createDepthResources() {
-	if (!g.device) return;
-	destroyDepthResources();
-	if (g.builder) {
-		g.depthFormat = g.builder->getDepthFormat();
+// Makes completed batches visible to the frame recorded into cmd, oldest first.
+// With a separate transfer family the frame acquires their resources, so its
+// submission also waits on the semaphores added to waitSemaphores.
+static void publishCompletedUploads(VkCommandBuffer cmd, std::vector<VkSemaphore>& waitSemaphores) {
+	bool published = false;
+	while (!g.uploadBatches.empty()) {
+		UploadBatch& batch = g.uploadBatches.front();
+		if (!batch.submitted || vkGetFenceStatus(g.device, batch.fence) != VK_SUCCESS) break;
+		if (batch.semaphore) {
+			for (const UploadedTexture& uploaded : batch.textures) {
+				const TextureResource& texture = uploaded.texture;
+				recordTextureOwnershipTransfer(cmd, texture,
+					uploaded.gpuMipmaps ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false);
+				if (uploaded.gpuMipmaps) {
+					recordMipmapBlits(cmd, texture.image, texture.width, texture.height, texture.mipLevels);
+				}
+			}
+			if (!batch.models.empty()) {
+				recordGeometryUploadBarrier(cmd);
+			}
+			waitSemaphores.push_back(batch.semaphore);
+			// Free to signal again once this frame's wait has executed.
+			deferDeletion([semaphore = batch.semaphore]() {
+				g.freeUploadSemaphores.push_back(semaphore);
+			});
+		}
+		for (UploadedTexture& uploaded : batch.textures) {
+			publishUploadedTexture(uploaded);
+		}
+		for (GpuModel& model : batch.models) {
+			g.models.push_back(std::move(model));
+		}
+		published = published || !batch.textures.empty() || !batch.models.empty();
+		releaseUploadBatch(batch);
+		g.uploadBatches.pop_front();
 	}
-	if (g.depthFormat == VK_FORMAT_UNDEFINED) {
-		g.depthFormat = VK_FORMAT_D32_SFLOAT;
+	if (published) {
+		resolvePendingMaterialTextures();
 	}
-	g.depthImages.resize(g.swapchainImages.size(), VK_NULL_HANDLE);
-	g.depthImageMemory.resize(g.swapchainImages.size(), VK_NULL_HANDLE);
-	g.depthImageViews.resize(g.swapchainImages.size(), VK_NULL_HANDLE);
+}
 
-	VkImageAspectFlags aspect = VK_IMAGE_ASPECT_DEPTH_BIT;
-	if (hasStencilComponent(g.depthFormat)) {
-		aspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
+// Submits the open batch and publishes everything in flight before returning,
+// for the rare upload needed at once. Never called while a frame is recorded.
+// Returns the error of a batch that could not be submitted; its fence would
+// never signal, so it is not waited for.
+static VkResult finishUploads() {
+	VkResult result = submitUploadBatch();
+	for (const UploadBatch& batch : g.uploadBatches) {
+		if (batch.submitResult != VK_SUCCESS) {
+			result = batch.submitResult;
+			continue;
+		}
+		const VkResult waitResult = vkWaitForFences(g.device, 1, &batch.fence, VK_TRUE, UINT64_MAX);
+		if (waitResult == VK_ERROR_DEVICE_LOST) return waitResult;
+		check(waitResult, "vkWaitForFences(transfer)");
 	}
+	if (result != VK_SUCCESS) return result;
+	std::vector<VkSemaphore> waitSemaphores;
+	VkCommandBuffer cmd = beginSingleTimeCommands();
+	publishCompletedUploads(cmd, waitSemaphores);
+	endSingleTimeCommands(cmd, waitSemaphores);
+	return VK_SUCCESS;
+}
 
-	for (size_t i = 0; i < g.swapchainImages.size(); ++i) {
-		createImage(g.swapchainExtent.width, g.swapchainExtent.height, g.depthFormat,
-			VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, g.depthImages[i], g.depthImageMemory[i]);
-		transitionImageLayout(g.depthImages[i], g.depthFormat, VK_IMAGE_LAYOUT_UNDEFINED,
-			VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, aspect);
-		g.depthImageViews[i] = createImageView(g.depthImages[i], g.depthFormat, aspect);
+static size_t createTexture(const std::string& key, const STextureData& source) {
+	if (source.vecLevels.empty()) return INVALID_TEXTURE_INDEX;
+	createTextures({ TextureUpload{ key, &source } });
+	if (finishUploads() != VK_SUCCESS) {
+		LOGE("Upload of texture %s was not submitted", key.c_str());
+		return INVALID_TEXTURE_INDEX;
 	}
-	LOGI("Depth resources recreated for %zu images at %ux%u format=%d", g.swapchainImages.size(), g.swapchainExtent.width, g.swapchainExtent.height, g.depthFormat);
+	auto it = g.textureCache.find(key);
+	return it != g.textureCache.end() ? it->second : INVALID_TEXTURE_INDEX;
 }
 
+static size_t createTextureFromPixels(const std::string& key, uint32_t width, uint32_t height, const unsigned char* pixels, size_t size) {
+	STextureData source;
+	SMipLevel level;
+	level.uWidth = width;
+	level.uHeight = height;
+	level.uSize = size;
+	source.vecLevels.push_back(level);
+	source.vecBytes.assign(pixels, pixels + size);
+	return createTexture(key, source);
+}
+
+// Set 0 must be bound even for draws that do not sample it, so untextured
+// draws keep whatever texture is bound, or this 1x1 white one. Created by
+// nativeInit, as its upload is waited for.
 static size_t getDefaultTextureIndex() {
 	if (g.defaultTextureIndex != INVALID_TEXTURE_INDEX) return g.defaultTextureIndex;
-	Material material;
-	material.name = "Default";
-	material.diffuseColor = { 1.0f, 1.0f, 1.0f };
-	material.diffuseTexture.clear();
-	size_t index = ensureTextureForMaterial(material);
+	const unsigned char white[4] = { 255, 255, 255, 255 };
+	size_t index = createTextureFromPixels("default", 1, 1, white, sizeof(white));
 	if (index == INVALID_TEXTURE_INDEX) {
 		return INVALID_TEXTURE_INDEX;
 	}
@@ -615,109 +1923,117 @@ static size_t getDefaultTextureIndex() {
 	return index;
 }
 
-static void destroyGpuBuffers(GpuModel& gpuModel) {
-	if (g.device && gpuModel.indexBuffer) {
-		vkDestroyBuffer(g.device, gpuModel.indexBuffer, nullptr);
-	}
-	if (g.device && gpuModel.indexMemory) {
-		vkFreeMemory(g.device, gpuModel.indexMemory, nullptr);
-	}
-	if (g.device && gpuModel.vertexBuffer) {
-		vkDestroyBuffer(g.device, gpuModel.vertexBuffer, nullptr);
+// Largest texture side worth keeping: phones seldom show more than 2048 pixels
+// of one texture, so only devices with plenty of memory keep up to 4096.
+// requested (from EngineAPI) replaces the policy when non-zero.
+static uint32_t chooseMaxTextureDimension(uint32_t requested) {
+	VkPhysicalDeviceProperties props{};
+	vkGetPhysicalDeviceProperties(g.physicalDevice, &props);
+	VkPhysicalDeviceMemoryProperties memProps{};
+	vkGetPhysicalDeviceMemoryProperties(g.physicalDevice, &memProps);
+	VkDeviceSize deviceLocalBytes = 0;
+	for (uint32_t i = 0; i < memProps.memoryHeapCount; ++i) {
+		if (memProps.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+			deviceLocalBytes = std::max(deviceLocalBytes, memProps.memoryHeaps[i].size);
+		}
 	}
-	if (g.device && gpuModel.vertexMemory) {
-		vkFreeMemory(g.device, gpuModel.vertexMemory, nullptr);
+	uint32_t dimension = deviceLocalBytes >= 6ull * 1024 * 1024 * 1024 ? 4096 : 2048;
+	if (requested != 0) {
+		dimension = requested;
 	}
-	gpuModel.indexBuffer = VK_NULL_HANDLE;
-	gpuModel.indexMemory = VK_NULL_HANDLE;
-	gpuModel.vertexBuffer = VK_NULL_HANDLE;
-	gpuModel.vertexMemory = VK_NULL_HANDLE;
+	dimension = std::min(dimension, props.limits.maxImageDimension2D);
+	LOGI("Textures are limited to %u pixels per side", dimension);
+	return dimension;
 }
 
-static void destroyAllModelBuffers() {
-	for (auto& model : g.models) {
-		destroyGpuBuffers(model);
+// Compressed KTX2 formats the device can sample with linear filtering. Other
+// payloads are expanded to RGBA8 on the load pipeline.
+static std::vector<uint32_t> querySupportedTextureFormats() {
+	const uint32_t candidates[] = {
+		kKtx2FormatAstc4x4Unorm,
+		kKtx2FormatAstc6x6Unorm,
+		kKtx2FormatEtc2R8G8B8A8Unorm,
+		kKtx2FormatEtc2R8G8B8Unorm,
+	};
+	const VkFormatFeatureFlags required = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+	std::vector<uint32_t> formats;
+	for (uint32_t candidate : candidates) {
+		VkFormatProperties props{};
+		vkGetPhysicalDeviceFormatProperties(g.physicalDevice, static_cast<VkFormat>(candidate), &props);
+		if ((props.optimalTilingFeatures & required) == required) {
+			formats.push_back(candidate);
+		}
 	}
+	LOGI("Device samples %zu compressed texture formats", formats.size());
+	return formats;
 }
 
-static void uploadGpuBuffers(GpuModel& gpuModel) {
-	if (!g.device) return;
-	if (!gpuModel.cpu.hasGeometry()) return;
-
-	destroyGpuBuffers(gpuModel);
-
-	const size_t vertexCount = gpuModel.cpu.vertexCount();
-	std::vector<float> interleaved;
-	interleaved.reserve(vertexCount * 8);
-	for (size_t i = 0; i < vertexCount; ++i) {
-		const size_t posIndex = i * 3;
-		const size_t normIndex = i * 3;
-		const size_t uvIndex = i * 2;
-		float px = gpuModel.cpu.positions.size() > posIndex ? gpuModel.cpu.positions[posIndex] : 0.0f;
-		float py = gpuModel.cpu.positions.size() > posIndex + 1 ? gpuModel.cpu.positions[posIndex + 1] : 0.0f;
-		float pz = gpuModel.cpu.positions.size() > posIndex + 2 ? gpuModel.cpu.positions[posIndex + 2] : 0.0f;
-		float nx = gpuModel.cpu.normals.size() > normIndex ? gpuModel.cpu.normals[normIndex] : 0.0f;
-		float ny = gpuModel.cpu.normals.size() > normIndex + 1 ? gpuModel.cpu.normals[normIndex + 1] : 0.0f;
-		float nz = gpuModel.cpu.normals.size() > normIndex + 2 ? gpuModel.cpu.normals[normIndex + 2] : 0.0f;
-		float u = gpuModel.cpu.texcoords.size() > uvIndex ? gpuModel.cpu.texcoords[uvIndex] : 0.0f;
-		float v = gpuModel.cpu.texcoords.size() > uvIndex + 1 ? gpuModel.cpu.texcoords[uvIndex + 1] : 0.0f;
-		interleaved.push_back(px);
-		interleaved.push_back(py);
-		interleaved.push_back(pz);
-		interleaved.push_back(nx);
-		interleaved.push_back(ny);
-		interleaved.push_back(nz);
-		interleaved.push_back(u);
-		interleaved.push_back(v);
-	}
-
-	VkDeviceSize vsize = sizeof(float) * interleaved.size();
-	VkDeviceSize isize = sizeof(uint32_t) * gpuModel.cpu.indices.size();
-
-	createBuffer(vsize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, gpuModel.vertexBuffer, gpuModel.vertexMemory);
-	createBuffer(isize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, gpuModel.indexBuffer, gpuModel.indexMemory);
-
-	void* data = nullptr;
-	check(vkMapMemory(g.device, gpuModel.vertexMemory, 0, vsize, 0, &data), "vkMapMemory(vertex)");
-	std::memcpy(data, interleaved.data(), static_cast<size_t>(vsize));
-	vkUnmapMemory(g.device, gpuModel.vertexMemory);
+// Records the uploads of a batch of results and submits them to the transfer
+// queue without waiting; nativeRender publishes them once they complete.
+static void handleLoadResults(std::vector<SLoadResult>&& results) {
+	std::lock_guard<std::mutex> oGuard(g_stateMutex);
+	if (!g.initialized) {
+		LOGE("Dropping %zu load results because engine was destroyed", results.size());
+		return;
+	}
 
-	check(vkMapMemory(g.device, gpuModel.indexMemory, 0, isize, 0, &data), "vkMapMemory(index)");
-	std::memcpy(data, gpuModel.cpu.indices.data(), static_cast<size_t>(isize));
-	vkUnmapMemory(g.device, gpuModel.indexMemory);
+	std::unordered_set<std::string> fullTexturePaths;
+	for (const SLoadResult& result : results) {
+		if (result.eKind == SLoadResult::EKind::Texture && !result.bPreview) {
+			fullTexturePaths.insert(result.strTexturePath);
+		}
+	}
 
-	gpuModel.materialTextureIndices.clear();
-	gpuModel.materialTextureIndices.resize(gpuModel.cpu.materials.size(), INVALID_TEXTURE_INDEX);
-	for (size_t i = 0; i < gpuModel.cpu.materials.size(); ++i) {
-		size_t textureIndex = ensureTextureForMaterial(gpuModel.cpu.materials[i]);
-		if (textureIndex == INVALID_TEXTURE_INDEX) {
-			textureIndex = getDefaultTextureIndex();
+	std::vector<TextureUpload> uploads;
+	for (SLoadResult& result : results) {
+		if (result.eKind != SLoadResult::EKind::Texture) continue;
+		const std::string key = textureKeyForFile(result.strTexturePath);
+		if (result.bPreview) {
+			// Not needed once the full texture is here or arrives in the same batch.
+			auto it = g.textureCache.find(key);
+			const bool resident = it != g.textureCache.end() && g.textures[it->second].image;
+			if (resident || fullTexturePaths.count(result.strTexturePath) != 0) continue;
 		}
-		gpuModel.materialTextureIndices[i] = textureIndex;
+		const STextureData& texture = result.texture;
+		const bool valid = !texture.vecLevels.empty() &&
+			texture.vecLevels.back().uOffset + texture.vecLevels.back().uSize <= texture.byteSize();
+		if (valid) {
+			uploads.push_back(TextureUpload{ key, &texture, result.strTexturePath, result.bPreview });
+		} else {
+			LOGE("Falling back to diffuse color for texture %s", result.strTexturePath.c_str());
+			g.failedTextures.insert(key);
+		}
+	}
+	if (!uploads.empty()) {
+		createTextures(uploads);
+		enforceTextureBudget();
+	}
+
+	for (SLoadResult& result : results) {
+		if (result.eKind != SLoadResult::EKind::Model) continue;
+		GpuModel oGpuModel;
+		oGpuModel.id = result.llModelId;
+		oGpuModel.cpu = std::move(result.model);
+		uploadModel(std::move(oGpuModel));
 	}
+	submitUploadBatch();
 }
 
 static std::vector<uint32_t> loadSpirvFromAsset(const char* path) {
 	std::vector<uint32_t> words;
-	if (!g.assetManager) return words;
-	AAsset* asset = AAssetManager_open(g.assetManager, path, AASSET_MODE_STREAMING);
-	if (!asset) return words;
-	off_t len = AAsset_getLength(asset);
-	if (len > 0 && (len % 4 == 0)) {
-		words.resize(static_cast<size_t>(len) / 4);
-		int64_t read = AAsset_read(asset, words.data(), len);
-		if (read != len) {
-			words.clear();
-		}
+	if (!g.assetSource) return words;
+	const AssetData data = g.assetSource->open(path);
+	if (data.size() > 0 && (data.size() % 4 == 0)) {
+		words.resize(data.size() / 4);
+		std::memcpy(words.data(), data.data(), data.size());
 	}
-	AAsset_close(asset);
 	return words;
 }
 
 static void buildPipelineWithBuilder() {
 	createTextureDescriptorSetLayoutIfNeeded();
 	auto vert = loadSpirvFromAsset("shaders/triangle.vert.spv");
-	auto frag = loadSpirvFromAsset("shaders/triangle.frag.spv");
+	auto frag = loadSpirvFromAsset(g.textureTableCapacity > 0 ? "shaders/triangle_table.frag.spv" : "shaders/triangle.frag.spv");
 	std::vector<VkDescriptorSetLayout> layouts;
 	if (g.textureDescriptorSetLayout) {
 		layouts.push_back(g.textureDescriptorSetLayout);
@@ -725,6 +2041,7 @@ static void buildPipelineWithBuilder() {
 	g.builder->setVertexSpirv(vert)
 		.setFragmentSpirv(frag)
 		.setDescriptorSetLayouts(layouts)
+		.setTextureTableSize(g.textureTableCapacity)
 		.buildRenderPass()
 		.buildPipeline();
 	g.depthFormat = g.builder->getDepthFormat();
@@ -765,10 +2082,53 @@ static void createCommandPoolBuffers() {
 	check(vkAllocateCommandBuffers(g.device, &ai, g.commandBuffers.data()), "vkAllocateCommandBuffers");
 }
 
-static void recordCommandBuffers() {
+// Draws every model with geometry; expects the render pass and graphics
+// pipeline to be bound.
+static void recordModelDraws(VkCommandBuffer cmd) {
+	VkDescriptorSet boundSet = VK_NULL_HANDLE;
+	size_t boundPage = NO_GEOMETRY_PAGE;
 	const VkExtent2D displayExtent = resolveDisplayExtent(g.swapchainExtent, g.surfaceTransform);
 	const float displayWidth = static_cast<float>(displayExtent.width);
 	const float displayHeight = static_cast<float>(displayExtent.height);
+	for (const auto& model : g.models) {
+		if (!model.cpu.hasGeometry() || model.geometry.page == NO_GEOMETRY_PAGE) {
+			continue;
+		}
+
+		float pushConstants[15] = {
+			g.camera.getYaw(),
+			g.camera.getPitch(),
+			g.camera.getRoll(),
+			displayWidth,
+			displayHeight,
+			g.camera.getPositionX(),
+			g.camera.getPositionY(),
+			g.camera.getPositionZ(),
+			model.cpu.position[0],
+			model.cpu.position[1],
+			model.cpu.position[2],
+			model.cpu.scale,
+			model.cpu.rotation[0],
+			model.cpu.rotation[1],
+			model.cpu.rotation[2]
+		};
+		vkCmdPushConstants(cmd, g.pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(pushConstants), pushConstants);
+
+		bindGeometryPage(cmd, model.geometry.page, boundPage);
+		const GeometrySlice& slice = model.geometry;
+		const auto& subsets = model.cpu.subsets;
+		if (!subsets.empty()) {
+			for (const auto& subset : subsets) {
+				if (!bindMaterial(cmd, model, subset.materialIndex, boundSet)) continue;
+				vkCmdDrawIndexed(cmd, subset.indexCount, 1, slice.firstIndex + subset.indexOffset, slice.firstVertex, 0);
+			}
+		} else if (bindMaterial(cmd, model, 0, boundSet)) {
+			vkCmdDrawIndexed(cmd, static_cast<uint32_t>(model.cpu.indexCount()), 1, slice.firstIndex, slice.firstVertex, 0);
+		}
+	}
+}
+
+static void recordCommandBuffers() {
 	for (size_t i = 0; i < g.commandBuffers.size(); ++i) {
 		VkCommandBufferBeginInfo bi{};
 		bi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -789,73 +2149,7 @@ static void recordCommandBuffers() {
 		// Apply camera viewport/scissor and draw
 		g.camera.applyToCommandBuffer(g.commandBuffers[i]);
 		vkCmdBindPipeline(g.commandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, g.graphicsPipeline);
-		for (const auto& model : g.models) {
-			if (!model.cpu.hasGeometry() || !model.vertexBuffer || !model.indexBuffer) {
-				continue;
-			}
-
-			float pushConstants[15] = {
-				g.camera.getYaw(),
-				g.camera.getPitch(),
-				g.camera.getRoll(),
-				displayWidth,
-				displayHeight,
-				g.camera.getPositionX(),
-				g.camera.getPositionY(),
-				g.camera.getPositionZ(),
-				model.cpu.position[0],
-				model.cpu.position[1],
-				model.cpu.position[2],
-				model.cpu.scale,
-				model.cpu.rotation[0],
-				model.cpu.rotation[1],
-				model.cpu.rotation[2]
-			};
-			vkCmdPushConstants(g.commandBuffers[i], g.pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(pushConstants), pushConstants);
-
-			VkDeviceSize offsets[] = {0};
-			VkBuffer vertexBuffer = model.vertexBuffer;
-			vkCmdBindVertexBuffers(g.commandBuffers[i], 0, 1, &vertexBuffer, offsets);
-		vkCmdBindIndexBuffer(g.commandBuffers[i], model.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-
-		const auto& subsets = model.cpu.subsets;
-		if (!subsets.empty()) {
-			for (const auto& subset : subsets) {
-				size_t textureIndex = getDefaultTextureIndex();
-				if (subset.materialIndex < model.materialTextureIndices.size()) {
-					const size_t mapped = model.materialTextureIndices[subset.materialIndex];
-					if (mapped != INVALID_TEXTURE_INDEX) {
-						textureIndex = mapped;
-					}
-				}
-				if (textureIndex >= g.textures.size()) {
-					textureIndex = getDefaultTextureIndex();
-				}
-				if (textureIndex >= g.textures.size()) {
-					continue;
-				}
-				VkDescriptorSet descriptorSet = g.textures[textureIndex].descriptorSet;
-				if (!descriptorSet) continue;
-				vkCmdBindDescriptorSets(g.commandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, g.pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
-				vkCmdDrawIndexed(g.commandBuffers[i], subset.indexCount, 1, subset.indexOffset, 0, 0);
-			}
-		} else {
-			size_t textureIndex = getDefaultTextureIndex();
-			if (!model.materialTextureIndices.empty()) {
-				const size_t mapped = model.materialTextureIndices[0];
-				if (mapped != INVALID_TEXTURE_INDEX) {
-					textureIndex = mapped;
-				}
-			}
-			if (textureIndex < g.textures.size()) {
-				VkDescriptorSet descriptorSet = g.textures[textureIndex].descriptorSet;
-				if (descriptorSet) {
-					vkCmdBindDescriptorSets(g.commandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, g.pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
-					vkCmdDrawIndexed(g.commandBuffers[i], static_cast<uint32_t>(model.cpu.indexCount()), 1, 0, 0, 0);
-				}
-			}
-		}
-		}
+		recordModelDraws(g.commandBuffers[i]);
 		vkCmdEndRenderPass(g.commandBuffers[i]);
 		check(vkEndCommandBuffer(g.commandBuffers[i]), "vkEndCommandBuffer");
 	}
@@ -879,7 +2173,6 @@ static void createSyncObjects() {
 }
 
 static void cleanupSwapchain() {
-	destroyAllModelBuffers();
 	for (auto f : g.framebuffers) if (f) vkDestroyFramebuffer(g.device, f, nullptr);
 	g.framebuffers.clear();
 	destroyDepthResources();
@@ -889,6 +2182,7 @@ static void cleanupSwapchain() {
 static void recreateSwapchain(uint32_t width, uint32_t height) {
 	std::lock_guard<std::mutex> oGuard(g_stateMutex);
 	vkDeviceWaitIdle(g.device);
+	runDeferredDeletions(true);
 	cleanupSwapchain();
 	g.builder->buildSwapchain(width, height)
 		.buildImageViews();
@@ -900,9 +2194,6 @@ static void recreateSwapchain(uint32_t width, uint32_t height) {
 	g.swapchainImageViews = g.builder->getSwapchainImageViews();
 	g.camera.updateViewport(g.swapchainExtent);
 	buildPipelineWithBuilder();
-	for (auto& model : g.models) {
-		uploadGpuBuffers(model);
-	}
 	createDepthResources();
 	createFramebuffers();
 	createCommandPoolBuffers();
@@ -938,6 +2229,13 @@ Java_lt_smworks_multiplatform3dengine_vulkan_EngineAPI_nativeInit(JNIEnv* env, j
 
 	g.window = ANativeWindow_fromSurface(env, surface);
 	g.assetManager = AAssetManager_fromJava(env, assetManager);
+	auto pApkSource = std::make_shared<ApkAssetSource>(g.assetManager);
+	g.assetSource = pApkSource;
+	if (pApkSource->exists(kDefaultAssetPackName)) {
+		if (auto pPack = PackAssetSource::mount(pApkSource->open(kDefaultAssetPackName), pApkSource)) {
+			g.assetSource = pPack;
+		}
+	}
 	uint32_t width = static_cast<uint32_t>(ANativeWindow_getWidth(g.window));
 	uint32_t height = static_cast<uint32_t>(ANativeWindow_getHeight(g.window));
 
@@ -956,25 +2254,38 @@ Java_lt_smworks_multiplatform3dengine_vulkan_EngineAPI_nativeInit(JNIEnv* env, j
 	g.graphicsQueueFamily = g.builder->getGraphicsQueueFamily();
 	g.device = g.builder->getDevice();
 	g.graphicsQueue = g.builder->getGraphicsQueue();
+	g.transferQueueFamily = g.builder->getTransferQueueFamily();
+	g.transferQueue = g.builder->getTransferQueue();
 	g.swapchain = g.builder->getSwapchain();
 	g.swapchainFormat = g.builder->getSwapchainFormat();
 	g.swapchainExtent = g.builder->getSwapchainExtent();
 	g.surfaceTransform = g.builder->getSurfaceTransform();
 	g.swapchainImages = g.builder->getSwapchainImages();
 	g.swapchainImageViews = g.builder->getSwapchainImageViews();
+	g.textureTableCapacity = g.builder->getTextureTableCapacity();
+	initMemoryAllocator();
 	g.camera.updateViewport(g.swapchainExtent);
 	// Build render pass and pipeline via builder
 	buildPipelineWithBuilder();
 	// proceed with buffers/command buffers
-	for (auto& model : g.models) {
-		uploadGpuBuffers(model);
-	}
 	createDepthResources();
 	createFramebuffers();
 	createCommandPoolBuffers();
 	recordCommandBuffers();
 	createSyncObjects();
+	createStagingRing();
+	getDefaultTextureIndex();
 	g.initialized = true;
+
+	{
+		std::lock_guard<std::mutex> oPipelineGuard(g_loadPipelineMutex);
+		SLoadPipelineOptions options = g_loadPipelineOptions;
+		options.vecTextureFormats = querySupportedTextureFormats();
+		options.bBuildMipChains = !supportsLinearBlit(VK_FORMAT_R8G8B8A8_UNORM);
+		options.uMaxTextureDimension = chooseMaxTextureDimension(g_loadPipelineOptions.uMaxTextureDimension);
+		options.textureAllocator = [ring = g.stagingRing](size_t size) { return ring->allocate(size); };
+		g_loadPipeline = std::make_shared<LoadPipeline>(g.assetSource, handleLoadResults, std::move(options));
+	}
 	const VkExtent2D displayExtent = resolveDisplayExtent(g.swapchainExtent, g.surfaceTransform);
 	LOGI("Vulkan initialized w=%u h=%u swapchain=%ux%u display=%ux%u aspect=%.3f transform=%s (%u)",
 		width, height,
@@ -1017,43 +2328,123 @@ Java_lt_smworks_multiplatform3dengine_vulkan_EngineAPI_nativeLoadModel(JNIEnv* e
 	const float fPosZ = static_cast<float>(z);
 	const int64_t llModelId = static_cast<int64_t>(modelId);
 
-	AAssetManager* pAssetManager = nullptr;
+	std::shared_ptr<LoadPipeline> pPipeline;
 	{
-		std::lock_guard<std::mutex> oGuard(g_stateMutex);
-		pAssetManager = g.assetManager;
+		std::lock_guard<std::mutex> oGuard(g_loadPipelineMutex);
+		pPipeline = g_loadPipeline;
+	}
+	if (!pPipeline) {
+		LOGE("nativeLoadModel called before the engine was initialized");
+		return;
+	}
+
+	SModelLoadRequest oRequest;
+	oRequest.llModelId = llModelId;
+	oRequest.strPath = std::move(strModelPath);
+	oRequest.afPosition[0] = fPosX;
+	oRequest.afPosition[1] = fPosY;
+	oRequest.afPosition[2] = fPosZ;
+	oRequest.fScale = fAppliedScale;
+	pPipeline->enqueue(std::move(oRequest));
+}
+
+JNIEXPORT void JNICALL
+Java_lt_smworks_multiplatform3dengine_vulkan_EngineAPI_nativeBenchmarkModelLoaders(JNIEnv* env, jobject thiz, jobjectArray modelNames, jint iterations) {
+	std::vector<std::string> vecModelNames;
+	const jsize nCount = modelNames ? env->GetArrayLength(modelNames) : 0;
+	for (jsize i = 0; i < nCount; ++i) {
+		jstring jName = static_cast<jstring>(env->GetObjectArrayElement(modelNames, i));
+		if (!jName) continue;
+		const char* pcName = env->GetStringUTFChars(jName, nullptr);
+		if (pcName) {
+			vecModelNames.emplace_back(pcName);
+			env->ReleaseStringUTFChars(jName, pcName);
+		}
+		env->DeleteLocalRef(jName);
 	}
 
-	if (!pAssetManager) {
-		LOGE("nativeLoadModel called before asset manager was ready");
+	std::shared_ptr<const AssetSource> pAssetSource;
+	{
+		std::lock_guard<std::mutex> oGuard(g_stateMutex);
+		pAssetSource = g.assetSource;
+	}
+	if (!pAssetSource || vecModelNames.empty()) {
+		LOGE("nativeBenchmarkModelLoaders called without asset source or models");
 		return;
 	}
 
-	std::thread oLoader([strModelPath = std::move(strModelPath), fPosX, fPosY, fPosZ, fAppliedScale, llModelId, pAssetManager]() mutable {
-		Model oNewModel = loadModel(pAssetManager, strModelPath);
-		if (!oNewModel.hasGeometry()) {
-			LOGE("Model %s has no geometry and will be skipped", strModelPath.c_str());
-			return;
+	const int nIterations = iterations > 0 ? static_cast<int>(iterations) : 1;
+	std::lock_guard<std::mutex> oBenchmarkGuard(g_benchmarkMutex);
+	if (g_benchmarkThread.joinable()) {
+		// Let a running benchmark finish its current load rather than overlap it.
+		g_benchmarkCancel = true;
+		g_benchmarkThread.join();
+	}
+	g_benchmarkCancel = false;
+	g_benchmarkThread = std::thread([vecModelNames = std::move(vecModelNames), pAssetSource = std::move(pAssetSource), nIterations]() {
+		benchmarkModelLoaders(*pAssetSource, vecModelNames, nIterations, &g_benchmarkCancel);
+	});
+}
+
+JNIEXPORT void JNICALL
+Java_lt_smworks_multiplatform3dengine_vulkan_EngineAPI_nativeSetCacheDirectory(JNIEnv* env, jobject thiz, jstring path, jlong maxBytes) {
+	std::string strPath;
+	if (path) {
+		const char* pcPath = env->GetStringUTFChars(path, nullptr);
+		if (pcPath) {
+			strPath = pcPath;
+			env->ReleaseStringUTFChars(path, pcPath);
 		}
+	}
+	ModelCache::instance().configure(strPath, maxBytes > 0 ? static_cast<uint64_t>(maxBytes) : 0);
+}
+
+JNIEXPORT void JNICALL
+Java_lt_smworks_multiplatform3dengine_vulkan_EngineAPI_nativeSetTextureCompression(JNIEnv* env, jobject thiz, jint quality, jlong budgetMillis) {
+	std::lock_guard<std::mutex> oPipelineGuard(g_loadPipelineMutex);
+	g_loadPipelineOptions.bEncodeTextures = quality > 0;
+	if (quality > 0) {
+		g_loadPipelineOptions.eEncodeQuality = static_cast<EEtc2Quality>(std::min<jint>(quality, 3) - 1);
+	}
+	g_loadPipelineOptions.encodeBudgetMs = static_cast<double>(std::max<jlong>(budgetMillis, 0));
+}
 
-		oNewModel.setPosition(fPosX, fPosY, fPosZ);
-		oNewModel.setScale(fAppliedScale);
+// 0 restores the device policy picked in nativeInit.
+JNIEXPORT void JNICALL
+Java_lt_smworks_multiplatform3dengine_vulkan_EngineAPI_nativeSetMaxTextureDimension(JNIEnv* env, jobject thiz, jint maxDimension) {
+	std::lock_guard<std::mutex> oPipelineGuard(g_loadPipelineMutex);
+	g_loadPipelineOptions.uMaxTextureDimension = static_cast<uint32_t>(std::max<jint>(maxDimension, 0));
+}
 
-		GpuModel oGpuModel;
-		oGpuModel.id = llModelId;
-		oGpuModel.cpu = std::move(oNewModel);
+JNIEXPORT void JNICALL
+Java_lt_smworks_multiplatform3dengine_vulkan_EngineAPI_nativeSetTextureMemoryBudget(JNIEnv* env, jobject thiz, jlong maxBytes) {
+	std::lock_guard<std::mutex> oGuard(g_stateMutex);
+	g_textureBudgetBytes = static_cast<VkDeviceSize>(std::max<jlong>(maxBytes, 0));
+}
 
+// Six values per memory heap: heap size, reserved bytes, used bytes, block
+// count, allocation count and dedicated allocation count.
+JNIEXPORT jlongArray JNICALL
+Java_lt_smworks_multiplatform3dengine_vulkan_EngineAPI_nativeGetGpuMemoryUsage(JNIEnv* env, jobject thiz) {
+	std::vector<jlong> values;
+	{
 		std::lock_guard<std::mutex> oGuard(g_stateMutex);
-		if (!g.assetManager) {
-			LOGE("Skipping model %s load because engine was destroyed", strModelPath.c_str());
-			return;
-		}
 		if (g.initialized) {
-			vkDeviceWaitIdle(g.device);
-			uploadGpuBuffers(oGpuModel);
+			for (const HeapUsage& heap : computeHeapUsage()) {
+				values.push_back(static_cast<jlong>(heap.heapSize));
+				values.push_back(static_cast<jlong>(heap.reservedBytes));
+				values.push_back(static_cast<jlong>(heap.usedBytes));
+				values.push_back(heap.blockCount);
+				values.push_back(heap.allocationCount);
+				values.push_back(heap.dedicatedCount);
+			}
 		}
-		g.models.push_back(std::move(oGpuModel));
-	});
-	oLoader.detach();
+	}
+	jlongArray result = env->NewLongArray(static_cast<jsize>(values.size()));
+	if (result && !values.empty()) {
+		env->SetLongArrayRegion(result, 0, static_cast<jsize>(values.size()), values.data());
+	}
+	return result;
 }
 
 JNIEXPORT void JNICALL
@@ -1117,9 +2508,11 @@ JNIEXPORT void JNICALL
 Java_lt_smworks_multiplatform3dengine_vulkan_EngineAPI_nativeRender(JNIEnv* env, jobject thiz) {
 	if (!g.initialized) return;
 	std::unique_lock<std::mutex> stateLock(g_stateMutex);
-	size_t i = g.currentFrame % g.commandBuffers.size();
+	size_t i = static_cast<size_t>(g.currentFrame % g.commandBuffers.size());
 	check(vkWaitForFences(g.device, 1, &g.inFlightFences[i], VK_TRUE, UINT64_MAX), "vkWaitForFences");
 	check(vkResetFences(g.device, 1, &g.inFlightFences[i]), "vkResetFences");
+	runDeferredDeletions(false);
+	enforceTextureBudget();
 
 	uint32_t imageIndex;
 	VkResult acq = vkAcquireNextImageKHR(g.device, g.swapchain, UINT64_MAX, g.imageAvailable[i], VK_NULL_HANDLE, &imageIndex);
@@ -1133,6 +2526,8 @@ Java_lt_smworks_multiplatform3dengine_vulkan_EngineAPI_nativeRender(JNIEnv* env,
 	VkCommandBufferBeginInfo bi{};
 	bi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 	check(vkBeginCommandBuffer(g.commandBuffers[imageIndex], &bi), "vkBeginCommandBuffer");
+	std::vector<VkSemaphore> waitSemaphores{ g.imageAvailable[i] };
+	publishCompletedUploads(g.commandBuffers[imageIndex], waitSemaphores);
 
 	VkClearValue clears[2];
 	clears[0].color = { {0.1f, 0.2f, 0.3f, 1.0f} };
@@ -1150,89 +2545,25 @@ Java_lt_smworks_multiplatform3dengine_vulkan_EngineAPI_nativeRender(JNIEnv* env,
 	// Apply camera viewport/scissor
 	g.camera.applyToCommandBuffer(g.commandBuffers[imageIndex]);
 	vkCmdBindPipeline(g.commandBuffers[imageIndex], VK_PIPELINE_BIND_POINT_GRAPHICS, g.graphicsPipeline);
-	const VkExtent2D displayExtent = resolveDisplayExtent(g.swapchainExtent, g.surfaceTransform);
-	const float displayWidth = static_cast<float>(displayExtent.width);
-	const float displayHeight = static_cast<float>(displayExtent.height);
-	for (const auto& model : g.models) {
-		if (!model.cpu.hasGeometry() || !model.vertexBuffer || !model.indexBuffer) {
-			continue;
-		}
-
-		float pushConstants[15] = {
-			g.camera.getYaw(),
-			g.camera.getPitch(),
-			g.camera.getRoll(),
-			displayWidth,
-			displayHeight,
-			g.camera.getPositionX(),
-			g.camera.getPositionY(),
-			g.camera.getPositionZ(),
-			model.cpu.position[0],
-			model.cpu.position[1],
-			model.cpu.position[2],
-			model.cpu.scale,
-			model.cpu.rotation[0],
-			model.cpu.rotation[1],
-			model.cpu.rotation[2]
-		};
-		vkCmdPushConstants(g.commandBuffers[imageIndex], g.pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(pushConstants), pushConstants);
-
-		VkDeviceSize offsets[] = {0};
-		VkBuffer vertexBuffer = model.vertexBuffer;
-		vkCmdBindVertexBuffers(g.commandBuffers[imageIndex], 0, 1, &vertexBuffer, offsets);
-		vkCmdBindIndexBuffer(g.commandBuffers[imageIndex], model.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-		const auto& subsets = model.cpu.subsets;
-		if (!subsets.empty()) {
-			for (const auto& subset : subsets) {
-				size_t textureIndex = getDefaultTextureIndex();
-				if (subset.materialIndex < model.materialTextureIndices.size()) {
-					const size_t mapped = model.materialTextureIndices[subset.materialIndex];
-					if (mapped != INVALID_TEXTURE_INDEX) {
-						textureIndex = mapped;
-					}
-				}
-				if (textureIndex >= g.textures.size()) {
-					textureIndex = getDefaultTextureIndex();
-				}
-				if (textureIndex >= g.textures.size()) {
-					continue;
-				}
-				VkDescriptorSet descriptorSet = g.textures[textureIndex].descriptorSet;
-				if (!descriptorSet) continue;
-				vkCmdBindDescriptorSets(g.commandBuffers[imageIndex], VK_PIPELINE_BIND_POINT_GRAPHICS, g.pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
-				vkCmdDrawIndexed(g.commandBuffers[imageIndex], subset.indexCount, 1, subset.indexOffset, 0, 0);
-			}
-		} else {
-			size_t textureIndex = getDefaultTextureIndex();
-			if (!model.materialTextureIndices.empty()) {
-				const size_t mapped = model.materialTextureIndices[0];
-				if (mapped != INVALID_TEXTURE_INDEX) {
-					textureIndex = mapped;
-				}
-			}
-			if (textureIndex < g.textures.size()) {
-				VkDescriptorSet descriptorSet = g.textures[textureIndex].descriptorSet;
-				if (descriptorSet) {
-					vkCmdBindDescriptorSets(g.commandBuffers[imageIndex], VK_PIPELINE_BIND_POINT_GRAPHICS, g.pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
-					vkCmdDrawIndexed(g.commandBuffers[imageIndex], static_cast<uint32_t>(model.cpu.indexCount()), 1, 0, 0, 0);
-				}
-			}
-		}
-	}
+	recordModelDraws(g.commandBuffers[imageIndex]);
 	vkCmdEndRenderPass(g.commandBuffers[imageIndex]);
 	check(vkEndCommandBuffer(g.commandBuffers[imageIndex]), "vkEndCommandBuffer");
+	g.currentFrame++;
 	stateLock.unlock();
 
-	VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	// Upload semaphores are waited on before the ownership acquires.
+	std::vector<VkPipelineStageFlags> waitStages(waitSemaphores.size(), VK_PIPELINE_STAGE_TRANSFER_BIT);
+	waitStages[0] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 	VkSubmitInfo submit{};
 	submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-	submit.waitSemaphoreCount = 1;
-	submit.pWaitSemaphores = &g.imageAvailable[i];
-	submit.pWaitDstStageMask = &waitStage;
+	submit.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+	submit.pWaitSemaphores = waitSemaphores.data();
+	submit.pWaitDstStageMask = waitStages.data();
 	submit.commandBufferCount = 1;
 	submit.pCommandBuffers = &g.commandBuffers[imageIndex];
 	submit.signalSemaphoreCount = 1;
 	submit.pSignalSemaphores = &g.renderFinished[i];
+	std::lock_guard<std::mutex> queueGuard(g_queueMutex);
 	VkResult submitResult = vkQueueSubmit(g.graphicsQueue, 1, &submit, g.inFlightFences[i]);
 	if (submitResult == VK_ERROR_DEVICE_LOST) {
 		LOGE("vkQueueSubmit reported VK_ERROR_DEVICE_LOST");
@@ -1250,12 +2581,25 @@ Java_lt_smworks_multiplatform3dengine_vulkan_EngineAPI_nativeRender(JNIEnv* env,
 	VkResult pr = vkQueuePresentKHR(g.graphicsQueue, &present);
 	if (pr == VK_ERROR_OUT_OF_DATE_KHR || pr == VK_SUBOPTIMAL_KHR) {
 	}
-	g.currentFrame++;
 }
 
 JNIEXPORT void JNICALL
 Java_lt_smworks_multiplatform3dengine_vulkan_EngineAPI_nativeDestroy(JNIEnv* env, jobject thiz) {
 	if (!g.initialized) return;
+	std::shared_ptr<LoadPipeline> pPipeline;
+	{
+		std::lock_guard<std::mutex> oPipelineGuard(g_loadPipelineMutex);
+		pPipeline.swap(g_loadPipeline);
+	}
+	// Joins the pipeline threads; the upload stage takes g_stateMutex.
+	pPipeline.reset();
+	{
+		std::lock_guard<std::mutex> oBenchmarkGuard(g_benchmarkMutex);
+		if (g_benchmarkThread.joinable()) {
+			g_benchmarkCancel = true;
+			g_benchmarkThread.join();
+		}
+	}
 	std::lock_guard<std::mutex> guard(g_stateMutex);
 	vkDeviceWaitIdle(g.device);
 	for (size_t i = 0; i < g.imageAvailable.size(); ++i) {
@@ -1266,9 +2610,15 @@ Java_lt_smworks_multiplatform3dengine_vulkan_EngineAPI_nativeDestroy(JNIEnv* env
 	g.imageAvailable.clear();
 	g.renderFinished.clear();
 	g.inFlightFences.clear();
+	destroyAllModelBuffers();
+	runDeferredDeletions(true);
+	destroyUploadBatches();
 	destroyTextureResources();
+	destroyStagingRing();
 	if (g.commandPool) vkDestroyCommandPool(g.device, g.commandPool, nullptr);
 	cleanupSwapchain();
+	destroyGeometryArena();
+	destroyMemoryBlocks();
 	if (g.device) vkDestroyDevice(g.device, nullptr);
 	if (g.surface) vkDestroySurfaceKHR(g.instance, g.surface, nullptr);
 	if (g.instance) vkDestroyInstance(g.instance, nullptr);
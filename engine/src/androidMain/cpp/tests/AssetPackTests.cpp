@@ -0,0 +1,145 @@
+#include "AssetPack.h"
+#include "TestHarness.h"
+
+#include <cstring>
+
+namespace {
+
+std::vector<SAssetPackInput> sampleInputs() {
+	std::vector<SAssetPackInput> vecInputs;
+	// Large and repetitive: stored as LZ4.
+	std::vector<uint8_t> vecModel(20000);
+	for (size_t i = 0; i < vecModel.size(); ++i) {
+		vecModel[i] = uint8_t(i % 97);
+	}
+	vecInputs.push_back({ "models/box.kmdl", AssetData::fromBuffer(std::move(vecModel)) });
+	// Small: stored raw.
+	vecInputs.push_back({ "models/box.mtl", AssetData::fromBuffer(std::vector<uint8_t>(100, 'm')) });
+	// Already compressed: stored raw whatever its size.
+	vecInputs.push_back({ "textures/wall.ktx2", AssetData::fromBuffer(std::vector<uint8_t>(8192, 't')) });
+	vecInputs.push_back({ "empty.txt", AssetData::fromBuffer(std::vector<uint8_t>()) });
+	return vecInputs;
+}
+
+bool writeSamplePack(std::vector<uint8_t>& outBytes) {
+	return writeAssetPack(sampleInputs(), outBytes);
+}
+
+SAssetPackHeader readHeader(const std::vector<uint8_t>& vecPack) {
+	SAssetPackHeader sHeader;
+	std::memcpy(&sHeader, vecPack.data(), sizeof(sHeader));
+	return sHeader;
+}
+
+SAssetPackEntry readEntry(const std::vector<uint8_t>& vecPack, size_t uIndex) {
+	SAssetPackEntry sEntry;
+	std::memcpy(&sEntry, vecPack.data() + readHeader(vecPack).uTocOffset + uIndex * sizeof(sEntry), sizeof(sEntry));
+	return sEntry;
+}
+
+void writeEntry(std::vector<uint8_t>& vecPack, size_t uIndex, const SAssetPackEntry& sEntry) {
+	std::memcpy(vecPack.data() + readHeader(vecPack).uTocOffset + uIndex * sizeof(sEntry), &sEntry, sizeof(sEntry));
+}
+
+bool mounts(std::vector<uint8_t> vecPack) {
+	return PackAssetSource::mount(AssetData::fromBuffer(std::move(vecPack))) != nullptr;
+}
+
+size_t findEntry(const std::vector<uint8_t>& vecPack, EAssetPackCodec eCodec) {
+	for (size_t i = 0; i < readHeader(vecPack).uEntryCount; ++i) {
+		if (readEntry(vecPack, i).uCodec == static_cast<uint32_t>(eCodec)) return i;
+	}
+	return SIZE_MAX;
+}
+
+} // namespace
+
+TEST_CASE(AssetPack, RoundTrip) {
+	std::vector<uint8_t> vecPack;
+	CHECK(writeSamplePack(vecPack));
+	CHECK(findEntry(vecPack, EAssetPackCodec::Lz4) != SIZE_MAX);
+
+	auto pFallback = std::make_shared<MemoryAssetSource>();
+	pFallback->add("loose.txt", std::vector<uint8_t>(3, 'l'));
+	std::shared_ptr<PackAssetSource> pPack = PackAssetSource::mount(AssetData::fromBuffer(std::move(vecPack)), pFallback);
+	CHECK(pPack && pPack->entryCount() == 4);
+	if (!pPack) return;
+	for (const SAssetPackInput& sInput : sampleInputs()) {
+		const AssetData data = pPack->open(sInput.strPath);
+		CHECK(data.size() == sInput.data.size());
+		CHECK(data.view() == sInput.data.view());
+	}
+	CHECK(pPack->open("loose.txt").view() == "lll");
+	CHECK(!pPack->open("missing.txt"));
+}
+
+TEST_CASE(AssetPack, StoresTexturesAndSmallEntriesRaw) {
+	const std::vector<SAssetPackInput> vecInputs = sampleInputs();
+	std::vector<uint8_t> vecPack;
+	CHECK(writeAssetPack(vecInputs, vecPack));
+	const SAssetPackHeader sHeader = readHeader(vecPack);
+	for (size_t i = 0; i < sHeader.uEntryCount; ++i) {
+		const SAssetPackEntry sEntry = readEntry(vecPack, i);
+		const std::string strPath(reinterpret_cast<const char*>(vecPack.data() + sHeader.uStringsOffset + sEntry.uPathOffset), sEntry.uPathLength);
+		const bool bCompressed = sEntry.uCodec == static_cast<uint32_t>(EAssetPackCodec::Lz4);
+		CHECK(bCompressed == (strPath == "models/box.kmdl"));
+	}
+}
+
+TEST_CASE(AssetPack, RejectsCorruptPacks) {
+	std::vector<uint8_t> vecPack;
+	CHECK(writeSamplePack(vecPack));
+
+	CHECK(!mounts(std::vector<uint8_t>(vecPack.begin(), vecPack.begin() + sizeof(SAssetPackHeader) - 1)));
+	CHECK(!mounts(std::vector<uint8_t>(vecPack.begin(), vecPack.end() - 1)));
+
+	std::vector<uint8_t> vecBadMagic = vecPack;
+	vecBadMagic[0] ^= 0xFF;
+	CHECK(!mounts(vecBadMagic));
+
+	std::vector<uint8_t> vecBadCount = vecPack;
+	SAssetPackHeader sHeader = readHeader(vecPack);
+	sHeader.uEntryCount = 1000000;
+	std::memcpy(vecBadCount.data(), &sHeader, sizeof(sHeader));
+	CHECK(!mounts(vecBadCount));
+
+	std::vector<uint8_t> vecUnsorted = vecPack;
+	const SAssetPackEntry sFirst = readEntry(vecPack, 0);
+	writeEntry(vecUnsorted, 0, readEntry(vecPack, 1));
+	writeEntry(vecUnsorted, 1, sFirst);
+	CHECK(!mounts(vecUnsorted));
+
+	std::vector<uint8_t> vecBadRange = vecPack;
+	SAssetPackEntry sEntry = readEntry(vecPack, 0);
+	sEntry.uStoredSize = vecPack.size();
+	writeEntry(vecBadRange, 0, sEntry);
+	CHECK(!mounts(vecBadRange));
+
+	std::vector<uint8_t> vecBadCodec = vecPack;
+	sEntry = readEntry(vecPack, 0);
+	sEntry.uCodec = 7;
+	writeEntry(vecBadCodec, 0, sEntry);
+	CHECK(!mounts(vecBadCodec));
+
+	// An LZ4 entry claiming more than 255x expansion.
+	const size_t uLz4 = findEntry(vecPack, EAssetPackCodec::Lz4);
+	std::vector<uint8_t> vecHuge = vecPack;
+	sEntry = readEntry(vecPack, uLz4);
+	sEntry.uSize = 1ull << 40;
+	writeEntry(vecHuge, uLz4, sEntry);
+	CHECK(!mounts(vecHuge));
+}
+
+TEST_CASE(AssetPack, CorruptLz4PayloadFailsOpen) {
+	std::vector<uint8_t> vecPack;
+	CHECK(writeSamplePack(vecPack));
+	const SAssetPackEntry sEntry = readEntry(vecPack, findEntry(vecPack, EAssetPackCodec::Lz4));
+	// Cutting the block short leaves the declared size unreachable.
+	std::memset(vecPack.data() + sEntry.uOffset + sEntry.uStoredSize / 2, 0, sEntry.uStoredSize - sEntry.uStoredSize / 2);
+
+	std::shared_ptr<PackAssetSource> pPack = PackAssetSource::mount(AssetData::fromBuffer(std::move(vecPack)));
+	CHECK(pPack != nullptr);
+	if (pPack) {
+		CHECK(!pPack->open("models/box.kmdl"));
+	}
+}
@@ -0,0 +1,45 @@
+#include "BoundedQueue.h"
+#include "TestHarness.h"
+
+#include <thread>
+
+TEST_CASE(BoundedQueue, KeepsOrderAcrossThreads) {
+	BoundedQueue<int> queue(4);
+	std::thread producer([&queue]() {
+		for (int i = 0; i < 1000; ++i) {
+			queue.push(int(i));
+		}
+	});
+	int nValue = -1;
+	for (int i = 0; i < 1000; ++i) {
+		CHECK(queue.pop(nValue));
+		CHECK(nValue == i);
+	}
+	producer.join();
+}
+
+TEST_CASE(BoundedQueue, TryPushFailsWhenFull) {
+	BoundedQueue<int> queue(2);
+	CHECK(queue.tryPush(1));
+	CHECK(queue.tryPush(2));
+	CHECK(!queue.tryPush(3));
+
+	std::vector<int> vecItems;
+	CHECK(queue.popAll(vecItems));
+	CHECK(vecItems == std::vector<int>({ 1, 2 }));
+	CHECK(queue.tryPush(3));
+}
+
+TEST_CASE(BoundedQueue, CloseWakesBlockedCallers) {
+	BoundedQueue<int> queue(1);
+	CHECK(queue.push(1));
+	bool bPushed = true;
+	std::thread producer([&]() { bPushed = queue.push(2); });
+	queue.close();
+	producer.join();
+	CHECK(!bPushed);
+
+	int nValue = 0;
+	CHECK(!queue.pop(nValue));
+	CHECK(!queue.tryPush(3));
+}
@@ -0,0 +1,121 @@
+#include "CookedModel.h"
+#include "MeshOptimizer.h"
+#include "TestHarness.h"
+
+#include <cstddef>
+#include <cstring>
+
+namespace {
+
+Model optimizedCube() {
+	Model model = createCubeModel();
+	Material& material = model.materials.front();
+	material.name = "crate";
+	material.diffuseColor = { 0.5f, 0.25f, 1.0f };
+	material.diffuseTexture = "textures/crate.ktx2";
+	optimizeModel(model);
+	return model;
+}
+
+bool reads(const std::vector<uint8_t>& vecBytes) {
+	Model model;
+	return readCookedModel(vecBytes.data(), vecBytes.size(), model);
+}
+
+bool cooksAndReads(const Model& model) {
+	std::vector<uint8_t> vecBytes;
+	return writeCookedModel(model, vecBytes) && reads(vecBytes);
+}
+
+SCookedSection section(const std::vector<uint8_t>& vecBytes, ECookedSection eSection) {
+	SCookedSection sSection;
+	std::memcpy(&sSection, vecBytes.data() + sizeof(SCookedModelHeader) + static_cast<size_t>(eSection) * sizeof(sSection), sizeof(sSection));
+	return sSection;
+}
+
+} // namespace
+
+TEST_CASE(CookedModel, RoundTrip) {
+	const Model model = optimizedCube();
+	std::vector<uint8_t> vecBytes;
+	CHECK(writeCookedModel(model, vecBytes));
+	CHECK(vecBytes.size() % kCookedModelAlignment == 0);
+
+	Model loaded;
+	CHECK(readCookedModel(vecBytes.data(), vecBytes.size(), loaded));
+	std::vector<float> vecPacked;
+	packModelVertices(model, vecPacked);
+	CHECK(loaded.packedVertices == vecPacked);
+	CHECK(loaded.indices == model.indices);
+	CHECK(loaded.subsets.size() == model.subsets.size());
+	CHECK(loaded.lods.size() == model.lods.size());
+	CHECK(loaded.meshlets.size() == model.meshlets.size() && !loaded.meshlets.empty());
+	CHECK(loaded.meshletVertices == model.meshletVertices);
+	CHECK(loaded.meshletTriangles == model.meshletTriangles);
+	CHECK(loaded.materials.size() == 1);
+	if (loaded.materials.size() == 1) {
+		CHECK(loaded.materials[0].name == "crate");
+		CHECK(loaded.materials[0].diffuseTexture == "textures/crate.ktx2");
+		CHECK(loaded.materials[0].diffuseColor == model.materials[0].diffuseColor);
+	}
+	for (int i = 0; i < 3; ++i) {
+		CHECK(loaded.bounds.min[i] == -0.5f && loaded.bounds.max[i] == 0.5f);
+	}
+}
+
+TEST_CASE(CookedModel, RejectsCorruptHeaders) {
+	std::vector<uint8_t> vecBytes;
+	CHECK(writeCookedModel(optimizedCube(), vecBytes));
+
+	CHECK(!reads(std::vector<uint8_t>(vecBytes.begin(), vecBytes.begin() + sizeof(SCookedModelHeader) - 1)));
+	CHECK(!reads(std::vector<uint8_t>(vecBytes.begin(), vecBytes.end() - kCookedModelAlignment)));
+
+	std::vector<uint8_t> vecBadMagic = vecBytes;
+	vecBadMagic[0] ^= 0xFF;
+	CHECK(!reads(vecBadMagic));
+
+	std::vector<uint8_t> vecBadVersion = vecBytes;
+	const uint32_t uVersion = kCookedModelVersion + 1;
+	std::memcpy(vecBadVersion.data() + offsetof(SCookedModelHeader, uVersion), &uVersion, sizeof(uVersion));
+	CHECK(!reads(vecBadVersion));
+
+	std::vector<uint8_t> vecBadSection = vecBytes;
+	SCookedSection sSection = section(vecBytes, ECookedSection::Indices);
+	sSection.uSize = vecBytes.size();
+	std::memcpy(vecBadSection.data() + sizeof(SCookedModelHeader) + static_cast<size_t>(ECookedSection::Indices) * sizeof(sSection), &sSection,
+		sizeof(sSection));
+	CHECK(!reads(vecBadSection));
+}
+
+TEST_CASE(CookedModel, RejectsOutOfRangeReferences) {
+	std::vector<uint8_t> vecBytes;
+	CHECK(writeCookedModel(optimizedCube(), vecBytes));
+	const uint32_t uHugeIndex = 1000000;
+	std::vector<uint8_t> vecBadIndex = vecBytes;
+	std::memcpy(vecBadIndex.data() + section(vecBytes, ECookedSection::Indices).uOffset, &uHugeIndex, sizeof(uHugeIndex));
+	CHECK(!reads(vecBadIndex));
+
+	Model badSubset = optimizedCube();
+	badSubset.subsets[0].indexCount += 3;
+	CHECK(!cooksAndReads(badSubset));
+
+	Model badMaterial = optimizedCube();
+	badMaterial.subsets[0].materialIndex = 5;
+	CHECK(!cooksAndReads(badMaterial));
+
+	Model badMeshletVertex = optimizedCube();
+	badMeshletVertex.meshletVertices[0] = 1000;
+	CHECK(!cooksAndReads(badMeshletVertex));
+
+	Model badVertexRange = optimizedCube();
+	badVertexRange.meshlets[0].vertexCount += 100;
+	CHECK(!cooksAndReads(badVertexRange));
+
+	Model badTriangleRange = optimizedCube();
+	badTriangleRange.meshlets[0].triangleCount += 100;
+	CHECK(!cooksAndReads(badTriangleRange));
+
+	Model badLocalIndex = optimizedCube();
+	badLocalIndex.meshletTriangles[0] = 200;
+	CHECK(!cooksAndReads(badLocalIndex));
+}
@@ -0,0 +1,64 @@
+#include "Lz4.h"
+#include "TestHarness.h"
+
+#include <random>
+
+namespace {
+
+std::vector<uint8_t> mixedBytes(size_t uSize) {
+	std::mt19937 rng(7);
+	std::vector<uint8_t> vecBytes(uSize);
+	for (size_t i = 0; i < uSize; ++i) {
+		// Runs, repeated phrases and noise, so every sequence kind is hit.
+		vecBytes[i] = (i / 512) % 3 == 0 ? uint8_t(i / 64) : (i / 512) % 3 == 1 ? uint8_t("phrase"[i % 6]) : uint8_t(rng());
+	}
+	return vecBytes;
+}
+
+} // namespace
+
+TEST_CASE(Lz4, RoundTrip) {
+	for (size_t uSize : { size_t(0), size_t(1), size_t(15), size_t(300), size_t(70000) }) {
+		const std::vector<uint8_t> vecInput = mixedBytes(uSize);
+		std::vector<uint8_t> vecCompressed;
+		lz4Compress(vecInput.data(), vecInput.size(), vecCompressed);
+		CHECK(vecCompressed.size() <= lz4CompressBound(uSize));
+
+		std::vector<uint8_t> vecOutput(uSize);
+		CHECK(lz4Decompress(vecCompressed.data(), vecCompressed.size(), vecOutput.data(), vecOutput.size()));
+		CHECK(vecOutput == vecInput);
+	}
+}
+
+TEST_CASE(Lz4, CompressesRepetitiveInput) {
+	const std::vector<uint8_t> vecInput(100000, 'x');
+	std::vector<uint8_t> vecCompressed;
+	lz4Compress(vecInput.data(), vecInput.size(), vecCompressed);
+	CHECK(vecCompressed.size() < vecInput.size() / 100);
+}
+
+TEST_CASE(Lz4, RejectsCorruptInput) {
+	const std::vector<uint8_t> vecInput = mixedBytes(5000);
+	std::vector<uint8_t> vecCompressed;
+	lz4Compress(vecInput.data(), vecInput.size(), vecCompressed);
+	std::vector<uint8_t> vecOutput(vecInput.size());
+
+	// Wrong expected sizes.
+	CHECK(!lz4Decompress(vecCompressed.data(), vecCompressed.size(), vecOutput.data(), vecOutput.size() - 1));
+	std::vector<uint8_t> vecLarger(vecInput.size() + 1);
+	CHECK(!lz4Decompress(vecCompressed.data(), vecCompressed.size(), vecLarger.data(), vecLarger.size()));
+	// Truncated block.
+	CHECK(!lz4Decompress(vecCompressed.data(), vecCompressed.size() / 2, vecOutput.data(), vecOutput.size()));
+	// A match reaching back before the start of the output.
+	const uint8_t auBadOffset[] = { 0x14, 'a', 0xFF, 0x00, 0x00 };
+	std::vector<uint8_t> vecSmall(9);
+	CHECK(!lz4Decompress(auBadOffset, sizeof(auBadOffset), vecSmall.data(), vecSmall.size()));
+
+	// Random damage must fail cleanly or decode to something of the right size.
+	std::mt19937 rng(3);
+	for (int i = 0; i < 2000; ++i) {
+		std::vector<uint8_t> vecDamaged = vecCompressed;
+		vecDamaged[rng() % vecDamaged.size()] ^= uint8_t(1 + rng() % 255);
+		lz4Decompress(vecDamaged.data(), vecDamaged.size(), vecOutput.data(), vecOutput.size());
+	}
+}
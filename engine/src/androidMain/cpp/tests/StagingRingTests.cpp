@@ -0,0 +1,57 @@
+#include "StagingRing.h"
+#include "TestHarness.h"
+
+#include <random>
+#include <vector>
+
+TEST_CASE(StagingRing, ReclaimsInFifoOrder) {
+	std::vector<unsigned char> vecMemory(1000);
+	std::shared_ptr<StagingRing> pRing = StagingRing::create(vecMemory.data(), vecMemory.size());
+	CHECK(pRing->capacity() % StagingRing::kAlignment == 0);
+
+	std::shared_ptr<StagingBlock> pA = pRing->allocate(400);
+	std::shared_ptr<StagingBlock> pB = pRing->allocate(400);
+	CHECK(pA && pB && pA->offset() == 0 && pB->offset() == 400);
+	// Full: callers fall back to heap memory instead of waiting.
+	CHECK(!pRing->allocate(300));
+
+	// Releasing the newer block first frees nothing until the older one goes.
+	pB.reset();
+	CHECK(!pRing->allocate(300));
+	pA.reset();
+	CHECK(pRing->usedBytes() == 0);
+	std::shared_ptr<StagingBlock> pC = pRing->allocate(900);
+	CHECK(pC && pC->size() == 900);
+}
+
+TEST_CASE(StagingRing, RandomBlocksNeverOverlap) {
+	std::vector<unsigned char> vecMemory(4096);
+	std::shared_ptr<StagingRing> pRing = StagingRing::create(vecMemory.data(), vecMemory.size());
+	std::mt19937 rng(1);
+	std::vector<std::shared_ptr<StagingBlock>> vecLive;
+	for (int i = 0; i < 50000; ++i) {
+		if (rng() % 2 != 0 && !vecLive.empty()) {
+			vecLive.erase(vecLive.begin() + rng() % vecLive.size());
+			continue;
+		}
+		std::shared_ptr<StagingBlock> pBlock = pRing->allocate(1 + rng() % 700);
+		if (!pBlock) continue;
+		CHECK(pBlock->offset() % StagingRing::kAlignment == 0);
+		CHECK(pBlock->offset() + pBlock->size() <= pRing->capacity());
+		CHECK(pBlock->data() == vecMemory.data() + pBlock->offset());
+		for (const std::shared_ptr<StagingBlock>& pOther : vecLive) {
+			CHECK(pBlock->offset() + pBlock->size() <= pOther->offset() || pOther->offset() + pOther->size() <= pBlock->offset());
+		}
+		if (bTestFailed) return;
+		vecLive.push_back(std::move(pBlock));
+	}
+	vecLive.clear();
+	CHECK(pRing->usedBytes() == 0);
+}
+
+TEST_CASE(StagingRing, BlocksOutliveTheirRing) {
+	std::vector<unsigned char> vecMemory(256);
+	std::shared_ptr<StagingBlock> pBlock = StagingRing::create(vecMemory.data(), vecMemory.size())->allocate(64);
+	CHECK(pBlock && pBlock->size() == 64);
+	pBlock.reset();
+}
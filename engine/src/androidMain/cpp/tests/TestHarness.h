@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+// Minimal test registry for the host build. Each TEST_CASE registers itself at
+// static initialisation; asset_pipeline_tests runs the cases whose suite
+// matches its first argument, or all of them without one.
+struct STestCase {
+	const char* pcSuite;
+	const char* pcName;
+	void (*pfnRun)(bool& bFailed);
+};
+
+std::vector<STestCase>& testRegistry();
+
+struct STestRegistrar {
+	STestRegistrar(const char* pcSuite, const char* pcName, void (*pfnRun)(bool&)) {
+		testRegistry().push_back({ pcSuite, pcName, pfnRun });
+	}
+};
+
+#define TEST_CASE(suite, name) \
+	static void suite##_##name(bool& bTestFailed); \
+	static STestRegistrar s_##suite##_##name##_registrar(#suite, #name, &suite##_##name); \
+	static void suite##_##name(bool& bTestFailed)
+
+// Records a failure and keeps going, so one run reports every broken check.
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+			bTestFailed = true; \
+		} \
+	} while (0)
@@ -0,0 +1,28 @@
+#include "TestHarness.h"
+
+#include <cstring>
+
+std::vector<STestCase>& testRegistry() {
+	static std::vector<STestCase> s_vecCases;
+	return s_vecCases;
+}
+
+int main(int argc, char** argv) {
+	const char* pcSuite = argc > 1 ? argv[1] : nullptr;
+	size_t uRun = 0;
+	size_t uFailed = 0;
+	for (const STestCase& sCase : testRegistry()) {
+		if (pcSuite && std::strcmp(pcSuite, sCase.pcSuite) != 0) continue;
+		bool bFailed = false;
+		sCase.pfnRun(bFailed);
+		std::printf("[%s] %s.%s\n", bFailed ? "FAIL" : " OK ", sCase.pcSuite, sCase.pcName);
+		++uRun;
+		uFailed += bFailed ? 1 : 0;
+	}
+	if (uRun == 0) {
+		std::fprintf(stderr, "No test cases match '%s'\n", pcSuite ? pcSuite : "");
+		return 1;
+	}
+	std::printf("%zu of %zu test cases passed\n", uRun - uFailed, uRun);
+	return uFailed == 0 ? 0 : 1;
+}
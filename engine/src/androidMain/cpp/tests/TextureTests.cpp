@@ -0,0 +1,153 @@
+#include "Etc2.h"
+#include "Ktx2.h"
+#include "Mipmaps.h"
+#include "TestHarness.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// Smooth gradients with an alpha ramp, which ETC2 reproduces closely.
+std::vector<uint8_t> gradientRgba(uint32_t uWidth, uint32_t uHeight) {
+	std::vector<uint8_t> vecPixels(static_cast<size_t>(uWidth) * uHeight * 4);
+	for (uint32_t y = 0; y < uHeight; ++y) {
+		for (uint32_t x = 0; x < uWidth; ++x) {
+			uint8_t* pPixel = vecPixels.data() + (static_cast<size_t>(y) * uWidth + x) * 4;
+			pPixel[0] = uint8_t(x * 255 / uWidth);
+			pPixel[1] = uint8_t(y * 255 / uHeight);
+			pPixel[2] = 128;
+			pPixel[3] = uint8_t((x + y) * 255 / (uWidth + uHeight));
+		}
+	}
+	return vecPixels;
+}
+
+double meanAbsoluteError(const std::vector<uint8_t>& vecA, const std::vector<uint8_t>& vecB) {
+	uint64_t uSum = 0;
+	for (size_t i = 0; i < vecA.size(); ++i) {
+		uSum += static_cast<uint64_t>(std::abs(int(vecA[i]) - int(vecB[i])));
+	}
+	return vecA.empty() ? 0.0 : static_cast<double>(uSum) / vecA.size();
+}
+
+std::vector<uint8_t> sampleKtx2() {
+	std::vector<SKtx2LevelData> vecLevels;
+	for (uint32_t uSize = 8; uSize > 0; uSize /= 2) {
+		SKtx2LevelData sLevel;
+		sLevel.uWidth = uSize;
+		sLevel.uHeight = uSize;
+		sLevel.vecBytes.assign(static_cast<size_t>(uSize) * uSize * 4, uint8_t(uSize));
+		vecLevels.push_back(std::move(sLevel));
+	}
+	std::vector<uint8_t> vecBytes;
+	writeKtx2(kKtx2FormatR8G8B8A8Unorm, vecLevels, vecBytes);
+	return vecBytes;
+}
+
+} // namespace
+
+TEST_CASE(Texture, Ktx2RoundTrip) {
+	const std::vector<uint8_t> vecBytes = sampleKtx2();
+	CHECK(isKtx2(vecBytes.data(), vecBytes.size()));
+
+	SKtx2Image sImage;
+	CHECK(parseKtx2(vecBytes.data(), vecBytes.size(), sImage));
+	CHECK(sImage.uVkFormat == kKtx2FormatR8G8B8A8Unorm);
+	CHECK(sImage.uWidth == 8 && sImage.uHeight == 8);
+	CHECK(sImage.vecLevels.size() == 4);
+	for (const SKtx2Level& sLevel : sImage.vecLevels) {
+		CHECK(sLevel.uSize == static_cast<size_t>(sLevel.uWidth) * sLevel.uHeight * 4);
+		CHECK(sLevel.pData[0] == uint8_t(sLevel.uWidth) && sLevel.pData[sLevel.uSize - 1] == uint8_t(sLevel.uWidth));
+	}
+}
+
+TEST_CASE(Texture, Ktx2RejectsCorruptInput) {
+	const std::vector<uint8_t> vecBytes = sampleKtx2();
+	SKtx2Image sImage;
+	CHECK(!parseKtx2(vecBytes.data(), 11, sImage));
+	CHECK(!parseKtx2(vecBytes.data(), vecBytes.size() - 1, sImage));
+
+	std::vector<uint8_t> vecBadIdentifier = vecBytes;
+	vecBadIdentifier[1] = 'X';
+	CHECK(!isKtx2(vecBadIdentifier.data(), vecBadIdentifier.size()));
+	CHECK(!parseKtx2(vecBadIdentifier.data(), vecBadIdentifier.size(), sImage));
+
+	// Header fields: vkFormat at 12, pixelWidth at 20, levelCount at 40.
+	const uint32_t uZero = 0;
+	std::vector<uint8_t> vecZeroWidth = vecBytes;
+	std::memcpy(vecZeroWidth.data() + 20, &uZero, sizeof(uZero));
+	CHECK(!parseKtx2(vecZeroWidth.data(), vecZeroWidth.size(), sImage));
+
+	const uint32_t uTooManyLevels = 40;
+	std::vector<uint8_t> vecBadLevels = vecBytes;
+	std::memcpy(vecBadLevels.data() + 40, &uTooManyLevels, sizeof(uTooManyLevels));
+	CHECK(!parseKtx2(vecBadLevels.data(), vecBadLevels.size(), sImage));
+
+	// Level sizes that do not match the format.
+	std::vector<SKtx2LevelData> vecLevels(1);
+	vecLevels[0].uWidth = 4;
+	vecLevels[0].uHeight = 4;
+	vecLevels[0].vecBytes.resize(10);
+	std::vector<uint8_t> vecWritten;
+	CHECK(!writeKtx2(kKtx2FormatEtc2R8G8B8Unorm, vecLevels, vecWritten));
+}
+
+TEST_CASE(Texture, Etc2RoundTrip) {
+	for (bool bAlpha : { false, true }) {
+		for (EEtc2Quality eQuality : { EEtc2Quality::Fast, EEtc2Quality::Normal, EEtc2Quality::High }) {
+			// 30x18 exercises partial edge blocks.
+			std::vector<uint8_t> vecPixels = gradientRgba(30, 18);
+			if (!bAlpha) {
+				for (size_t i = 3; i < vecPixels.size(); i += 4) {
+					vecPixels[i] = 255;
+				}
+			}
+			std::vector<uint8_t> vecBlocks;
+			encodeEtc2(vecPixels.data(), 30, 18, bAlpha, vecBlocks, eQuality);
+			CHECK(vecBlocks.size() == etc2ImageSize(30, 18, bAlpha));
+			CHECK(vecBlocks.size() == 8 * 5 * (bAlpha ? kEtc2RgbaBlockBytes : kEtc2RgbBlockBytes));
+
+			std::vector<uint8_t> vecDecoded;
+			CHECK(decodeEtc2(vecBlocks.data(), vecBlocks.size(), 30, 18, bAlpha, vecDecoded));
+			CHECK(vecDecoded.size() == vecPixels.size());
+			CHECK(meanAbsoluteError(vecDecoded, vecPixels) < 4.0);
+		}
+	}
+}
+
+TEST_CASE(Texture, Etc2RejectsShortInput) {
+	std::vector<uint8_t> vecBlocks(etc2ImageSize(16, 16, true) - 1);
+	std::vector<uint8_t> vecDecoded;
+	CHECK(!decodeEtc2(vecBlocks.data(), vecBlocks.size(), 16, 16, true, vecDecoded));
+	CHECK(!decodeEtc2(vecBlocks.data(), vecBlocks.size() / 2, 16, 16, false, vecDecoded));
+}
+
+TEST_CASE(Texture, MipChain) {
+	CHECK(mipLevelCount(1, 1) == 1);
+	CHECK(mipLevelCount(256, 64) == 9);
+	CHECK(mipLevelCount(5, 3) == 3);
+
+	std::vector<SMipLevel> vecLevels;
+	const size_t uTotal = mipChainLayout(6, 3, 4, vecLevels);
+	CHECK(vecLevels.size() == 3);
+	CHECK(uTotal == (6 * 3 + 3 * 1 + 1 * 1) * 4);
+	CHECK(vecLevels[1].uWidth == 3 && vecLevels[1].uHeight == 1 && vecLevels[1].uOffset == 6 * 3 * 4);
+	CHECK(vecLevels[2].uWidth == 1 && vecLevels[2].uHeight == 1);
+
+	// A flat colour stays flat at every level.
+	std::vector<uint8_t> vecChain(uTotal, 0);
+	for (size_t i = 0; i < vecLevels[0].uSize; i += 4) {
+		std::memcpy(vecChain.data() + i, "\x10\x80\xF0\xFF", 4);
+	}
+	generateMipChainRgba8(vecChain.data(), vecLevels);
+	for (size_t i = 0; i < uTotal; i += 4) {
+		CHECK(std::memcmp(vecChain.data() + i, "\x10\x80\xF0\xFF", 4) == 0);
+	}
+
+	// Box filter of a 2x2 block.
+	const uint8_t auQuad[16] = { 0, 0, 0, 0, 100, 100, 100, 100, 200, 200, 200, 200, 100, 100, 100, 100 };
+	uint8_t auHalf[4] = {};
+	downsampleRgba8(auQuad, 2, 2, auHalf);
+	CHECK(auHalf[0] == 100 && auHalf[3] == 100);
+}
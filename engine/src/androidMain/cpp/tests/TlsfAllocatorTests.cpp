@@ -0,0 +1,63 @@
+#include "TestHarness.h"
+#include "TlsfAllocator.h"
+
+#include <iterator>
+#include <map>
+#include <random>
+
+TEST_CASE(TlsfAllocator, AllocateFreeCoalesces) {
+	TlsfAllocator allocator(1 << 20);
+	const uint64_t uA = allocator.allocate(1000, 256);
+	const uint64_t uB = allocator.allocate(5000, 4096);
+	const uint64_t uC = allocator.allocate(300, 16);
+	CHECK(uA != TlsfAllocator::kInvalidOffset && uA % 256 == 0);
+	CHECK(uB != TlsfAllocator::kInvalidOffset && uB % 4096 == 0);
+	CHECK(uC != TlsfAllocator::kInvalidOffset && uC % 16 == 0);
+	CHECK(allocator.allocationCount() == 3);
+
+	allocator.free(uB);
+	allocator.free(uA);
+	allocator.free(uC);
+	CHECK(allocator.empty());
+	CHECK(allocator.usedBytes() == 0);
+	// Every range merged back, so the whole span fits again.
+	CHECK(allocator.allocate(1 << 20, 1) == 0);
+}
+
+TEST_CASE(TlsfAllocator, RejectsOversizedRequests) {
+	TlsfAllocator allocator(4096);
+	CHECK(allocator.allocate(4097, 1) == TlsfAllocator::kInvalidOffset);
+	CHECK(allocator.allocate(4096, 1) == 0);
+	CHECK(allocator.allocate(1, 1) == TlsfAllocator::kInvalidOffset);
+}
+
+TEST_CASE(TlsfAllocator, RandomRangesNeverOverlap) {
+	std::mt19937_64 rng(1);
+	const uint64_t uTotal = 1 << 22;
+	TlsfAllocator allocator(uTotal);
+	std::map<uint64_t, uint64_t> mapLive;
+	for (int i = 0; i < 50000; ++i) {
+		if (mapLive.empty() || rng() % 3 != 0) {
+			const uint64_t uSize = 1 + rng() % (rng() % 4 == 0 ? uTotal / 8 : 4096);
+			const uint64_t uAlignment = 1ull << (rng() % 13);
+			const uint64_t uOffset = allocator.allocate(uSize, uAlignment);
+			if (uOffset == TlsfAllocator::kInvalidOffset) continue;
+			CHECK(uOffset % uAlignment == 0 && uOffset + uSize <= uTotal);
+			auto it = mapLive.lower_bound(uOffset);
+			CHECK(it == mapLive.end() || it->first >= uOffset + uSize);
+			CHECK(it == mapLive.begin() || std::prev(it)->first + std::prev(it)->second <= uOffset);
+			mapLive[uOffset] = uSize;
+		} else {
+			auto it = mapLive.begin();
+			std::advance(it, rng() % mapLive.size());
+			allocator.free(it->first);
+			mapLive.erase(it);
+		}
+		if (bTestFailed) return;
+	}
+	for (const auto& sLive : mapLive) {
+		allocator.free(sLive.first);
+	}
+	CHECK(allocator.empty());
+	CHECK(allocator.allocate(uTotal, 1) == 0);
+}
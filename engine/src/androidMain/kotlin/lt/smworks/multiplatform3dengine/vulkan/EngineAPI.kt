@@ -2,6 +2,7 @@ package lt.smworks.multiplatform3dengine.vulkan
 
 import android.content.res.AssetManager
 import android.view.Surface
+import java.io.File
 import java.util.concurrent.atomic.AtomicBoolean
 import java.util.concurrent.atomic.AtomicLong
 import java.util.concurrent.locks.LockSupport
@@ -195,6 +196,59 @@ actual class EngineAPI actual constructor() {
         scale(modelId, state.scale + delta)
     }
 
+    // Logs source vs cooked load times for each model from a background thread.
+    // Each model needs its cooked .kmdl sibling in the assets (see asset_cooker).
+    fun benchmarkModelLoaders(modelNames: List<String>, iterations: Int = 20) {
+        if (!isNativeReady || modelNames.isEmpty()) return
+        nativeBenchmarkModelLoaders(modelNames.toTypedArray(), iterations)
+    }
+
+    // Source models (OBJ/glTF) are cooked into this directory on first load and
+    // read back from it afterwards, including when the surface is recreated.
+    fun setModelCacheDirectory(directory: File?, maxBytes: Long = DEFAULT_MODEL_CACHE_BYTES) {
+        nativeSetCacheDirectory(directory?.absolutePath, maxBytes)
+    }
+
+    // PNG/JPEG textures that were not cooked are encoded to ETC2 on load unless
+    // the estimated encode time exceeds budgetMillis. Applies from the next init.
+    fun setTextureCompression(
+        quality: TextureCompressionQuality,
+        budgetMillis: Long = DEFAULT_TEXTURE_ENCODE_BUDGET_MILLIS
+    ) {
+        nativeSetTextureCompression(quality.ordinal, budgetMillis)
+    }
+
+    // Larger textures are decoded at 1/2, 1/4 or 1/8 scale (cooked ones drop
+    // their top mip levels). 0 uses a limit based on the device's memory.
+    // Applies from the next init.
+    fun setMaxTextureDimension(maxDimension: Int = 0) {
+        nativeSetMaxTextureDimension(maxDimension)
+    }
+
+    // Least recently drawn textures are evicted once their device memory exceeds
+    // maxBytes and streamed back in when drawn again. 0 disables eviction.
+    fun setTextureMemoryBudget(maxBytes: Long = DEFAULT_TEXTURE_MEMORY_BUDGET_BYTES) {
+        nativeSetTextureMemoryBudget(maxBytes)
+    }
+
+    // Device memory reserved and used by the renderer, one entry per Vulkan
+    // memory heap. Empty until the renderer is initialized.
+    fun getGpuMemoryUsage(): List<GpuHeapUsage> {
+        val values = nativeGetGpuMemoryUsage()
+        return (0 until values.size / GPU_HEAP_USAGE_FIELDS).map { heap ->
+            val base = heap * GPU_HEAP_USAGE_FIELDS
+            GpuHeapUsage(
+                heapIndex = heap,
+                heapSize = values[base],
+                reservedBytes = values[base + 1],
+                usedBytes = values[base + 2],
+                blockCount = values[base + 3].toInt(),
+                allocationCount = values[base + 4].toInt(),
+                dedicatedAllocationCount = values[base + 5].toInt(),
+            )
+        }
+    }
+
     fun destroy() {
         stop()
         nativeDestroy()
@@ -247,6 +301,12 @@ actual class EngineAPI actual constructor() {
     private external fun nativeDestroy()
     private external fun nativeLoadModel(modelId: Long, modelName: String, x: Float, y: Float, z: Float, scale: Float)
     private external fun nativeMoveCamera(delta: Float)
+    private external fun nativeBenchmarkModelLoaders(modelNames: Array<String>, iterations: Int)
+    private external fun nativeSetCacheDirectory(path: String?, maxBytes: Long)
+    private external fun nativeSetTextureCompression(quality: Int, budgetMillis: Long)
+    private external fun nativeSetMaxTextureDimension(maxDimension: Int)
+    private external fun nativeSetTextureMemoryBudget(maxBytes: Long)
+    private external fun nativeGetGpuMemoryUsage(): LongArray
     private external fun nativeRotateModel(modelId: Long, rotationX: Float, rotationY: Float, rotationZ: Float)
     private external fun nativeTranslateModel(modelId: Long, x: Float, y: Float, z: Float)
     private external fun nativeScaleModel(modelId: Long, scale: Float)
@@ -254,6 +314,10 @@ actual class EngineAPI actual constructor() {
     actual companion object {
         private const val NO_LIMIT_INTERVAL = -1L
         private const val NANOS_IN_SECOND = 1_000_000_000L
+        private const val DEFAULT_MODEL_CACHE_BYTES = 64L * 1024L * 1024L
+        private const val DEFAULT_TEXTURE_ENCODE_BUDGET_MILLIS = 400L
+        private const val DEFAULT_TEXTURE_MEMORY_BUDGET_BYTES = 256L * 1024L * 1024L
+        private const val GPU_HEAP_USAGE_FIELDS = 6
         @Volatile
         private var sharedAssetManager: AssetManager? = null
 
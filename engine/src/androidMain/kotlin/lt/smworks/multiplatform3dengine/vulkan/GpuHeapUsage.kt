@@ -0,0 +1,13 @@
+package lt.smworks.multiplatform3dengine.vulkan
+
+// Renderer allocations in one Vulkan memory heap. Blocks are shared by many
+// buffers and images; large resources get a dedicated allocation instead.
+data class GpuHeapUsage(
+    val heapIndex: Int,
+    val heapSize: Long,
+    val reservedBytes: Long,
+    val usedBytes: Long,
+    val blockCount: Int,
+    val allocationCount: Int,
+    val dedicatedAllocationCount: Int,
+)
@@ -0,0 +1,9 @@
+package lt.smworks.multiplatform3dengine.vulkan
+
+// Order matches the native encoder settings; OFF keeps uncooked textures RGBA8.
+enum class TextureCompressionQuality {
+    OFF,
+    FAST,
+    NORMAL,
+    HIGH,
+}
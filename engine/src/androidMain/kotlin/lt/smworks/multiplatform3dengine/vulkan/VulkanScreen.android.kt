@@ -24,6 +24,7 @@ import kotlinx.coroutines.channels.BufferOverflow
 import kotlinx.coroutines.delay
 import kotlinx.coroutines.flow.MutableSharedFlow
 import kotlinx.coroutines.isActive
+import java.io.File
 
 private const val LOG_TAG = "VulkanScreen"
 private const val DEFAULT_REFRESH_RATE = 60f
@@ -85,6 +86,7 @@ actual fun VulkanScreen(
                             override fun surfaceCreated(holder: SurfaceHolder) {
                                 val surface = holder.surface
                                 if (surface != null && surface.isValid) {
+                                    engine.setModelCacheDirectory(File(viewContext.cacheDir, "models"))
                                     engine.init(surface, viewContext.assets)
                                     engine.start()
                                 }